@@ -1,4 +1,12 @@
 #include "myBuffer.h"
+#include "myGpuProfiler.h"
+#include "myTimeline.h"
+
+#include <algorithm>
+#include <mutex>
+
+myGpuProfiler* myBuffer::uploadProfiler = nullptr;
+myTimeline* myBuffer::uploadTimeline = nullptr;
 
 void myBuffer::createCommandPool(VkDevice logicalDevice, QueueFamilyIndices queueFamilyIndices) {
 
@@ -14,51 +22,103 @@ void myBuffer::createCommandPool(VkDevice logicalDevice, QueueFamilyIndices queu
 
 }
 
-void myBuffer::createVertexBuffer(VkPhysicalDevice physicalDevice, VkDevice logicalDevice, VkQueue queue, uint32_t verticeSize, std::vector<Vertex>* vertices){
-
-	//sizeofָָܲ͵ĴС
-	VkDeviceSize bufferSize = verticeSize;// vertices->size();
-
-	//GPUĻVK_MEMORY_PROPERTY_DEVICE_LOCAL_BITֻGPU޷
-	//ڶGPUУôҪȽݴݴ滺ݴ滺ƵGPUʵĻУΪɶҲǺڲͬ˵ĸʽأҲʹĴйأ
+//GPUĻVK_MEMORY_PROPERTY_DEVICE_LOCAL_BITCPUдȥдһݴ滺ٸƹȥ
+//λݴ滺ſֻ롢ӳһ
+void myBuffer::createMeshBuffers(VkPhysicalDevice physicalDevice, VkDevice logicalDevice, VkQueue queue, std::vector<Mesh>& meshs) {
+
+	uint32_t vertexNum = 0;
+	uint32_t index16Num = 0;
+	uint32_t index32Num = 0;
+	for (Mesh& mesh : meshs) {
+		mesh.firstVertex = vertexNum;
+		mesh.vertexCount = static_cast<uint32_t>(mesh.vertices.size());
+		mesh.indexCount = static_cast<uint32_t>(mesh.indices.size());
+		if (mesh.vertexCount <= 65536) {
+			mesh.indexType = VK_INDEX_TYPE_UINT16;
+			mesh.firstIndex = index16Num;
+			index16Num += mesh.indexCount;
+		}
+		else {
+			mesh.indexType = VK_INDEX_TYPE_UINT32;
+			mesh.firstIndex = index32Num;
+			index32Num += mesh.indexCount;
+		}
+		vertexNum += mesh.vertexCount;
+	}
+	if (vertexNum == 0 || index16Num + index32Num == 0) {
+		throw std::runtime_error("failed to create mesh buffers: model is empty!");
+	}
+	VkDeviceSize positionBufferSize = sizeof(glm::vec3) * vertexNum;
+	VkDeviceSize attributeBufferSize = sizeof(VertexAttribute) * vertexNum;
+	//ƫҪС
+	this->index32Offset = (sizeof(uint16_t) * index16Num + 3) / 4 * 4;
+	this->indexBufferSize = index32Offset + sizeof(uint32_t) * index32Num;
+	this->index32OnlySize = sizeof(uint32_t) * (index16Num + index32Num);
+
+	//ÿһζ4ֽڶ
+	VkDeviceSize attributeStagingOffset = positionBufferSize;
+	VkDeviceSize indexStagingOffset = attributeStagingOffset + attributeBufferSize;
+	VkDeviceSize stagingBufferSize = indexStagingOffset + indexBufferSize;
 	VkBuffer stagingBuffer;
 	VkDeviceMemory stagingBufferMemory;
-	createBuffer(physicalDevice, logicalDevice, bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingBufferMemory);
+	createBuffer(physicalDevice, logicalDevice, stagingBufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingBufferMemory);
 
 	void* data;
-	//Խһ豸GPUռ)һڴָӳ
-	vkMapMemory(logicalDevice, stagingBufferMemory, 0, bufferSize, 0, &data);
-	memcpy(data, vertices->data(), (size_t)bufferSize);	//úֻڶCPU˻ʱ
+	vkMapMemory(logicalDevice, stagingBufferMemory, 0, stagingBufferSize, 0, &data);
+	char* stagingData = static_cast<char*>(data);
+	glm::vec3* positionDst = reinterpret_cast<glm::vec3*>(stagingData);
+	VertexAttribute* attributeDst = reinterpret_cast<VertexAttribute*>(stagingData + attributeStagingOffset);
+	uint16_t* index16Dst = reinterpret_cast<uint16_t*>(stagingData + indexStagingOffset);
+	uint32_t* index32Dst = reinterpret_cast<uint32_t*>(stagingData + indexStagingOffset + index32Offset);
+	for (Mesh& mesh : meshs) {
+		//Vertex
+		for (uint32_t i = 0; i < mesh.vertexCount; i++) {
+			const Vertex& vertex = mesh.vertices[i];
+			positionDst[mesh.firstVertex + i] = vertex.pos;
+			attributeDst[mesh.firstVertex + i] = { vertex.texCoord, vertex.normal, vertex.tangent };
+		}
+		//ӶƫƣʱvertexOffsetСmeshŷŵý16λ
+		if (mesh.indexType == VK_INDEX_TYPE_UINT16) {
+			uint16_t* meshIndexDst = index16Dst + mesh.firstIndex;
+			for (uint32_t i = 0; i < mesh.indexCount; i++) {
+				meshIndexDst[i] = static_cast<uint16_t>(mesh.indices[i]);
+			}
+		}
+		else {
+			memcpy(index32Dst + mesh.firstIndex, mesh.indices.data(), sizeof(uint32_t) * mesh.indexCount);
+		}
+		//ݴ滺ѾˣCPUϵĲ
+		std::vector<Vertex>().swap(mesh.vertices);
+		std::vector<uint32_t>().swap(mesh.indices);
+	}
 	vkUnmapMemory(logicalDevice, stagingBufferMemory);
 
-	createBuffer(physicalDevice, logicalDevice, bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, this->vertexBuffer, this->vertexBufferMemory);
+	//mesh shader߶룬ֱӰ洢
+	createBuffer(physicalDevice, logicalDevice, positionBufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, this->positionBuffer, this->positionBufferMemory);
+	createBuffer(physicalDevice, logicalDevice, attributeBufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, this->attributeBuffer, this->attributeBufferMemory);
+	createBuffer(physicalDevice, logicalDevice, indexBufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, this->indexBuffer, this->indexBufferMemory);
+	copyBuffer(logicalDevice, queue, this->commandPool, stagingBuffer, this->positionBuffer, positionBufferSize);
+	copyBuffer(logicalDevice, queue, this->commandPool, stagingBuffer, this->attributeBuffer, attributeBufferSize, attributeStagingOffset);
+	copyBuffer(logicalDevice, queue, this->commandPool, stagingBuffer, this->indexBuffer, indexBufferSize, indexStagingOffset);
 
-	copyBuffer(logicalDevice, queue, this->commandPool, stagingBuffer, this->vertexBuffer, bufferSize);
 	vkDestroyBuffer(logicalDevice, stagingBuffer, nullptr);
 	vkFreeMemory(logicalDevice, stagingBufferMemory, nullptr);
 
 }
 
-void myBuffer::createIndexBuffer(VkPhysicalDevice physicalDevice, VkDevice logicalDevice, VkQueue queue, uint32_t indiceSize, std::vector<uint32_t>* indices) {
-
-	VkDeviceSize bufferSize = indiceSize * indices->size();
-
-	VkBuffer stagingBuffer;
-	VkDeviceMemory stagingBufferMemory;
-	createBuffer(physicalDevice, logicalDevice, bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingBufferMemory);
-
-	void* data;
-	vkMapMemory(logicalDevice, stagingBufferMemory, 0, bufferSize, 0, &data);
-	memcpy(data, indices->data(), (size_t)bufferSize);
-	vkUnmapMemory(logicalDevice, stagingBufferMemory);
-
-	createBuffer(physicalDevice, logicalDevice, bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, this->indexBuffer, this->indexBufferMemory);
-
-	copyBuffer(logicalDevice, queue, this->commandPool, stagingBuffer, indexBuffer, bufferSize);
-
-	vkDestroyBuffer(logicalDevice, stagingBuffer, nullptr);
-	vkFreeMemory(logicalDevice, stagingBufferMemory, nullptr);
+void myBuffer::bindVertexBuffers(VkCommandBuffer commandBuffer, uint32_t streams) {
+	//ÿbindingǹ̶ģûõ
+	VkDeviceSize offset = 0;
+	if (streams & VERTEX_STREAM_POSITION) {
+		vkCmdBindVertexBuffers(commandBuffer, Vertex::POSITION_BINDING, 1, &positionBuffer, &offset);
+	}
+	if (streams & VERTEX_STREAM_ATTRIBUTE) {
+		vkCmdBindVertexBuffers(commandBuffer, Vertex::ATTRIBUTE_BINDING, 1, &attributeBuffer, &offset);
+	}
+}
 
+void myBuffer::bindIndexBuffer(VkCommandBuffer commandBuffer, VkIndexType indexType) {
+	vkCmdBindIndexBuffer(commandBuffer, this->indexBuffer, indexType == VK_INDEX_TYPE_UINT16 ? 0 : index32Offset, indexType);
 }
 
 void myBuffer::createUniformBuffers(VkPhysicalDevice physicalDevice, VkDevice logicalDevice, uint32_t frameSize) {
@@ -127,6 +187,10 @@ void myBuffer::createFramebuffers(uint32_t swapChainImageViewsSize, std::vector<
 }
 
 //frameBufferreSwapChainأԷڱclean
+void myBuffer::printStats() {
+	std::cout << "index buffer: " << indexBufferSize / 1024 << " KB, " << index32OnlySize / 1024 << " KB with 32-bit indices only" << std::endl;
+}
+
 void myBuffer::clean(VkDevice logicalDevice, int frameSize) {
 
 	for (size_t i = 0; i < frameSize; i++) {
@@ -137,21 +201,53 @@ void myBuffer::clean(VkDevice logicalDevice, int frameSize) {
 	vkDestroyBuffer(logicalDevice, indexBuffer, nullptr);
 	vkFreeMemory(logicalDevice, indexBufferMemory, nullptr);
 
-	vkDestroyBuffer(logicalDevice, vertexBuffer, nullptr);
-	vkFreeMemory(logicalDevice, vertexBufferMemory, nullptr);
+	vkDestroyBuffer(logicalDevice, positionBuffer, nullptr);
+	vkFreeMemory(logicalDevice, positionBufferMemory, nullptr);
+	vkDestroyBuffer(logicalDevice, attributeBuffer, nullptr);
+	vkFreeMemory(logicalDevice, attributeBufferMemory, nullptr);
 
 	vkDestroyCommandPool(logicalDevice, commandPool, nullptr);
 
 }
 
 
-void myBuffer::createBuffer(VkPhysicalDevice physicalDevice, VkDevice logicalDevice, VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer& buffer, VkDeviceMemory& bufferMemory) {
+void myBuffer::retireFramebuffers(myDeletionQueue& deletionQueue, VkDevice logicalDevice) {
+	std::vector<VkFramebuffer> framebuffers;
+	framebuffers.swap(swapChainFramebuffers);
+	deletionQueue.push([logicalDevice, framebuffers]() {
+		for (VkFramebuffer framebuffer : framebuffers) {
+			vkDestroyFramebuffer(logicalDevice, framebuffer, nullptr);
+		}
+	});
+}
+
+void myBuffer::retireBuffer(myDeletionQueue& deletionQueue, VkDevice logicalDevice, VkBuffer& buffer, VkDeviceMemory& bufferMemory) {
+	VkBuffer oldBuffer = buffer;
+	VkDeviceMemory oldMemory = bufferMemory;
+	deletionQueue.push([logicalDevice, oldBuffer, oldMemory]() {
+		vkDestroyBuffer(logicalDevice, oldBuffer, nullptr);
+		vkFreeMemory(logicalDevice, oldMemory, nullptr);
+	});
+	buffer = VK_NULL_HANDLE;
+	bufferMemory = VK_NULL_HANDLE;
+}
+
+void myBuffer::createBuffer(VkPhysicalDevice physicalDevice, VkDevice logicalDevice, VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer& buffer, VkDeviceMemory& bufferMemory, std::vector<uint32_t> queueFamilies) {
 
 	VkBufferCreateInfo bufferInfo{};
 	bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
 	bufferInfo.size = size;
 	bufferInfo.usage = usage;
-	bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+	std::sort(queueFamilies.begin(), queueFamilies.end());
+	queueFamilies.erase(std::unique(queueFamilies.begin(), queueFamilies.end()), queueFamilies.end());
+	if (queueFamilies.size() > 1) {
+		bufferInfo.sharingMode = VK_SHARING_MODE_CONCURRENT;
+		bufferInfo.queueFamilyIndexCount = static_cast<uint32_t>(queueFamilies.size());
+		bufferInfo.pQueueFamilyIndices = queueFamilies.data();
+	}
+	else {
+		bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+	}
 
 	if (vkCreateBuffer(logicalDevice, &bufferInfo, nullptr, &buffer) != VK_SUCCESS) {
 		throw std::runtime_error("failed to create vertex buffer!");
@@ -181,12 +277,12 @@ void myBuffer::createBuffer(VkPhysicalDevice physicalDevice, VkDevice logicalDev
 
 }
 
-void myBuffer::copyBuffer(VkDevice logicalDevice, VkQueue queue, VkCommandPool commandPool, VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size) {
+void myBuffer::copyBuffer(VkDevice logicalDevice, VkQueue queue, VkCommandPool commandPool, VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size, VkDeviceSize srcOffset) {
 
 	VkCommandBuffer commandBuffer = beginSingleTimeCommands(logicalDevice, commandPool);
 
 	VkBufferCopy copyRegion{};
-	copyRegion.srcOffset = 0;
+	copyRegion.srcOffset = srcOffset;
 	copyRegion.dstOffset = 0;
 	copyRegion.size = size;
 	vkCmdCopyBuffer(commandBuffer, srcBuffer, dstBuffer, 1, &copyRegion);	//ú˵Ļmemcpy
@@ -212,12 +308,19 @@ VkCommandBuffer myBuffer::beginSingleTimeCommands(VkDevice logicalDevice, VkComm
 
 	vkBeginCommandBuffer(commandBuffer, &beginInfo);
 
+	if (uploadProfiler) {
+		uploadProfiler->beginImmediateScope(commandBuffer, "upload");
+	}
+
 	return commandBuffer;
 
 }
 
 void myBuffer::endSingleTimeCommands(VkDevice logicalDevice, VkQueue queue, VkCommandBuffer commandBuffer, VkCommandPool commandPool) {
 
+	if (uploadProfiler) {
+		uploadProfiler->endImmediateScope(commandBuffer);
+	}
 	vkEndCommandBuffer(commandBuffer);
 
 	VkSubmitInfo submitInfo{};
@@ -225,8 +328,28 @@ void myBuffer::endSingleTimeCommands(VkDevice logicalDevice, VkQueue queue, VkCo
 	submitInfo.commandBufferCount = 1;
 	submitInfo.pCommandBuffers = &commandBuffer;
 
-	vkQueueSubmit(queue, 1, &submitInfo, VK_NULL_HANDLE);
-	vkQueueWaitIdle(queue);
+	if (uploadTimeline) {
+		//̶߳ϴȡֵύ֮䲻ֵܱ̲߳ǵ
+		static std::mutex submitMutex;
+		uint64_t value;
+		{
+			std::lock_guard<std::mutex> lock(submitMutex);
+			value = uploadTimeline->submittedValue.load() + 1;
+			SubmitSemaphores semaphores;
+			semaphores.addSignal(uploadTimeline->semaphore, value);
+			semaphores.fill(submitInfo);
+			vkQueueSubmit(queue, 1, &submitInfo, VK_NULL_HANDLE);
+			uploadTimeline->markSubmitted(value);
+		}
+		uploadTimeline->wait(value);
+	}
+	else {
+		vkQueueSubmit(queue, 1, &submitInfo, VK_NULL_HANDLE);
+		vkQueueWaitIdle(queue);
+	}
+	if (uploadProfiler) {
+		uploadProfiler->resolveImmediateScope(commandBuffer);
+	}
 	vkFreeCommandBuffers(logicalDevice, commandPool, 1, &commandBuffer);
 
 }
@@ -2,7 +2,6 @@
 #define GLFW_INCLUDE_VULKAN
 #include <GLFW/glfw3.h>
 #define GLM_FORCE_RADIANS
-#define GLM_FORCE_DEFAULT_ALIGNED_GENTYPES
 #define GLM_FORCE_DEPTH_ZERO_TO_ONE
 #include<glm/glm.hpp>
 
@@ -11,10 +10,14 @@
 #include <vector>
 
 #include "structSet.h"
+#include "myDeletionQueue.h"
 
 #ifndef MY_BUFFER
 #define MY_BUFFER
 
+class myGpuProfiler;
+class myTimeline;
+
 class myBuffer {
 
 public:
@@ -23,11 +26,18 @@ public:
 	std::vector<VkCommandBuffer> commandBuffers;
 
 	//һȫȥȻoffset
-	VkBuffer vertexBuffer;
-	VkDeviceMemory vertexBufferMemory;
+	//λֻҪλõpassֻλ
+	VkBuffer positionBuffer;
+	VkDeviceMemory positionBufferMemory;
+	VkBuffer attributeBuffer;
+	VkDeviceMemory attributeBufferMemory;
 
+	//ǰһ16λindex32Offsetֽ֮32λʱmeshindexTypeѡһ
 	VkBuffer indexBuffer;
 	VkDeviceMemory indexBufferMemory;
+	VkDeviceSize index32Offset = 0;
+	VkDeviceSize indexBufferSize = 0;
+	VkDeviceSize index32OnlySize = 0;	//ȫ32λʱĴСindexBufferSizeȽ16λʡ˶
 
 	std::vector<VkBuffer> uniformBuffers;
 	std::vector<VkDeviceMemory> uniformBuffersMemory;
@@ -35,17 +45,32 @@ public:
 
 	std::vector<VkFramebuffer> swapChainFramebuffers;
 
+	//Ϊʱύϴݡת¼GPUʱ
+	static myGpuProfiler* uploadProfiler;
+	//ΪʱύtimelineһֵֵֻvkQueueWaitIdle
+	static myTimeline* uploadTimeline;
+
 	void createCommandPool(VkDevice logicalDevice, QueueFamilyIndices queueFamilyIndices);
-	void createVertexBuffer(VkPhysicalDevice physicalDevice, VkDevice logicalDevice, VkQueue queue, uint32_t verticeSize, std::vector<Vertex>* vertices);
-	void createIndexBuffer(VkPhysicalDevice physicalDevice, VkDevice logicalDevice, VkQueue queue, uint32_t indiceSize, std::vector<uint32_t>* indices);
+	//úϲĴСֱдӳݴ滺壬CPUƴһݣÿmeshfirstVertexȣϴͷmeshverticesindices
+	//㲻65536mesh16λ32λ
+	void createMeshBuffers(VkPhysicalDevice physicalDevice, VkDevice logicalDevice, VkQueue queue, std::vector<Mesh>& meshs);
+	void bindIndexBuffer(VkCommandBuffer commandBuffer, VkIndexType indexType);
+	//streamsΪVertexStreamϣ͹Vertex::getBindingDescriptionsɵİ󶨶Ӧ
+	void bindVertexBuffers(VkCommandBuffer commandBuffer, uint32_t streams);
 	void createUniformBuffers(VkPhysicalDevice physicalDevice, VkDevice logicalDevice, uint32_t frameSize);
 	void createCommandBuffers(VkDevice logicalDevice, uint32_t frameSize);
 	void createFramebuffers(uint32_t swapChainImageViewsSize, std::vector<VkImageView> swapChainImageViews, VkExtent2D swapChainExtent, std::vector<VkImageView> imageViews, VkImageView depthImageView, VkRenderPass renderPass, VkDevice logicalDevice);
 
+	void printStats();
+
 	void clean(VkDevice logicalDevice, int frameSize);
+	//deletionQueueӳ٣ԱÿպֱӴµ
+	void retireFramebuffers(myDeletionQueue& deletionQueue, VkDevice logicalDevice);
+	static void retireBuffer(myDeletionQueue& deletionQueue, VkDevice logicalDevice, VkBuffer& buffer, VkDeviceMemory& bufferMemory);
 
-	static void createBuffer(VkPhysicalDevice physicalDevice, VkDevice logicalDevice, VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer& buffer, VkDeviceMemory& bufferMemory);
-	static void copyBuffer(VkDevice logicalDevice, VkQueue queue, VkCommandPool commandPool, VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size);
+	//queueFamiliesжͬĶʱCONCURRENTͼκͼжֱӷʣҪתȨ
+	static void createBuffer(VkPhysicalDevice physicalDevice, VkDevice logicalDevice, VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer& buffer, VkDeviceMemory& bufferMemory, std::vector<uint32_t> queueFamilies = {});
+	static void copyBuffer(VkDevice logicalDevice, VkQueue queue, VkCommandPool commandPool, VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size, VkDeviceSize srcOffset = 0);
 	static VkCommandBuffer beginSingleTimeCommands(VkDevice logicalDevice, VkCommandPool commandPool);
 	static void endSingleTimeCommands(VkDevice logicalDevice, VkQueue queue, VkCommandBuffer commandBuffer, VkCommandPool commandPool);
 	static uint32_t findMemoryType(VkPhysicalDevice physicalDevice, uint32_t typeFilter, VkMemoryPropertyFlags properties);
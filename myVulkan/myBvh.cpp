@@ -0,0 +1,540 @@
+#include "myBvh.h"
+#include <glm/gtc/matrix_transform.hpp>
+#include "myGpuCulling.h"
+#include "myProfiler.h"
+
+#include <algorithm>
+#include <random>
+#include <chrono>
+#include <cmath>
+
+//MSVCx64ͿSSE2gcc/clangSSEƽ̨ñ汾
+#if defined(_M_X64) || defined(__SSE2__)
+#define MY_BVH_SSE 1
+#include <emmintrin.h>
+#else
+#define MY_BVH_SSE 0
+#endif
+
+float AABB::area() const {
+	glm::vec3 extent = max - min;
+	return 2.0f * (extent.x * extent.y + extent.y * extent.z + extent.z * extent.x);
+}
+
+AABB AABB::transformed(const glm::mat4& matrix) const {
+	AABB result;
+	result.min = glm::vec3(matrix[3]);
+	result.max = glm::vec3(matrix[3]);
+	for (int c = 0; c < 3; c++) {
+		for (int r = 0; r < 3; r++) {
+			float a = matrix[c][r] * min[c];
+			float b = matrix[c][r] * max[c];
+			result.min[r] += std::min(a, b);
+			result.max[r] += std::max(a, b);
+		}
+	}
+	return result;
+}
+
+void myBvh::setBounds(BvhNode& node, uint32_t begin, uint32_t end) {
+	AABB bounds;
+	for (uint32_t i = begin; i < end; i++) {
+		bounds.grow(primBounds[primIndices[i]]);
+	}
+	node.boundsMin = bounds.min;
+	node.boundsMax = bounds.max;
+}
+
+float myBvh::findSplit(uint32_t begin, uint32_t end, const AABB& centroidBounds, uint32_t& axis, uint32_t& splitBin) {
+
+	//ͬһ䣬ÿͼԪİΧֻһ
+	//²ĽڵͼԪ٣ӶɨĿȷ䱾ͼԪ
+	uint32_t binNum = binCount(end - begin);
+	AABB binBounds[3][BIN_NUM];
+	uint32_t binCounts[3][BIN_NUM] = {};
+	glm::vec3 extent = centroidBounds.max - centroidBounds.min;
+	glm::vec3 scale;
+	for (uint32_t a = 0; a < 3; a++) {
+		scale[a] = extent[a] > 0.0f ? binNum / extent[a] : 0.0f;
+	}
+	for (uint32_t i = begin; i < end; i++) {
+		uint32_t prim = primIndices[i];
+		const AABB& box = primBounds[prim];
+		glm::vec3 offset = (centroids[prim] - centroidBounds.min) * scale;
+		for (uint32_t a = 0; a < 3; a++) {
+			uint32_t bin = std::min(binNum - 1, static_cast<uint32_t>(offset[a]));
+			binCounts[a][bin]++;
+			binBounds[a][bin].grow(box);
+		}
+	}
+
+	float bestCost = FLT_MAX;
+	for (uint32_t a = 0; a < 3; a++) {
+
+		if (extent[a] <= 0.0f) {
+			continue;
+		}
+
+		//ɨһߵٴɨʱÿָĴ
+		float leftAreas[BIN_NUM - 1];
+		uint32_t leftCounts[BIN_NUM - 1];
+		AABB leftBox;
+		uint32_t leftSum = 0;
+		for (uint32_t b = 0; b < binNum - 1; b++) {
+			leftSum += binCounts[a][b];
+			leftBox.grow(binBounds[a][b]);
+			leftCounts[b] = leftSum;
+			leftAreas[b] = leftSum > 0 ? leftBox.area() : 0.0f;
+		}
+		AABB rightBox;
+		uint32_t rightSum = 0;
+		for (uint32_t b = binNum - 1; b > 0; b--) {
+			rightSum += binCounts[a][b];
+			rightBox.grow(binBounds[a][b]);
+			if (leftCounts[b - 1] == 0 || rightSum == 0) {
+				continue;
+			}
+			float cost = leftCounts[b - 1] * leftAreas[b - 1] + rightSum * rightBox.area();
+			if (cost < bestCost) {
+				bestCost = cost;
+				axis = a;
+				splitBin = b;
+			}
+		}
+
+	}
+	return bestCost;
+
+}
+
+void myBvh::subdivide(std::vector<BvhNode>& out, uint32_t nodeIndex, uint32_t begin, uint32_t end, std::vector<SubtreeJob>* jobs) {
+
+	AABB nodeBounds;
+	AABB centroidBounds;
+	for (uint32_t i = begin; i < end; i++) {
+		nodeBounds.grow(primBounds[primIndices[i]]);
+		centroidBounds.grow(centroids[primIndices[i]]);
+	}
+	out[nodeIndex].boundsMin = nodeBounds.min;
+	out[nodeIndex].boundsMax = nodeBounds.max;
+
+	uint32_t count = end - begin;
+	if (jobs && count <= PARALLEL_SUBTREE_SIZE) {
+		jobs->push_back({ nodeIndex, begin, end });
+		return;
+	}
+
+	//ͼԪĽڵֱҶӣҶͼԪҲܱˣʡµ漸ķ
+	if (count <= MAX_LEAF_SIZE) {
+		out[nodeIndex].leftFirst = begin;
+		out[nodeIndex].count = count;
+		return;
+	}
+
+	uint32_t axis = 0;
+	uint32_t splitBin = 0;
+	float splitCost = findSplit(begin, end, centroidBounds, axis, splitBin);
+
+	uint32_t mid;
+	if (splitCost == FLT_MAX) {
+		//ȫغϣSAHֲ԰
+		mid = begin + count / 2;
+	}
+	else {
+		//úͷʱһʽжң⸡ͼԪֵһߣֿյĺ
+		uint32_t binNum = binCount(count);
+		float scale = binNum / (centroidBounds.max[axis] - centroidBounds.min[axis]);
+		float minCentroid = centroidBounds.min[axis];
+		auto middle = std::partition(primIndices.begin() + begin, primIndices.begin() + end, [&](uint32_t prim) {
+			return std::min(binNum - 1, static_cast<uint32_t>((centroids[prim][axis] - minCentroid) * scale)) < splitBin;
+		});
+		mid = static_cast<uint32_t>(middle - primIndices.begin());
+	}
+
+	uint32_t left = static_cast<uint32_t>(out.size());
+	out.push_back({});
+	out.push_back({});
+	out[nodeIndex].leftFirst = left;
+	out[nodeIndex].count = 0;
+	subdivide(out, left, begin, mid, jobs);
+	subdivide(out, left + 1, mid, end, jobs);
+
+}
+
+void myBvh::build(const std::vector<AABB>& bounds) {
+
+	MY_PROFILE_FUNCTION();
+
+	primBounds = bounds;
+	uint32_t primNum = static_cast<uint32_t>(primBounds.size());
+	nodes.clear();
+	primIndices.resize(primNum);
+	centroids.resize(primNum);
+	for (uint32_t i = 0; i < primNum; i++) {
+		primIndices[i] = i;
+		centroids[i] = primBounds[i].center();
+	}
+	if (primNum == 0) {
+		return;
+	}
+
+	nodes.reserve(2 * primNum);
+	nodes.push_back({});
+	std::vector<SubtreeJob> jobs;
+	subdivide(nodes, 0, 0, primNum, &jobs);
+
+	//ÿֻԼһprimIndicesڵȽڸԵٽӵnodes
+	std::vector<std::vector<BvhNode>> subtrees(jobs.size());
+	auto buildSubtree = [this, &jobs, &subtrees](uint32_t j) {
+		subtrees[j].reserve(2 * (jobs[j].end - jobs[j].begin));
+		subtrees[j].push_back({});
+		subdivide(subtrees[j], 0, jobs[j].begin, jobs[j].end, nullptr);
+	};
+	if (jobs.size() > 1) {
+		if (!threadPool) {
+			threadPool = std::make_unique<myThreadPool>();
+		}
+		for (uint32_t j = 0; j + 1 < jobs.size(); j++) {
+			threadPool->submit([&buildSubtree, j]() { buildSubtree(j); });
+		}
+		buildSubtree(static_cast<uint32_t>(jobs.size() - 1));
+		threadPool->waitIdle();
+	}
+	else {
+		buildSubtree(0);
+	}
+
+	//kk >= 1Ľڵŵbase + k - 1ֱӸռλĽڵ
+	for (uint32_t j = 0; j < jobs.size(); j++) {
+		uint32_t offset = static_cast<uint32_t>(nodes.size()) - 1;
+		for (BvhNode& node : subtrees[j]) {
+			if (node.count == 0) {
+				node.leftFirst += offset;
+			}
+		}
+		nodes[jobs[j].nodeIndex] = subtrees[j][0];
+		nodes.insert(nodes.end(), subtrees[j].begin() + 1, subtrees[j].end());
+	}
+
+}
+
+void myBvh::refit(const std::vector<AABB>& bounds) {
+
+	MY_PROFILE_FUNCTION();
+
+	if (bounds.size() != primBounds.size()) {
+		throw std::runtime_error("failed to refit bvh: primitive count changed!");
+	}
+	primBounds = bounds;
+
+	//ӵǱȸڵ󣬵һԵ
+	for (size_t i = nodes.size(); i-- > 0;) {
+		BvhNode& node = nodes[i];
+		if (node.count > 0) {
+			setBounds(node, node.leftFirst, node.leftFirst + node.count);
+		}
+		else {
+			const BvhNode& left = nodes[node.leftFirst];
+			const BvhNode& right = nodes[node.leftFirst + 1];
+			node.boundsMin = glm::min(left.boundsMin, right.boundsMin);
+			node.boundsMax = glm::max(left.boundsMax, right.boundsMax);
+		}
+	}
+
+}
+
+namespace {
+
+	//6ƽ水ṹų飬ÿ4λһԶڲƽ
+	struct FrustumSoA {
+#if MY_BVH_SSE
+		__m128 nx[2], ny[2], nz[2], d[2];
+		__m128 ax[2], ay[2], az[2];	//ߵľֵΧڷϵͶӰ뾶
+#else
+		float nx[8], ny[8], nz[8], d[8];
+		float ax[8], ay[8], az[8];
+#endif
+
+		explicit FrustumSoA(const std::array<glm::vec4, 6>& planes) {
+			alignas(16) float px[8], py[8], pz[8], pd[8], qx[8], qy[8], qz[8];
+			for (int i = 0; i < 8; i++) {
+				glm::vec4 plane = i < 6 ? planes[i] : glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+				px[i] = plane.x; py[i] = plane.y; pz[i] = plane.z; pd[i] = plane.w;
+				qx[i] = std::fabs(plane.x); qy[i] = std::fabs(plane.y); qz[i] = std::fabs(plane.z);
+			}
+#if MY_BVH_SSE
+			for (int k = 0; k < 2; k++) {
+				nx[k] = _mm_load_ps(px + 4 * k); ny[k] = _mm_load_ps(py + 4 * k); nz[k] = _mm_load_ps(pz + 4 * k); d[k] = _mm_load_ps(pd + 4 * k);
+				ax[k] = _mm_load_ps(qx + 4 * k); ay[k] = _mm_load_ps(qy + 4 * k); az[k] = _mm_load_ps(qz + 4 * k);
+			}
+#else
+			std::copy(px, px + 8, nx); std::copy(py, py + 8, ny); std::copy(pz, pz + 8, nz); std::copy(pd, pd + 8, d);
+			std::copy(qx, qx + 8, ax); std::copy(qy, qy + 8, ay); std::copy(qz, qz + 8, az);
+#endif
+		}
+
+		//ĵƽľС-뾶࣬ڰ뾶ڲ
+		myBvh::CullResult classify(const glm::vec3& boundsMin, const glm::vec3& boundsMax) const {
+			glm::vec3 center = (boundsMin + boundsMax) * 0.5f;
+			glm::vec3 extent = (boundsMax - boundsMin) * 0.5f;
+			bool inside = true;
+#if MY_BVH_SSE
+			__m128 cx = _mm_set1_ps(center.x), cy = _mm_set1_ps(center.y), cz = _mm_set1_ps(center.z);
+			__m128 ex = _mm_set1_ps(extent.x), ey = _mm_set1_ps(extent.y), ez = _mm_set1_ps(extent.z);
+			for (int k = 0; k < 2; k++) {
+				__m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx[k], cx), _mm_mul_ps(ny[k], cy)), _mm_add_ps(_mm_mul_ps(nz[k], cz), d[k]));
+				__m128 radius = _mm_add_ps(_mm_add_ps(_mm_mul_ps(ax[k], ex), _mm_mul_ps(ay[k], ey)), _mm_mul_ps(az[k], ez));
+				if (_mm_movemask_ps(_mm_cmplt_ps(_mm_add_ps(distance, radius), _mm_setzero_ps())) != 0) {
+					return myBvh::OUTSIDE;
+				}
+				inside = inside && _mm_movemask_ps(_mm_cmplt_ps(_mm_sub_ps(distance, radius), _mm_setzero_ps())) == 0;
+			}
+#else
+			for (int i = 0; i < 6; i++) {
+				float distance = nx[i] * center.x + ny[i] * center.y + nz[i] * center.z + d[i];
+				float radius = ax[i] * extent.x + ay[i] * extent.y + az[i] * extent.z;
+				if (distance + radius < 0.0f) {
+					return myBvh::OUTSIDE;
+				}
+				inside = inside && distance - radius >= 0.0f;
+			}
+#endif
+			return inside ? myBvh::INSIDE : myBvh::INTERSECT;
+		}
+	};
+
+	struct RaySlab {
+		glm::vec3 origin;
+		glm::vec3 invDirection;
+#if MY_BVH_SSE
+		__m128 o, inv;
+#endif
+
+		RaySlab(glm::vec3 rayOrigin, glm::vec3 direction) : origin(rayOrigin) {
+			//Ϊ0ʱȡһСֵ0 * infõNaN
+			for (int i = 0; i < 3; i++) {
+				float component = std::fabs(direction[i]) < 1e-20f ? std::copysign(1e-20f, direction[i]) : direction[i];
+				invDirection[i] = 1.0f / component;
+			}
+#if MY_BVH_SSE
+			o = _mm_setr_ps(origin.x, origin.y, origin.z, 0.0f);
+			inv = _mm_setr_ps(invDirection.x, invDirection.y, invDirection.z, 0.0f);
+#endif
+		}
+
+		//ؽΧеtཻ߱maxTԶʱFLT_MAX
+		float intersect(const glm::vec3& boundsMin, const glm::vec3& boundsMax, float maxT) const {
+#if MY_BVH_SSE
+			__m128 t1 = _mm_mul_ps(_mm_sub_ps(_mm_setr_ps(boundsMin.x, boundsMin.y, boundsMin.z, 0.0f), o), inv);
+			__m128 t2 = _mm_mul_ps(_mm_sub_ps(_mm_setr_ps(boundsMax.x, boundsMax.y, boundsMax.z, 0.0f), o), inv);
+			//4[0, maxT]˳֮ǰmaxT֮Ĳֲõ
+			const __m128 lane3 = _mm_castsi128_ps(_mm_setr_epi32(0, 0, 0, -1));
+			__m128 tNear = _mm_or_ps(_mm_andnot_ps(lane3, _mm_min_ps(t1, t2)), _mm_and_ps(lane3, _mm_setzero_ps()));
+			__m128 tFar = _mm_or_ps(_mm_andnot_ps(lane3, _mm_max_ps(t1, t2)), _mm_and_ps(lane3, _mm_set1_ps(maxT)));
+			tNear = _mm_max_ps(tNear, _mm_shuffle_ps(tNear, tNear, _MM_SHUFFLE(2, 3, 0, 1)));
+			tNear = _mm_max_ps(tNear, _mm_shuffle_ps(tNear, tNear, _MM_SHUFFLE(1, 0, 3, 2)));
+			tFar = _mm_min_ps(tFar, _mm_shuffle_ps(tFar, tFar, _MM_SHUFFLE(2, 3, 0, 1)));
+			tFar = _mm_min_ps(tFar, _mm_shuffle_ps(tFar, tFar, _MM_SHUFFLE(1, 0, 3, 2)));
+			float nearT = _mm_cvtss_f32(tNear);
+			float farT = _mm_cvtss_f32(tFar);
+#else
+			float nearT = 0.0f;
+			float farT = maxT;
+			for (int i = 0; i < 3; i++) {
+				float t1 = (boundsMin[i] - origin[i]) * invDirection[i];
+				float t2 = (boundsMax[i] - origin[i]) * invDirection[i];
+				nearT = std::max(nearT, std::min(t1, t2));
+				farT = std::min(farT, std::max(t1, t2));
+			}
+#endif
+			return nearT <= farT ? nearT : FLT_MAX;
+		}
+	};
+
+}
+
+void myBvh::cullFrustum(const std::array<glm::vec4, 6>& planes, std::vector<uint32_t>& visible) const {
+
+	if (nodes.empty()) {
+		return;
+	}
+
+	FrustumSoA frustum(planes);
+	//λ¼ڵǷѾ׶ڣǵĻٲ
+	const uint32_t INSIDE_BIT = 1u << 31;
+	std::vector<uint32_t> stack;
+	stack.reserve(64);
+	stack.push_back(0);
+	while (!stack.empty()) {
+
+		uint32_t entry = stack.back();
+		stack.pop_back();
+		const BvhNode& node = nodes[entry & ~INSIDE_BIT];
+		CullResult result = (entry & INSIDE_BIT) ? INSIDE : frustum.classify(node.boundsMin, node.boundsMax);
+		if (result == OUTSIDE) {
+			continue;
+		}
+
+		if (node.count == 0) {
+			uint32_t flag = result == INSIDE ? INSIDE_BIT : 0;
+			stack.push_back((node.leftFirst + 1) | flag);
+			stack.push_back(node.leftFirst | flag);
+			continue;
+		}
+
+		for (uint32_t i = node.leftFirst; i < node.leftFirst + node.count; i++) {
+			uint32_t prim = primIndices[i];
+			//ҶֻһͼԪʱڵİΧоͼԪİΧ
+			if (result == INSIDE || node.count == 1 || frustum.classify(primBounds[prim].min, primBounds[prim].max) != OUTSIDE) {
+				visible.push_back(prim);
+			}
+		}
+
+	}
+
+}
+
+bool myBvh::raycast(glm::vec3 origin, glm::vec3 direction, uint32_t& hitPrim, float& hitT, float maxT) const {
+
+	if (nodes.empty()) {
+		return false;
+	}
+
+	RaySlab ray(origin, direction);
+	float bestT = maxT;
+	bool hit = false;
+	if (ray.intersect(nodes[0].boundsMin, nodes[0].boundsMax, bestT) == FLT_MAX) {
+		return false;
+	}
+
+	std::vector<uint32_t> stack;
+	stack.reserve(64);
+	stack.push_back(0);
+	while (!stack.empty()) {
+
+		const BvhNode& node = nodes[stack.back()];
+		stack.pop_back();
+
+		if (node.count > 0) {
+			for (uint32_t i = node.leftFirst; i < node.leftFirst + node.count; i++) {
+				uint32_t prim = primIndices[i];
+				float t = ray.intersect(primBounds[prim].min, primBounds[prim].max, bestT);
+				if (t < bestT) {
+					bestT = t;
+					hitPrim = prim;
+					hit = true;
+				}
+			}
+			continue;
+		}
+
+		//ĺӺջȴҵԶĺӶᱻbestTõ
+		uint32_t left = node.leftFirst;
+		uint32_t right = node.leftFirst + 1;
+		float leftT = ray.intersect(nodes[left].boundsMin, nodes[left].boundsMax, bestT);
+		float rightT = ray.intersect(nodes[right].boundsMin, nodes[right].boundsMax, bestT);
+		if (leftT > rightT) {
+			std::swap(left, right);
+			std::swap(leftT, rightT);
+		}
+		if (rightT != FLT_MAX) {
+			stack.push_back(right);
+		}
+		if (leftT != FLT_MAX) {
+			stack.push_back(left);
+		}
+
+	}
+
+	if (hit) {
+		hitT = bestT;
+	}
+	return hit;
+
+}
+
+void myBvh::benchmark(uint32_t primitiveNum) {
+
+	const uint32_t FRUSTUM_QUERY_NUM = 256;
+	const uint32_t RAY_NUM = 100000;
+
+	std::mt19937 random(1234);
+	std::uniform_real_distribution<float> position(-500.0f, 500.0f);
+	std::uniform_real_distribution<float> size(0.5f, 5.0f);
+	std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+	auto randomDirection = [&]() {
+		glm::vec3 direction(unit(random), unit(random), unit(random));
+		return glm::length(direction) > 1e-3f ? glm::normalize(direction) : glm::vec3(0.0f, 0.0f, 1.0f);
+	};
+	auto elapsedMs = [](std::chrono::steady_clock::time_point start) {
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	};
+
+	std::vector<AABB> bounds(primitiveNum);
+	for (AABB& box : bounds) {
+		glm::vec3 center(position(random), position(random), position(random));
+		glm::vec3 extent(size(random), size(random), size(random));
+		box.min = center - extent;
+		box.max = center + extent;
+	}
+
+	myBvh bvh;
+	auto start = std::chrono::steady_clock::now();
+	bvh.build(bounds);
+	double buildTime = elapsedMs(start);
+	std::cout << "bvh build: " << primitiveNum << " primitives, " << bvh.nodes.size() << " nodes, " << buildTime << " ms ("
+		<< primitiveNum / buildTime / 1000.0 << " M primitives/s)" << std::endl;
+
+	//ÿͼԪŲһ㣬ģ⶯̬
+	for (AABB& box : bounds) {
+		glm::vec3 offset = randomDirection() * size(random);
+		box.min += offset;
+		box.max += offset;
+	}
+	start = std::chrono::steady_clock::now();
+	bvh.refit(bounds);
+	double refitTime = elapsedMs(start);
+	std::cout << "bvh refit: " << refitTime << " ms (" << primitiveNum / refitTime / 1000.0 << " M primitives/s)" << std::endl;
+
+	std::vector<std::array<glm::vec4, 6>> frustums(FRUSTUM_QUERY_NUM);
+	glm::mat4 proj = glm::perspective(glm::radians(45.0f), 16.0f / 9.0f, 0.1f, 300.0f);
+	for (auto& planes : frustums) {
+		glm::vec3 eye(position(random), position(random), position(random));
+		glm::mat4 view = glm::lookAt(eye, eye + randomDirection(), glm::vec3(0.0f, 1.0f, 0.0f));
+		planes = myGpuCulling::extractFrustumPlanes(proj * view);
+	}
+
+	std::vector<uint32_t> visible;
+	visible.reserve(primitiveNum);
+	size_t visibleSum = 0;
+	start = std::chrono::steady_clock::now();
+	for (const auto& planes : frustums) {
+		visible.clear();
+		bvh.cullFrustum(planes, visible);
+		visibleSum += visible.size();
+	}
+	double cullTime = elapsedMs(start);
+
+	//ͼԪΪ
+	FrustumSoA firstFrustum(frustums[0]);
+	size_t bruteVisible = 0;
+	start = std::chrono::steady_clock::now();
+	for (const AABB& box : bounds) {
+		bruteVisible += firstFrustum.classify(box.min, box.max) != OUTSIDE;
+	}
+	double bruteTime = elapsedMs(start);
+	std::cout << "bvh frustum cull: " << FRUSTUM_QUERY_NUM / cullTime * 1000.0 << " queries/s, " << cullTime / FRUSTUM_QUERY_NUM << " ms/query, "
+		<< visibleSum / FRUSTUM_QUERY_NUM << " visible on average; brute force " << bruteTime << " ms/query (" << bruteVisible << " visible)" << std::endl;
+
+	uint32_t hitNum = 0;
+	start = std::chrono::steady_clock::now();
+	for (uint32_t i = 0; i < RAY_NUM; i++) {
+		glm::vec3 origin(position(random), position(random), position(random));
+		uint32_t prim;
+		float t;
+		hitNum += bvh.raycast(origin, randomDirection(), prim, t) ? 1 : 0;
+	}
+	double rayTime = elapsedMs(start);
+	std::cout << "bvh raycast: " << RAY_NUM / rayTime / 1000.0 << " M rays/s, " << hitNum << " / " << RAY_NUM << " hit" << std::endl;
+
+}
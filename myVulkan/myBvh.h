@@ -0,0 +1,94 @@
+#pragma once
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#define GLM_ENABLE_EXPERIMENTAL
+#include <glm/glm.hpp>
+
+#include <iostream>
+#include <vector>
+#include <array>
+#include <memory>
+#include <cfloat>
+
+#include "myThreadPool.h"
+
+#ifndef MY_BVH
+#define MY_BVH
+
+struct AABB {
+
+	glm::vec3 min = glm::vec3(FLT_MAX);
+	glm::vec3 max = glm::vec3(-FLT_MAX);
+
+	void grow(const glm::vec3& point) { min = glm::min(min, point); max = glm::max(max, point); }
+	void grow(const AABB& box) { min = glm::min(min, box.min); max = glm::max(max, box.max); }
+	bool valid() const { return min.x <= max.x && min.y <= max.y && min.z <= max.z; }
+	glm::vec3 center() const { return (min + max) * 0.5f; }
+	float area() const;
+	//任ΧУǰ8Ƕ任һ飬ǰÿһȡmin/max
+	AABB transformed(const glm::mat4& matrix) const;
+
+};
+
+//leftFirstڲڵΪӵҺӽں棻ҶΪprimIndicesеʼλ
+//countΪ0ʾڲڵ㣻32ֽڣڵһ
+struct BvhNode {
+	glm::vec3 boundsMin;
+	uint32_t leftFirst;
+	glm::vec3 boundsMax;
+	uint32_t count;
+};
+
+//ͼԪAABBĲΰΧУͼԪmeshmeshʵ
+//÷SAHϲ㴮лֳ֣㹻̳߳ﲢй
+//ƶʱrefitֻ°ΧУˣƶöʱbuild
+class myBvh {
+
+public:
+
+	static const uint32_t BIN_NUM = 16;
+	static const uint32_t MAX_LEAF_SIZE = 4;	//ĽڵֱҶ
+	//ͼԪСķΧٲɲ
+	static const uint32_t PARALLEL_SUBTREE_SIZE = 8192;
+
+	enum CullResult { OUTSIDE, INTERSECT, INSIDE };
+
+	std::vector<BvhNode> nodes;	//nodes[0]ΪӵǴڸڵ
+	std::vector<uint32_t> primIndices;
+	std::vector<AABB> primBounds;
+
+	void build(const std::vector<AABB>& bounds);
+	//ͼԪ䣬ֻаΧб
+	void refit(const std::vector<AABB>& bounds);
+
+	//planesΪһռƽ棬߳ڣvisible׷ӿɼͼԪ
+	void cullFrustum(const std::array<glm::vec4, 6>& planes, std::vector<uint32_t>& visible) const;
+	//ذΧཻͼԪûʱfalseڰΧʱtΪ0
+	bool raycast(glm::vec3 origin, glm::vec3 direction, uint32_t& hitPrim, float& hitT, float maxT = FLT_MAX) const;
+
+	//primitiveNumΧУrefit׶޳߲ѯ
+	static void benchmark(uint32_t primitiveNum);
+
+private:
+
+	struct SubtreeJob {
+		uint32_t nodeIndex;
+		uint32_t begin;
+		uint32_t end;
+	};
+
+	std::vector<glm::vec3> centroids;
+	std::unique_ptr<myThreadPool> threadPool;
+
+	void subdivide(std::vector<BvhNode>& out, uint32_t nodeIndex, uint32_t begin, uint32_t end, std::vector<SubtreeJob>* jobs);
+	//СSAHۣû˱ۣĶغʱFLT_MAX
+	float findSplit(uint32_t begin, uint32_t end, const AABB& centroidBounds, uint32_t& axis, uint32_t& splitBin);
+	void setBounds(BvhNode& node, uint32_t begin, uint32_t end);
+	static uint32_t binCount(uint32_t primNum) { return primNum < BIN_NUM ? primNum : BIN_NUM; }
+
+};
+
+#endif
@@ -113,6 +113,14 @@ public:
             Zoom = 45.0f;
     }
 
+    // returns a world space ray through a point given in NDC ([-1, 1], y up) for a perspective projection with the given vertical fov (radians)
+    void GetRay(float ndcX, float ndcY, float fovY, float aspect, glm::vec3& origin, glm::vec3& direction)
+    {
+        float tanHalfFov = tan(fovY * 0.5f);
+        origin = Position;
+        direction = glm::normalize(Front + Right * (ndcX * tanHalfFov * aspect) + Up * (ndcY * tanHalfFov));
+    }
+
 private:
     // calculates the front vector from the Camera's (updated) Euler Angles
     void updateCameraVectors()
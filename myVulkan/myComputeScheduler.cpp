@@ -0,0 +1,140 @@
+#include "myComputeScheduler.h"
+#include "myProfiler.h"
+
+myComputeScheduler::myComputeScheduler(myDevice* device, uint32_t frameSize, bool asyncCompute, myGpuProfiler* graphicsProfiler) {
+
+	this->logicalDevice = device->logicalDevice;
+	this->computeQueue = device->computeQueue;
+	this->computeFamily = device->queueFamilyIndices.computeFamily.value();
+	this->asyncEnabled = asyncCompute && device->asyncComputeSupported();
+	recordedPasses.resize(frameSize);
+
+	if (!asyncEnabled) {
+		std::cout << "async compute " << (asyncCompute ? "is not supported" : "is disabled") << ", compute passes run on the graphics queue" << std::endl;
+		return;
+	}
+	std::cout << "async compute on queue family " << computeFamily << std::endl;
+
+	VkCommandPoolCreateInfo poolInfo{};
+	poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+	poolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+	poolInfo.queueFamilyIndex = computeFamily;
+	if (vkCreateCommandPool(logicalDevice, &poolInfo, nullptr, &commandPool) != VK_SUCCESS) {
+		throw std::runtime_error("failed to create compute command pool!");
+	}
+
+	commandBuffers.resize(frameSize);
+	VkCommandBufferAllocateInfo allocInfo{};
+	allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+	allocInfo.commandPool = commandPool;
+	allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+	allocInfo.commandBufferCount = frameSize;
+	if (vkAllocateCommandBuffers(logicalDevice, &allocInfo, commandBuffers.data()) != VK_SUCCESS) {
+		throw std::runtime_error("failed to allocate compute command buffers!");
+	}
+
+	timeline = std::make_unique<myTimeline>(logicalDevice);
+
+	gpuProfiler = std::make_unique<myGpuProfiler>(device->physicalDevice, logicalDevice, computeFamily, frameSize);
+	gpuProfiler->threadID = myGpuProfiler::GPU_THREAD_ID + 1;
+	gpuProfiler->trackName = "GPU compute";
+	gpuProfiler->calibrationSource = graphicsProfiler;
+
+}
+
+uint32_t myComputeScheduler::addPass(std::string name, std::function<bool(VkCommandBuffer, uint32_t)> record) {
+	passes.push_back({ name, std::move(record) });
+	for (std::vector<bool>& recorded : recordedPasses) {
+		recorded.push_back(false);
+	}
+	return static_cast<uint32_t>(passes.size() - 1);
+}
+
+void myComputeScheduler::recordPasses(VkCommandBuffer commandBuffer, uint32_t frameIndex, myGpuProfiler* profiler) {
+	for (uint32_t i = 0; i < passes.size(); i++) {
+		uint32_t scope = profiler->beginScope(commandBuffer, passes[i].name);
+		recordedPasses[frameIndex][i] = passes[i].record(commandBuffer, frameIndex);
+		profiler->endScope(commandBuffer, scope);
+	}
+}
+
+uint64_t myComputeScheduler::submit(uint32_t frameIndex, uint64_t frameNumber) {
+
+	if (!asyncEnabled) {
+		return 0;
+	}
+
+	MY_PROFILE_FUNCTION();
+
+	//λϴεļͼζе֮ǰˣͼζеһ֡Ѿ֡timelineϵȹֱ¼
+	VkCommandBuffer commandBuffer = commandBuffers[frameIndex];
+	vkResetCommandBuffer(commandBuffer, 0);
+
+	VkCommandBufferBeginInfo beginInfo{};
+	beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+	beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+	if (vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS) {
+		throw std::runtime_error("failed to begin recording compute command buffer!");
+	}
+	gpuProfiler->beginFrame(commandBuffer, frameIndex);
+	recordPasses(commandBuffer, frameIndex, gpuProfiler.get());
+	if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS) {
+		throw std::runtime_error("failed to record compute command buffer!");
+	}
+
+	uint64_t signalValue = frameNumber + 1;
+	SubmitSemaphores semaphores;
+	semaphores.addSignal(timeline->semaphore, signalValue);
+
+	VkSubmitInfo submitInfo{};
+	submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+	submitInfo.commandBufferCount = 1;
+	submitInfo.pCommandBuffers = &commandBuffer;
+	semaphores.fill(submitInfo);
+	if (vkQueueSubmit(computeQueue, 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS) {
+		throw std::runtime_error("failed to submit compute command buffer!");
+	}
+	timeline->markSubmitted(signalValue);
+
+	return signalValue;
+
+}
+
+void myComputeScheduler::recordInline(VkCommandBuffer commandBuffer, uint32_t frameIndex, myGpuProfiler* profiler) {
+
+	if (asyncEnabled || passes.empty()) {
+		return;
+	}
+
+	recordPasses(commandBuffer, frameIndex, profiler);
+
+	//ɫдĽڼӻơƬԪɫжȡ
+	VkMemoryBarrier barrier{};
+	barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+	barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+	barrier.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_SHADER_READ_BIT;
+	vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, graphicsWaitStage, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+}
+
+bool myComputeScheduler::passRecorded(uint32_t passIndex, uint32_t frameIndex) {
+	return recordedPasses[frameIndex][passIndex];
+}
+
+void myComputeScheduler::printStats() {
+	if (gpuProfiler) {
+		gpuProfiler->printStats();
+	}
+}
+
+void myComputeScheduler::clean() {
+	if (gpuProfiler) {
+		gpuProfiler->clean();
+	}
+	if (timeline) {
+		timeline->clean();
+	}
+	if (commandPool != VK_NULL_HANDLE) {
+		vkDestroyCommandPool(logicalDevice, commandPool, nullptr);
+	}
+}
@@ -0,0 +1,72 @@
+#pragma once
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <memory>
+#include <functional>
+
+#include "structSet.h"
+#include "myDevice.h"
+#include "myGpuProfiler.h"
+#include "myTimeline.h"
+
+#ifndef MY_COMPUTE_SCHEDULER
+#define MY_COMPUTE_SCHEDULER
+
+//ÿִ֡һεļrecordfalseʾһ֡û¼߻ûã
+struct ComputePass {
+	std::string name;
+	std::function<bool(VkCommandBuffer commandBuffer, uint32_t frameIndex)> record;
+};
+
+//ÿ֡ļ޳շֿ顢SSAOŵļϣͼζصִ
+//frameNumber֡timeline semaphoreƵframeNumber + 1ͼζύʱֵ
+//豸֧첽ʱֱ¼ƵͼĿͷͬ
+class myComputeScheduler {
+
+public:
+
+	VkDevice logicalDevice;
+	VkQueue computeQueue;
+	uint32_t computeFamily;
+	bool asyncEnabled;
+
+	VkCommandPool commandPool = VK_NULL_HANDLE;
+	std::vector<VkCommandBuffer> commandBuffers;	//ÿе֡һ
+	std::unique_ptr<myTimeline> timeline;	//frameNumber֡ΪframeNumber + 1
+	std::unique_ptr<myGpuProfiler> gpuProfiler;	//ϵʱ첽ʱ
+
+	std::vector<ComputePass> passes;
+
+	//ͼζдЩ׶οʼҪĽ
+	VkPipelineStageFlags graphicsWaitStage = VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+
+	//graphicsProfilerеʱ
+	myComputeScheduler(myDevice* device, uint32_t frameSize, bool asyncCompute, myGpuProfiler* graphicsProfiler);
+
+	//ӵ˳ִ
+	uint32_t addPass(std::string name, std::function<bool(VkCommandBuffer, uint32_t)> record);
+
+	//ͼȡɹ֡timelineҲȹ֮ã첽ʱ¼ƲύУͼζҪȴtimelineֵ򷵻0
+	//ͬһframeNumberֻύһΣtimelineֵ
+	uint64_t submit(uint32_t frameIndex, uint64_t frameNumber);
+	//첽ʱͼrender pass֮ǰã첽ʱʲô
+	void recordInline(VkCommandBuffer commandBuffer, uint32_t frameIndex, myGpuProfiler* profiler);
+	//һ֡ǷִˣûִʱǾ
+	bool passRecorded(uint32_t passIndex, uint32_t frameIndex);
+
+	void printStats();
+	void clean();
+
+private:
+
+	std::vector<std::vector<bool>> recordedPasses;	//[frameIndex][passIndex]
+
+	void recordPasses(VkCommandBuffer commandBuffer, uint32_t frameIndex, myGpuProfiler* profiler);
+
+};
+
+#endif
@@ -0,0 +1,59 @@
+#include "myDeletionQueue.h"
+
+void myDeletionQueue::beginFrame(uint64_t frameNumber, uint64_t completedFrames) {
+
+	std::vector<RetiredResource> readyResources;
+	{
+		std::lock_guard<std::mutex> lock(queueMutex);
+		this->frameNumber.store(frameNumber, std::memory_order_release);
+		//̷ͬ߳Ž˳һretireFrameȫһ
+		for (size_t i = 0; i < retiredResources.size();) {
+			if (retiredResources[i].retireFrame < completedFrames) {
+				readyResources.push_back(std::move(retiredResources[i]));
+				retiredResources[i] = std::move(retiredResources.back());
+				retiredResources.pop_back();
+			}
+			else {
+				i++;
+			}
+		}
+	}
+	//٣ٺŶҲ
+	runDeleters(readyResources);
+
+}
+
+void myDeletionQueue::push(std::function<void()> deleter) {
+	std::lock_guard<std::mutex> lock(queueMutex);
+	retiredResources.push_back({ frameNumber.load(std::memory_order_acquire), std::move(deleter) });
+}
+
+void myDeletionQueue::push(uint64_t retireFrame, std::function<void()> deleter) {
+	std::lock_guard<std::mutex> lock(queueMutex);
+	retiredResources.push_back({ retireFrame, std::move(deleter) });
+}
+
+void myDeletionQueue::flushAll() {
+	while (true) {
+		std::vector<RetiredResource> resources;
+		{
+			std::lock_guard<std::mutex> lock(queueMutex);
+			resources.swap(retiredResources);
+		}
+		if (resources.empty()) {
+			return;
+		}
+		runDeleters(resources);
+	}
+}
+
+size_t myDeletionQueue::size() {
+	std::lock_guard<std::mutex> lock(queueMutex);
+	return retiredResources.size();
+}
+
+void myDeletionQueue::runDeleters(std::vector<RetiredResource>& resources) {
+	for (RetiredResource& resource : resources) {
+		resource.deleter();
+	}
+}
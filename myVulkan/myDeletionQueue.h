@@ -0,0 +1,47 @@
+#pragma once
+
+#include <vector>
+#include <functional>
+#include <mutex>
+#include <atomic>
+#include <cstdint>
+
+#ifndef MY_DELETION_QUEUE
+#define MY_DELETION_QUEUE
+
+struct RetiredResource {
+	uint64_t retireFrame;	//һõԴ֡
+	std::function<void()> deleter;
+};
+
+//Դ滻ʱڷе֡ţȷŽ֡timelineʱ֡ź٣ҪvkDeviceWaitIdle
+//̨̣߳ءԴʽأҲţԼ
+class myDeletionQueue {
+
+public:
+
+	//ÿ֡ʼʱã¼Ƶ֡ţcompletedFramesΪ֡timelineĵǰֵGPUѾ֡
+	//֡СcompletedFramesԴٱõֱ٣GPUܵÿʱõframesInFlight֡
+	void beginFrame(uint64_t frameNumber, uint64_t completedFrames);
+
+	//¼Ƶۣ֡һ֡Լ֮ǰܻ֡
+	void push(std::function<void()> deleter);
+	void push(uint64_t retireFrame, std::function<void()> deleter);
+
+	//豸к󣨳˳ʱʣµԴ
+	void flushAll();
+
+	uint64_t currentFrame() { return frameNumber.load(std::memory_order_acquire); }
+	size_t size();
+
+private:
+
+	std::mutex queueMutex;
+	std::vector<RetiredResource> retiredResources;
+	std::atomic<uint64_t> frameNumber{ 0 };
+
+	static void runDeleters(std::vector<RetiredResource>& resources);
+
+};
+
+#endif
@@ -3,63 +3,84 @@
 myDescriptor::myDescriptor(VkDevice logicalDevice, uint32_t frameSize) {
 	this->logicalDevice = logicalDevice;
 	this->frameSize = frameSize;
+	layoutCache.init(logicalDevice);
 	//createDescriptorPool();
 }
 
+void myDescriptor::addPoolSizes(std::vector<VkDescriptorPoolSize>& poolSizes, const std::vector<VkDescriptorSetLayoutBinding>& bindings, uint32_t setNum) {
+	for (const VkDescriptorSetLayoutBinding& binding : bindings) {
+		auto it = std::find_if(poolSizes.begin(), poolSizes.end(), [&binding](const VkDescriptorPoolSize& poolSize) {
+			return poolSize.type == binding.descriptorType;
+		});
+		if (it == poolSizes.end()) {
+			poolSizes.push_back({ binding.descriptorType, 0 });
+			it = poolSizes.end() - 1;
+		}
+		it->descriptorCount += binding.descriptorCount * setNum;
+	}
+}
+
 //ʵֵͦģΪǽֿͬ¼ģǽͬԼ¼
 //ؼ¼мÿмϼ¼ÿЩɣһм
 //൱شԼĸֳóһ
-void myDescriptor::createDescriptorPool(uint32_t uniformBufferNumAllLayout, std::vector<VkDescriptorType> types, std::vector<uint32_t> textureNumAllLayout) {
-
-	std::vector<VkDescriptorPoolSize> poolSizes{};
-	VkDescriptorPoolSize poolSize;
-	if (uniformBufferNumAllLayout > 0) {
-		poolSize.type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-		poolSize.descriptorCount = static_cast<uint32_t>(this->frameSize * uniformBufferNumAllLayout);
-		poolSizes.push_back(poolSize);
-	}
-	for (int i = 0; i < textureNumAllLayout.size(); i++) {
-
-		poolSize.type = types[i];
-		poolSize.descriptorCount = static_cast<uint32_t>(this->frameSize * textureNumAllLayout[i]);
-		poolSizes.push_back(poolSize);
+void myDescriptor::createDescriptorPool(const std::vector<VkDescriptorPoolSize>& poolSizes, uint32_t setNum, const std::vector<VkDescriptorPoolSize>& framePoolSizes, uint32_t frameSetNum) {
 
+	allocator.init(logicalDevice, setNum, poolSizeRatios(poolSizes, setNum));
+	frameAllocators.resize(this->frameSize);
+	for (myDescriptorAllocator& frameAllocator : frameAllocators) {
+		frameAllocator.init(logicalDevice, frameSetNum, poolSizeRatios(framePoolSizes, frameSetNum));
 	}
 
-	VkDescriptorPoolCreateInfo poolInfo{};
-	poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-	poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
-	poolInfo.pPoolSizes = poolSizes.data();
-	poolInfo.maxSets = static_cast<uint32_t>(this->frameSize * 16);
+}
 
-	if (vkCreateDescriptorPool(logicalDevice, &poolInfo, nullptr, &this->discriptorPool) != VK_SUCCESS) {
-		throw std::runtime_error("failed to create descriptor pool!");
+std::vector<PoolSizeRatio> myDescriptor::poolSizeRatios(const std::vector<VkDescriptorPoolSize>& poolSizes, uint32_t setNum) {
+	std::vector<PoolSizeRatio> ratios;
+	for (const VkDescriptorPoolSize& poolSize : poolSizes) {
+		ratios.push_back({ poolSize.type, static_cast<float>(poolSize.descriptorCount) / std::max(setNum, 1u) });
 	}
-
+	return ratios;
 }
 
-//ͨûͨûɫ׶Ρͨ͡ûͼ
+//ְ󶨡ͨûͼ
 //ΪɶҪvectorvectorԭvectorǶӦsetvectorʾһsetм
-DescriptorObject myDescriptor::createDescriptorObject(uint32_t uniformBufferNum, uint32_t textureNum, std::vector<VkShaderStageFlagBits>* uniformBufferUsages, std::vector<VkDescriptorType>* textureDescriptorType,
+DescriptorObject myDescriptor::createDescriptorObject(const std::vector<VkDescriptorSetLayoutBinding>& bindings,
 	uint32_t descriptorSetSize, std::vector<std::vector<VkBuffer>>* uniformBuffers, std::vector<std::vector<VkImageView>>* textureViews, std::vector<std::vector<VkSampler>>* textureSamplers) {
 
 	DescriptorObject descriptorObject;
+	descriptorObject.discriptorLayout = layoutCache.getLayout(bindings);
+	descriptorObject.uniformBufferNum = 0;
+	descriptorObject.textureNum = 0;
+
+	//writeDescriptorSetλдjuniformдjjͼдuniformBufferNum + j
+	std::vector<VkDescriptorSetLayoutBinding> sortedBindings = bindings;
+	std::sort(sortedBindings.begin(), sortedBindings.end(), [](const VkDescriptorSetLayoutBinding& a, const VkDescriptorSetLayoutBinding& b) {
+		return a.binding < b.binding;
+	});
+	for (uint32_t i = 0; i < sortedBindings.size(); i++) {
+		const VkDescriptorSetLayoutBinding& binding = sortedBindings[i];
+		bool uniformBuffer = binding.descriptorType == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+		if (binding.binding != i || binding.descriptorCount == 0 || (uniformBuffer && (binding.descriptorCount != 1 || descriptorObject.textureNum > 0))) {
+			throw std::runtime_error("failed to create descriptor object: bindings must be single uniform buffers first, then images!");
+		}
+		if (uniformBuffer) {
+			descriptorObject.uniformBufferNum++;
+		}
+		else {
+			descriptorObject.textureNum++;
+			descriptorObject.textureDescriptorTypes.push_back(binding.descriptorType);
+			descriptorObject.textureDescriptorCounts.push_back(binding.descriptorCount);
+		}
+	}
 
-	VkDescriptorSetLayout discriptorLayout = createDescriptorSetLayout(uniformBufferNum, textureNum, uniformBufferUsages, textureDescriptorType);
-
-	descriptorObject.discriptorLayout = discriptorLayout;
-	descriptorObject.uniformBufferNum = uniformBufferNum;
-	descriptorObject.textureNum = textureNum;
-
-	for (int u = 0; u < descriptorSetSize; u++) {
-		descriptorObject.descriptorSets.push_back(createDescriptorSet(descriptorObject, uniformBuffers == nullptr ? nullptr : &(uniformBuffers->at(u)), textureDescriptorType,
+	for (uint32_t u = 0; u < descriptorSetSize; u++) {
+		descriptorObject.descriptorSets.push_back(createDescriptorSet(descriptorObject, uniformBuffers == nullptr ? nullptr : &(uniformBuffers->at(u)), &descriptorObject.textureDescriptorTypes,
 																						textureViews == nullptr ? nullptr : &(textureViews->at(u)),
 																						textureSamplers == nullptr ? nullptr : &(textureSamplers->at(u))));
 	}
 
-	for (int i = 1; i < this->frameSize; i++) {
-		int k = descriptorObject.descriptorSets.size();
-		for (int j = 0; j < k; j++) {
+	for (uint32_t i = 1; i < this->frameSize; i++) {
+		size_t k = descriptorObject.descriptorSets.size();
+		for (size_t j = 0; j < k; j++) {
 			descriptorObject.descriptorSets.push_back(descriptorObject.descriptorSets[j]);
 		}
 	}
@@ -68,76 +89,28 @@ DescriptorObject myDescriptor::createDescriptorObject(uint32_t uniformBufferNum,
 	return descriptorObject;
 }
 
-VkDescriptorSetLayout myDescriptor::createDescriptorSetLayout(uint32_t uniformBufferNum, uint32_t textureNum, std::vector<VkShaderStageFlagBits>* uniformBufferUsages, std::vector<VkDescriptorType>* textureDescriptorType) {
-
-	std::vector<VkDescriptorSetLayoutBinding> bindings;
-
-	for (int i = 0; i < uniformBufferNum; i++) {
-
-		VkDescriptorSetLayoutBinding uboLayoutBinding{};
-		uboLayoutBinding.binding = i;
-		uboLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-		//countʾð󶨵мҪһshaderô٣һһ
-		//Ϊǵmvpͨһṹһ𴫵ģΪ1
-		uboLayoutBinding.descriptorCount = 1;
-		//VK_SHADER_STAGE_ALL_GRAPHICSԷɫʹ
-		uboLayoutBinding.stageFlags = uniformBufferUsages->at(i);
-
-		bindings.push_back(uboLayoutBinding);
-
-	}
-
-	for (int i = 0; i < textureNum; i++) {
-
-		VkDescriptorSetLayoutBinding samplerLayoutBinding{};
-		samplerLayoutBinding.binding = uniformBufferNum + i;
-		samplerLayoutBinding.descriptorCount = 1;
-		samplerLayoutBinding.descriptorType = textureDescriptorType->at(i);
-		samplerLayoutBinding.pImmutableSamplers = nullptr;
-		samplerLayoutBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
-
-		bindings.push_back(samplerLayoutBinding);
-
-	}
+VkDescriptorSet myDescriptor::createDescriptorSet(DescriptorObject descriptorObject, std::vector<VkBuffer>* uniformBuffers, std::vector<VkDescriptorType>* textureDescriptorType, std::vector<VkImageView>* textureViews, std::vector<VkSampler>* textureSamplers) {
 
-	VkDescriptorSetLayoutCreateInfo layoutInfo{};
-	layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
-	layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
-	layoutInfo.pBindings = bindings.data();
+	//ؿյ
+	VkDescriptorSet descriptorSet = allocator.allocate(descriptorObject.discriptorLayout);
 
-	VkDescriptorSetLayout layout;
-	if (vkCreateDescriptorSetLayout(logicalDevice, &layoutInfo, nullptr, &layout) != VK_SUCCESS) {
-		throw std::runtime_error("failed to create descriptor set layout!");
-	}
+	writeDescriptorSet(descriptorObject, descriptorSet, uniformBuffers, textureDescriptorType, textureViews, textureSamplers);
 
-	return layout;
+	return descriptorSet;
 
 }
 
-VkDescriptorSet myDescriptor::createDescriptorSet(DescriptorObject descriptorObject, std::vector<VkBuffer>* uniformBuffers, std::vector<VkDescriptorType>* textureDescriptorType, std::vector<VkImageView>* textureViews, std::vector<VkSampler>* textureSamplers) {
+void myDescriptor::writeDescriptorSet(DescriptorObject descriptorObject, VkDescriptorSet descriptorSet, std::vector<VkBuffer>* uniformBuffers, std::vector<VkDescriptorType>* textureDescriptorType, std::vector<VkImageView>* textureViews, std::vector<VkSampler>* textureSamplers) {
 
-	VkDescriptorSetLayout layout = descriptorObject.discriptorLayout;
 	uint32_t uniformBufferNum = descriptorObject.uniformBufferNum;
 	uint32_t textureNum = descriptorObject.textureNum;
 
-	VkDescriptorSetAllocateInfo allocInfo{};
-	allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
-	allocInfo.descriptorPool = this->discriptorPool;
-	allocInfo.descriptorSetCount = 1;
-	allocInfo.pSetLayouts = &layout;
-
-	VkDescriptorSet descriptorSet;
-	//ؿյ
-	if (vkAllocateDescriptorSets(logicalDevice, &allocInfo, &descriptorSet) != VK_SUCCESS) {
-		throw std::runtime_error("failed to allocate descriptor sets!");
-	}
-
 	std::vector<VkWriteDescriptorSet> descriptorWrites;
 	descriptorWrites.resize(uniformBufferNum + textureNum);
 
 	std::vector<VkDescriptorBufferInfo> bufferInfos;
 	bufferInfos.resize(uniformBufferNum);
-	for (int j = 0; j < uniformBufferNum; j++) {
+	for (uint32_t j = 0; j < uniformBufferNum; j++) {
 
 		bufferInfos[j].buffer = uniformBuffers->at(j);
 		bufferInfos[j].offset = 0;
@@ -153,14 +126,23 @@ VkDescriptorSet myDescriptor::createDescriptorSet(DescriptorObject descriptorObj
 
 	}
 
+	//󶨵ԪtextureViewsſimageInfosҪȷãдʱȡַ
+	uint32_t imageNum = 0;
+	for (uint32_t j = 0; j < textureNum; j++) {
+		imageNum += descriptorObject.textureDescriptorCounts[j];
+	}
 	std::vector<VkDescriptorImageInfo> imageInfos;
-	imageInfos.resize(textureNum);
-	for (int j = 0; j < textureNum; j++) {
-
-		imageInfos[j].imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-		imageInfos[j].imageView = textureViews->at(j);
-		if (textureDescriptorType->at(j) != VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT) {
-			imageInfos[j].sampler = textureSamplers->at(j);
+	imageInfos.resize(imageNum);
+	uint32_t imageOffset = 0;
+	for (uint32_t j = 0; j < textureNum; j++) {
+
+		uint32_t descriptorCount = descriptorObject.textureDescriptorCounts[j];
+		for (uint32_t k = imageOffset; k < imageOffset + descriptorCount; k++) {
+			imageInfos[k].imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+			imageInfos[k].imageView = textureViews->at(k);
+			if (textureDescriptorType->at(j) != VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT) {
+				imageInfos[k].sampler = textureSamplers->at(k);
+			}
 		}
 
 		descriptorWrites[j + uniformBufferNum].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
@@ -168,22 +150,49 @@ VkDescriptorSet myDescriptor::createDescriptorSet(DescriptorObject descriptorObj
 		descriptorWrites[j + uniformBufferNum].dstBinding = uniformBufferNum + j;
 		descriptorWrites[j + uniformBufferNum].dstArrayElement = 0;
 		descriptorWrites[j + uniformBufferNum].descriptorType = textureDescriptorType->at(j);
-		descriptorWrites[j + uniformBufferNum].descriptorCount = 1;
-		descriptorWrites[j + uniformBufferNum].pImageInfo = &imageInfos[j];	//imageInfo.data();
+		descriptorWrites[j + uniformBufferNum].descriptorCount = descriptorCount;
+		descriptorWrites[j + uniformBufferNum].pImageInfo = &imageInfos[imageOffset];	//imageInfo.data();
+		imageOffset += descriptorCount;
 
 	}
 
 	vkUpdateDescriptorSets(logicalDevice, static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0, nullptr);
 
-	return descriptorSet;
+}
+
+
+
 
+void myDescriptor::beginFrame(uint32_t frameIndex) {
+	frameAllocators[frameIndex].resetPools();
 }
 
+VkDescriptorSet myDescriptor::allocateTransient(uint32_t frameIndex, VkDescriptorSetLayout layout) {
+	return frameAllocators[frameIndex].allocate(layout);
+}
 
+void myDescriptor::printStats() {
+	uint32_t framePoolNum = 0;
+	for (myDescriptorAllocator& frameAllocator : frameAllocators) {
+		framePoolNum += frameAllocator.poolCount();
+	}
+	std::cout << "descriptors: " << allocator.poolCount() << " pools, " << framePoolNum << " per-frame pools, "
+		<< layoutCache.layoutCount() << " set layouts, " << layoutCache.hitCount() << " layout cache hits" << std::endl;
+}
 
+void myDescriptor::retire(myDeletionQueue& deletionQueue) {
+	allocator.retire(deletionQueue);
+	for (myDescriptorAllocator& frameAllocator : frameAllocators) {
+		frameAllocator.retire(deletionQueue);
+	}
+	layoutCache.retire(deletionQueue);
+	descriptorObjects.clear();
+}
 
 void myDescriptor::clean() {
-	for (int i = 0; i < this->descriptorObjects.size(); i++) {
-		vkDestroyDescriptorSetLayout(logicalDevice, this->descriptorObjects[i].discriptorLayout, nullptr);
+	allocator.clean();
+	for (myDescriptorAllocator& frameAllocator : frameAllocators) {
+		frameAllocator.clean();
 	}
+	layoutCache.clean();
 }
\ No newline at end of file
@@ -5,8 +5,12 @@
 #include <vector>
 #include <array>
 #include <iostream>
+#include <algorithm>
 
 #include "structSet.h"
+#include "myDeletionQueue.h"
+#include "myDescriptorAllocator.h"
+#include "myDescriptorLayoutCache.h"
 
 #ifndef MY_DISCRIPTOR
 #define MY_DISCRIPTOR
@@ -21,19 +25,42 @@ public:
 	//uint32_t uniformBufferNum;
 	//uint32_t textureNum;
 
-	VkDescriptorPool discriptorPool;
+	//ڴڵļϴallocator䣬زʱԶ³أÿ֡·ʱϴӶӦ֡frameAllocators
+	myDescriptorAllocator allocator;
+	std::vector<myDescriptorAllocator> frameAllocators;
+	//ĲֶӻȡͬĶһ
+	myDescriptorLayoutCache layoutCache;
 	std::vector<DescriptorObject> descriptorObjects;
 
 	myDescriptor(VkDevice logicalDevice, uint32_t frameSize);
 
-	void createDescriptorPool(uint32_t uniformBufferNumAllLayout, std::vector<VkDescriptorType> types, std::vector<uint32_t> textureNumAllLayout);
+	//setNumbindingsֵļҪӽpoolSizes
+	static void addPoolSizes(std::vector<VkDescriptorPoolSize>& poolSizes, const std::vector<VkDescriptorSetLayoutBinding>& bindings, uint32_t setNum);
+	//ÿƽĳذ
+	static std::vector<PoolSizeRatio> poolSizeRatios(const std::vector<VkDescriptorPoolSize>& poolSizes, uint32_t setNum);
+	//һװsetNumϺpoolSizes֮󲻹ʱػᰴͬıԼ
+	//framePoolSizesframeSetNumÿ֡ʱϵÿ֡λһĳ
+	void createDescriptorPool(const std::vector<VkDescriptorPoolSize>& poolSizes, uint32_t setNum, const std::vector<VkDescriptorPoolSize>& framePoolSizes, uint32_t frameSetNum);
 
-	DescriptorObject createDescriptorObject(uint32_t uniformBufferNum, uint32_t textureNum, std::vector<VkShaderStageFlagBits>* uniformBufferUsages, std::vector<VkDescriptorType>* textureDescriptorType,
+	//bindingsһɫõִlayoutCacheȡ
+	//Ҫuniformǰͼں˳0ţuniformÿһʱ׳쳣
+	//ͼ󶨿飬textureViewstextureSamplersÿϰ˳Ԫſ
+	DescriptorObject createDescriptorObject(const std::vector<VkDescriptorSetLayoutBinding>& bindings,
 		uint32_t descriptorSetSize, std::vector<std::vector<VkBuffer>>* uniformBuffers, std::vector < std::vector<VkImageView>>* textureViews, std::vector<std::vector<VkSampler>>* textureSamplers);
-	VkDescriptorSetLayout createDescriptorSetLayout(uint32_t uniformBufferNum, uint32_t textureNum, std::vector<VkShaderStageFlagBits>* uniformBufferUsages, std::vector<VkDescriptorType>* textureDescriptorType);
 	VkDescriptorSet createDescriptorSet(DescriptorObject descriptorObject, std::vector<VkBuffer>* uniformBuffers, std::vector<VkDescriptorType>* textureDescriptorType, std::vector<VkImageView>* textureViews, std::vector<VkSampler>* textureSamplers);
+	//деϣʱϲܻڷе֡
+	void writeDescriptorSet(DescriptorObject descriptorObject, VkDescriptorSet descriptorSet, std::vector<VkBuffer>* uniformBuffers, std::vector<VkDescriptorType>* textureDescriptorType, std::vector<VkImageView>* textureViews, std::vector<VkSampler>* textureSamplers);
+
+	//֡λһε֡ãһ֮֡ǰʱ
+	void beginFrame(uint32_t frameIndex);
+	//ֻһ֡Чļϣһõ֡λʱ
+	VkDescriptorSet allocateTransient(uint32_t frameIndex, VkDescriptorSetLayout layout);
+
+	void printStats();
 
 	void clean();
+	//غͲֽdeletionQueueӳ٣ļһͷ
+	void retire(myDeletionQueue& deletionQueue);
 
 };
 
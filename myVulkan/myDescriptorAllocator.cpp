@@ -0,0 +1,109 @@
+#include "myDescriptorAllocator.h"
+
+void myDescriptorAllocator::init(VkDevice logicalDevice, uint32_t initialSets, std::vector<PoolSizeRatio> poolRatios) {
+	this->logicalDevice = logicalDevice;
+	this->ratios = std::move(poolRatios);
+	this->setsPerPool = std::max(initialSets, 1u);
+	readyPools.push_back(createPool());
+}
+
+VkDescriptorPool myDescriptorAllocator::createPool() {
+
+	std::vector<VkDescriptorPoolSize> poolSizes;
+	for (const PoolSizeRatio& ratio : ratios) {
+		VkDescriptorPoolSize poolSize;
+		poolSize.type = ratio.type;
+		//ÿһСҲΪȡ0
+		poolSize.descriptorCount = std::max(static_cast<uint32_t>(ratio.ratio * setsPerPool + 0.5f), 1u);
+		poolSizes.push_back(poolSize);
+	}
+
+	VkDescriptorPoolCreateInfo poolInfo{};
+	poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+	poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+	poolInfo.pPoolSizes = poolSizes.data();
+	poolInfo.maxSets = setsPerPool;
+
+	VkDescriptorPool pool;
+	if (vkCreateDescriptorPool(logicalDevice, &poolInfo, nullptr, &pool) != VK_SUCCESS) {
+		throw std::runtime_error("failed to create descriptor pool!");
+	}
+
+	//һطصĸܼinitʱͳ޵ĲٱС
+	setsPerPool = std::max(setsPerPool, std::min(setsPerPool * 2, MAX_SETS_PER_POOL));
+	return pool;
+
+}
+
+VkDescriptorSet myDescriptorAllocator::allocate(VkDescriptorSetLayout layout) {
+
+	VkDescriptorSetAllocateInfo allocInfo{};
+	allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+	allocInfo.descriptorSetCount = 1;
+	allocInfo.pSetLayouts = &layout;
+
+	bool freshPool = false;
+	while (true) {
+
+		if (readyPools.empty()) {
+			readyPools.push_back(createPool());
+			freshPool = true;
+		}
+		allocInfo.descriptorPool = readyPools.back();
+
+		VkDescriptorSet descriptorSet;
+		VkResult result = vkAllocateDescriptorSets(logicalDevice, &allocInfo, &descriptorSet);
+		if (result == VK_SUCCESS) {
+			return descriptorSet;
+		}
+		if (result != VK_ERROR_OUT_OF_POOL_MEMORY && result != VK_ERROR_FRAGMENTED_POOL) {
+			throw std::runtime_error("failed to allocate descriptor sets!");
+		}
+
+		//³زinitʱĳСƻκһ϶ŵ£յ³ض䲻˵õͲڱ
+		//ٽĳҲûãֱ׳Ȼһ·MAX_SETS_PER_POOLÿװfullPools
+		//ճreadyPoolsĲֻ
+		if (freshPool) {
+			throw std::runtime_error("failed to allocate descriptor sets: layout does not fit in a fresh descriptor pool, check the pool size ratios!");
+		}
+		fullPools.push_back(readyPools.back());
+		readyPools.pop_back();
+
+	}
+
+}
+
+void myDescriptorAllocator::resetPools() {
+	for (VkDescriptorPool pool : readyPools) {
+		vkResetDescriptorPool(logicalDevice, pool, 0);
+	}
+	for (VkDescriptorPool pool : fullPools) {
+		vkResetDescriptorPool(logicalDevice, pool, 0);
+		readyPools.push_back(pool);
+	}
+	fullPools.clear();
+}
+
+void myDescriptorAllocator::clean() {
+	for (VkDescriptorPool pool : readyPools) {
+		vkDestroyDescriptorPool(logicalDevice, pool, nullptr);
+	}
+	for (VkDescriptorPool pool : fullPools) {
+		vkDestroyDescriptorPool(logicalDevice, pool, nullptr);
+	}
+	readyPools.clear();
+	fullPools.clear();
+}
+
+void myDescriptorAllocator::retire(myDeletionQueue& deletionQueue) {
+	VkDevice logicalDevice = this->logicalDevice;
+	std::vector<VkDescriptorPool> pools = readyPools;
+	pools.insert(pools.end(), fullPools.begin(), fullPools.end());
+	deletionQueue.push([logicalDevice, pools]() {
+		for (VkDescriptorPool pool : pools) {
+			vkDestroyDescriptorPool(logicalDevice, pool, nullptr);
+		}
+	});
+	readyPools.clear();
+	fullPools.clear();
+}
@@ -0,0 +1,55 @@
+#pragma once
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+
+#include "myDeletionQueue.h"
+
+#ifndef MY_DESCRIPTOR_ALLOCATOR
+#define MY_DESCRIPTOR_ALLOCATOR
+
+//ÿƽҪĳ³ذͼ
+struct PoolSizeRatio {
+	VkDescriptorType type;
+	float ratio;
+};
+
+//ǰĳˣVK_ERROR_OUT_OF_POOL_MEMORYٽһĳؽں棬Ҫ֪һҪټ
+//resetPoolsгһãÿ֡·ʱϣȥļϲͷţһ
+class myDescriptorAllocator {
+
+public:
+
+	//һô༯ϣ³زٷ
+	static const uint32_t MAX_SETS_PER_POOL = 4096;
+
+	VkDevice logicalDevice = VK_NULL_HANDLE;
+
+	void init(VkDevice logicalDevice, uint32_t initialSets, std::vector<PoolSizeRatio> poolRatios);
+
+	//ض䲻ʱٽ³أսĿճҲװʱ׳쳣
+	VkDescriptorSet allocate(VkDescriptorSetLayout layout);
+	//ʱļ϶ܻڷе֡
+	void resetPools();
+
+	uint32_t poolCount() { return static_cast<uint32_t>(readyPools.size() + fullPools.size()); }
+
+	void clean();
+	void retire(myDeletionQueue& deletionQueue);
+
+private:
+
+	std::vector<PoolSizeRatio> ratios;
+	std::vector<VkDescriptorPool> readyPools;	//ܷóһǵǰõ
+	std::vector<VkDescriptorPool> fullPools;
+	uint32_t setsPerPool = 0;	//һ³صļ
+
+	VkDescriptorPool createPool();
+
+};
+
+#endif
@@ -0,0 +1,85 @@
+#include "myDescriptorLayoutCache.h"
+
+bool DescriptorLayoutKey::operator==(const DescriptorLayoutKey& other) const {
+	if (bindings.size() != other.bindings.size()) {
+		return false;
+	}
+	for (size_t i = 0; i < bindings.size(); i++) {
+		const VkDescriptorSetLayoutBinding& a = bindings[i];
+		const VkDescriptorSetLayoutBinding& b = other.bindings[i];
+		if (a.binding != b.binding || a.descriptorType != b.descriptorType || a.descriptorCount != b.descriptorCount
+			|| a.stageFlags != b.stageFlags || a.pImmutableSamplers != b.pImmutableSamplers) {
+			return false;
+		}
+	}
+	return true;
+}
+
+//FNV-1amyPipelineCacheһֶιȥϣṹֽ
+uint64_t DescriptorLayoutKey::hash() const {
+	uint64_t hash = 14695981039346656037ull;
+	auto mix = [&hash](uint64_t value) {
+		for (int i = 0; i < 8; i++) {
+			hash ^= (value >> (i * 8)) & 0xFF;
+			hash *= 1099511628211ull;
+		}
+	};
+	for (const VkDescriptorSetLayoutBinding& binding : bindings) {
+		mix(binding.binding);
+		mix(static_cast<uint64_t>(binding.descriptorType));
+		mix(binding.descriptorCount);
+		mix(binding.stageFlags);
+		mix(reinterpret_cast<uint64_t>(binding.pImmutableSamplers));
+	}
+	return hash;
+}
+
+VkDescriptorSetLayout myDescriptorLayoutCache::getLayout(std::vector<VkDescriptorSetLayoutBinding> bindings) {
+
+	//󶨵Ⱥ˳Ӱ첼֣˳ͬͬһҲ
+	std::sort(bindings.begin(), bindings.end(), [](const VkDescriptorSetLayoutBinding& a, const VkDescriptorSetLayoutBinding& b) {
+		return a.binding < b.binding;
+	});
+	DescriptorLayoutKey key;
+	key.bindings = std::move(bindings);
+
+	auto it = layouts.find(key);
+	if (it != layouts.end()) {
+		cacheHitCount++;
+		return it->second;
+	}
+
+	VkDescriptorSetLayoutCreateInfo layoutInfo{};
+	layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+	layoutInfo.bindingCount = static_cast<uint32_t>(key.bindings.size());
+	layoutInfo.pBindings = key.bindings.data();
+
+	VkDescriptorSetLayout layout;
+	if (vkCreateDescriptorSetLayout(logicalDevice, &layoutInfo, nullptr, &layout) != VK_SUCCESS) {
+		throw std::runtime_error("failed to create descriptor set layout!");
+	}
+	layouts.emplace(std::move(key), layout);
+	return layout;
+
+}
+
+void myDescriptorLayoutCache::clean() {
+	for (auto& entry : layouts) {
+		vkDestroyDescriptorSetLayout(logicalDevice, entry.second, nullptr);
+	}
+	layouts.clear();
+}
+
+void myDescriptorLayoutCache::retire(myDeletionQueue& deletionQueue) {
+	VkDevice logicalDevice = this->logicalDevice;
+	std::vector<VkDescriptorSetLayout> retiredLayouts;
+	for (auto& entry : layouts) {
+		retiredLayouts.push_back(entry.second);
+	}
+	deletionQueue.push([logicalDevice, retiredLayouts]() {
+		for (VkDescriptorSetLayout layout : retiredLayouts) {
+			vkDestroyDescriptorSetLayout(logicalDevice, layout, nullptr);
+		}
+	});
+	layouts.clear();
+}
@@ -0,0 +1,54 @@
+#pragma once
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <unordered_map>
+#include <stdexcept>
+
+#include "myDeletionQueue.h"
+
+#ifndef MY_DESCRIPTOR_LAYOUT_CACHE
+#define MY_DESCRIPTOR_LAYOUT_CACHE
+
+//bindingźİΪֻļ
+struct DescriptorLayoutKey {
+
+	std::vector<VkDescriptorSetLayoutBinding> bindings;
+
+	bool operator==(const DescriptorLayoutKey& other) const;
+	uint64_t hash() const;
+
+};
+
+struct DescriptorLayoutKeyHash {
+	size_t operator()(const DescriptorLayoutKey& key) const { return static_cast<size_t>(key.hash()); }
+};
+
+//ȫֻͬһΣʹ߹ãֹ黺Уʹ߲ҪԼ
+class myDescriptorLayoutCache {
+
+public:
+
+	VkDevice logicalDevice = VK_NULL_HANDLE;
+
+	void init(VkDevice logicalDevice) { this->logicalDevice = logicalDevice; }
+
+	VkDescriptorSetLayout getLayout(std::vector<VkDescriptorSetLayoutBinding> bindings);
+
+	uint32_t layoutCount() { return static_cast<uint32_t>(layouts.size()); }
+	uint32_t hitCount() { return cacheHitCount; }
+
+	void clean();
+	void retire(myDeletionQueue& deletionQueue);
+
+private:
+
+	std::unordered_map<DescriptorLayoutKey, VkDescriptorSetLayout, DescriptorLayoutKeyHash> layouts;
+	uint32_t cacheHitCount = 0;
+
+};
+
+#endif
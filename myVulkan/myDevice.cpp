@@ -49,10 +49,10 @@ void myDevice::pickPhysicalDevice() {
 void myDevice::createLogicalDevice(bool enableValidationLayers, std::vector<const char*> validationLayers) {
 
 	std::vector<VkDeviceQueueCreateInfo> queueCreateInfos;
-	std::set<uint32_t> uniqueQueueFamilies = { queueFamilyIndices.graphicsFamily.value(), queueFamilyIndices.presentFamily.value() };
+	std::set<uint32_t> uniqueQueueFamilies = { queueFamilyIndices.graphicsFamily.value(), queueFamilyIndices.presentFamily.value(), queueFamilyIndices.computeFamily.value() };
 
 	//ѡȡ豸ӵһĶ壨ܣûдҪ֮
-	//豸Ӧһ߼豸һ߼豸Ӧ
+	//豸Ӧһ߼豸һ߼豸ӦУжʱ
 	float queuePriority = 1.0f;
 	for (uint32_t queueFamily : uniqueQueueFamilies) {
 		VkDeviceQueueCreateInfo queueCreateInfo{};
@@ -63,17 +63,77 @@ void myDevice::createLogicalDevice(bool enableValidationLayers, std::vector<cons
 		queueCreateInfos.push_back(queueCreateInfo);
 	}
 
+	VkPhysicalDeviceFeatures supportedFeatures;
+	vkGetPhysicalDeviceFeatures(physicalDevice, &supportedFeatures);
+	multiDrawIndirectSupported = supportedFeatures.multiDrawIndirect == VK_TRUE;
+
 	VkPhysicalDeviceFeatures deviceFeatures{};
 	deviceFeatures.samplerAnisotropy = VK_TRUE;
+	deviceFeatures.multiDrawIndirect = supportedFeatures.multiDrawIndirect;
+	//һpush constantĲȡ
+	deviceFeatures.shaderSampledImageArrayDynamicIndexing = VK_TRUE;
 	//deviceFeatures.sampleRateShading = VK_TRUE;
 
+	std::vector<const char*> enabledExtensions = deviceExtensions;
+
+	//present waitҪչfeature֧
+	VkPhysicalDevicePresentIdFeaturesKHR presentIdFeatures{};
+	presentIdFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_ID_FEATURES_KHR;
+	VkPhysicalDevicePresentWaitFeaturesKHR presentWaitFeatures{};
+	presentWaitFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_WAIT_FEATURES_KHR;
+	presentWaitFeatures.pNext = &presentIdFeatures;
+	presentWaitSupported = false;
+	if (isDeviceExtensionAvailable(physicalDevice, VK_KHR_PRESENT_ID_EXTENSION_NAME) && isDeviceExtensionAvailable(physicalDevice, VK_KHR_PRESENT_WAIT_EXTENSION_NAME)) {
+		VkPhysicalDeviceFeatures2 features2{};
+		features2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+		features2.pNext = &presentWaitFeatures;
+		vkGetPhysicalDeviceFeatures2(physicalDevice, &features2);
+		presentWaitSupported = presentIdFeatures.presentId && presentWaitFeatures.presentWait;
+	}
+	//featureṹ尴֧pNext
+	void* featureChain = nullptr;
+	if (presentWaitSupported) {
+		enabledExtensions.push_back(VK_KHR_PRESENT_ID_EXTENSION_NAME);
+		enabledExtensions.push_back(VK_KHR_PRESENT_WAIT_EXTENSION_NAME);
+		presentIdFeatures.pNext = featureChain;
+		featureChain = &presentWaitFeatures;
+	}
+
+	//mesh shaderֻtaskmeshfeatureģmultiviewɫʣò
+	VkPhysicalDeviceMeshShaderFeaturesEXT meshShaderFeatures{};
+	meshShaderFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MESH_SHADER_FEATURES_EXT;
+	meshShaderSupported = false;
+	if (isDeviceExtensionAvailable(physicalDevice, VK_EXT_MESH_SHADER_EXTENSION_NAME)) {
+		VkPhysicalDeviceFeatures2 features2{};
+		features2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+		features2.pNext = &meshShaderFeatures;
+		vkGetPhysicalDeviceFeatures2(physicalDevice, &features2);
+		meshShaderSupported = meshShaderFeatures.taskShader && meshShaderFeatures.meshShader;
+	}
+	if (meshShaderSupported) {
+		enabledExtensions.push_back(VK_EXT_MESH_SHADER_EXTENSION_NAME);
+		meshShaderFeatures.multiviewMeshShader = VK_FALSE;
+		meshShaderFeatures.primitiveFragmentShadingRateMeshShader = VK_FALSE;
+		meshShaderFeatures.meshShaderQueries = VK_FALSE;
+		meshShaderFeatures.pNext = featureChain;
+		featureChain = &meshShaderFeatures;
+	}
+
+	//timeline semaphore1.2ĺĹܣ֡ͬrateDeviceSuitabilityѾ֧
+	VkPhysicalDeviceTimelineSemaphoreFeatures timelineFeatures{};
+	timelineFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES;
+	timelineFeatures.timelineSemaphore = VK_TRUE;
+	timelineFeatures.pNext = featureChain;
+	featureChain = &timelineFeatures;
+
 	VkDeviceCreateInfo createInfo{};
 	createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+	createInfo.pNext = featureChain;
 	createInfo.pQueueCreateInfos = queueCreateInfos.data();
 	createInfo.queueCreateInfoCount = static_cast<uint32_t>(queueCreateInfos.size());
 	createInfo.pEnabledFeatures = &deviceFeatures;
-	createInfo.enabledExtensionCount = static_cast<uint32_t>(deviceExtensions.size());
-	createInfo.ppEnabledExtensionNames = deviceExtensions.data();
+	createInfo.enabledExtensionCount = static_cast<uint32_t>(enabledExtensions.size());
+	createInfo.ppEnabledExtensionNames = enabledExtensions.data();
 
 	// Ϊ豸ָʵͬУ
 	// ʵϣ°汾VulkanѾֶߵУ㣬
@@ -92,7 +152,12 @@ void myDevice::createLogicalDevice(bool enableValidationLayers, std::vector<cons
 
 	vkGetDeviceQueue(this->logicalDevice, queueFamilyIndices.graphicsFamily.value(), 0, &this->graphicsQueue);
 	vkGetDeviceQueue(this->logicalDevice, queueFamilyIndices.graphicsFamily.value(), 0, &this->presentQueue);
+	vkGetDeviceQueue(this->logicalDevice, queueFamilyIndices.computeFamily.value(), 0, &this->computeQueue);
+
+}
 
+bool myDevice::asyncComputeSupported() {
+	return queueFamilyIndices.computeFamily != queueFamilyIndices.graphicsFamily;
 }
 
 int myDevice::rateDeviceSuitability(VkSurfaceKHR surface, VkPhysicalDevice device) {
@@ -117,7 +182,20 @@ int myDevice::rateDeviceSuitability(VkSurfaceKHR surface, VkPhysicalDevice devic
 
 	VkPhysicalDeviceFeatures supportedFeatures;
 	vkGetPhysicalDeviceFeatures(device, &supportedFeatures);
-	if (queueFamilyIndices.isComplete() && extensionsSupport && swapChainAdequate && supportedFeatures.samplerAnisotropy) {
+
+	//֡ͬtimeline semaphoreҪ豸֧1.2
+	bool timelineSemaphoreSupport = false;
+	if (deviceProperties.apiVersion >= VK_API_VERSION_1_2) {
+		VkPhysicalDeviceTimelineSemaphoreFeatures timelineFeatures{};
+		timelineFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES;
+		VkPhysicalDeviceFeatures2 features2{};
+		features2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+		features2.pNext = &timelineFeatures;
+		vkGetPhysicalDeviceFeatures2(device, &features2);
+		timelineSemaphoreSupport = timelineFeatures.timelineSemaphore;
+	}
+
+	if (queueFamilyIndices.isComplete() && extensionsSupport && swapChainAdequate && supportedFeatures.samplerAnisotropy && supportedFeatures.shaderSampledImageArrayDynamicIndexing && timelineSemaphoreSupport) {
 		int score = 0;
 		if (deviceProperties.deviceType == VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU) {
 			score += 1000;
@@ -190,6 +268,18 @@ QueueFamilyIndices myDevice::findQueueFamilies(VkSurfaceKHR surface, VkPhysicalD
 		i++;
 	}
 
+	//ֻмʹ书ܵĶһӦӲ϶ļУԺͼζвִ
+	for (uint32_t j = 0; j < queueFamilyCount; j++) {
+		if ((queueFamilies[j].queueFlags & VK_QUEUE_COMPUTE_BIT) && !(queueFamilies[j].queueFlags & VK_QUEUE_GRAPHICS_BIT)) {
+			indices.computeFamily = j;
+			break;
+		}
+	}
+	//ͼζһּ֧
+	if (!indices.computeFamily.has_value()) {
+		indices.computeFamily = indices.graphicsFamily;
+	}
+
 	return indices;
 
 }
@@ -212,6 +302,23 @@ bool myDevice::checkDeviceExtensionSupport(VkPhysicalDevice device) {
 
 }
 
+bool myDevice::isDeviceExtensionAvailable(VkPhysicalDevice device, const char* extensionName) {
+
+	uint32_t extensionCount;
+	vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, nullptr);
+
+	std::vector<VkExtensionProperties> availableExtensions(extensionCount);
+	vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, availableExtensions.data());
+
+	for (const auto& extension : availableExtensions) {
+		if (strcmp(extension.extensionName, extensionName) == 0) {
+			return true;
+		}
+	}
+	return false;
+
+}
+
 VkSampleCountFlagBits myDevice::getMaxUsableSampleCount() {
 	VkPhysicalDeviceProperties physicalDeviceProperties;
 	vkGetPhysicalDeviceProperties(physicalDevice, &physicalDeviceProperties);
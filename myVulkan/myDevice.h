@@ -6,6 +6,7 @@
 #include<vector>
 #include<map>
 #include<set>
+#include<cstring>
 
 #include "structSet.h"
 
@@ -24,7 +25,7 @@ public:
 
 	VkQueue graphicsQueue;
 	VkQueue presentQueue;
-	VkQueue computeQueue;
+	VkQueue computeQueue;	//ûжļʱgraphicsQueueͬһ
 
 	SwapChainSupportDetails swapChainSupportDetails;
 	QueueFamilyIndices queueFamilyIndices;
@@ -35,6 +36,14 @@ public:
 		VK_KHR_SWAPCHAIN_EXTENSION_NAME
 	};
 
+	//ѡչ֧־Ϳ֧ҲӰ
+	bool presentWaitSupported = false;	//VK_KHR_present_id + VK_KHR_present_waitʾʱ
+	bool meshShaderSupported = false;	//VK_EXT_mesh_shadertaskmesh shader֧ʱmeshlettask shader޳
+	bool multiDrawIndirectSupported = false;	//֧ʱһμӻֻܻһ
+
+	//жļʱԺͼζصִ
+	bool asyncComputeSupported();
+
 	//캯
 	myDevice(VkInstance instance, VkSurfaceKHR surface);
 
@@ -47,6 +56,7 @@ public:
 	SwapChainSupportDetails querySwapChainSupport(VkSurfaceKHR surface, VkPhysicalDevice device);
 	QueueFamilyIndices findQueueFamilies(VkSurfaceKHR surface, VkPhysicalDevice device);
 	bool checkDeviceExtensionSupport(VkPhysicalDevice device);
+	bool isDeviceExtensionAvailable(VkPhysicalDevice device, const char* extensionName);
 	VkSampleCountFlagBits getMaxUsableSampleCount();
 	//uint32_t findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties);
 
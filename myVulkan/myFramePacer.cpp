@@ -0,0 +1,124 @@
+#include "myFramePacer.h"
+
+#include <thread>
+#include <algorithm>
+#include <sstream>
+#include <iomanip>
+
+myFramePacer::myFramePacer(double targetFrameTime, double reportInterval) {
+	this->targetFrameTime = targetFrameTime;
+	this->reportInterval = reportInterval;
+}
+
+double myFramePacer::elapsed(Clock::time_point from, Clock::time_point to) {
+	return std::chrono::duration<double, std::milli>(to - from).count();
+}
+
+void myFramePacer::waitForNextFrame() {
+
+	Clock::time_point now = Clock::now();
+	if (!started) {
+		started = true;
+		nextDeadline = now;
+		reportStartTime = now;
+	}
+
+	if (targetFrameTime > 0.0) {
+		//sleepľһֻ1msңWindowsϿܸһСyield
+		const double spinTime = 2.0;
+		double remaining = elapsed(now, nextDeadline);
+		if (remaining > spinTime) {
+			std::this_thread::sleep_for(std::chrono::duration<double, std::milli>(remaining - spinTime));
+		}
+		while (Clock::now() < nextDeadline) {
+			std::this_thread::yield();
+		}
+		now = Clock::now();
+
+		//󳬹һ֡Ͳ׷ˣ򿨶ٺܳü֡
+		auto frameDuration = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double, std::milli>(targetFrameTime));
+		nextDeadline += frameDuration;
+		if (nextDeadline < now) {
+			nextDeadline = now + frameDuration;
+		}
+	}
+
+	frameStartTime = now;
+
+}
+
+void myFramePacer::markInput() {
+	inputTime = Clock::now();
+}
+
+void myFramePacer::addFenceWait(double time) {
+	periodStats.fenceWaitTime += time;
+	totalStats.fenceWaitTime += time;
+}
+
+void myFramePacer::addPresentLatency(double time) {
+	for (FrameStats* stats : { &periodStats, &totalStats }) {
+		stats->presentCount++;
+		stats->presentLatency += time;
+		stats->maxPresentLatency = std::max(stats->maxPresentLatency, time);
+	}
+}
+
+bool myFramePacer::markPresent() {
+
+	Clock::time_point now = Clock::now();
+	double frameTime = elapsed(frameStartTime, now);
+	double latency = elapsed(inputTime, now);
+
+	for (FrameStats* stats : { &periodStats, &totalStats }) {
+		stats->frameCount++;
+		stats->frameTime += frameTime;
+		stats->inputLatency += latency;
+		stats->maxInputLatency = std::max(stats->maxInputLatency, latency);
+	}
+
+	double periodTime = elapsed(reportStartTime, now);
+	if (periodTime < reportInterval) {
+		return false;
+	}
+
+	//frameTimeڵƽֻ֡CPUһ֡Ĺʱ
+	lastReport = periodStats;
+	lastReport.frameTime = periodTime / periodStats.frameCount;
+	lastReport.fenceWaitTime /= periodStats.frameCount;
+	lastReport.inputLatency /= periodStats.frameCount;
+	if (periodStats.presentCount > 0) {
+		lastReport.presentLatency /= periodStats.presentCount;
+	}
+	periodStats = FrameStats{};
+	reportStartTime = now;
+	return true;
+
+}
+
+std::string myFramePacer::statsString() {
+	std::ostringstream stream;
+	stream << std::fixed << std::setprecision(1)
+		<< (lastReport.frameTime > 0.0 ? 1000.0 / lastReport.frameTime : 0.0) << " fps, "
+		<< lastReport.frameTime << " ms, fence wait " << lastReport.fenceWaitTime << " ms, input latency "
+		<< lastReport.inputLatency << " ms (max " << lastReport.maxInputLatency << " ms)";
+	if (lastReport.presentCount > 0) {
+		stream << ", present latency " << lastReport.presentLatency << " ms (max " << lastReport.maxPresentLatency << " ms)";
+	}
+	return stream.str();
+}
+
+void myFramePacer::printStats() {
+	if (totalStats.frameCount == 0) {
+		return;
+	}
+	std::cout << "frames: " << totalStats.frameCount
+		<< ", avg fence wait " << totalStats.fenceWaitTime / totalStats.frameCount << " ms"
+		<< ", avg input latency " << totalStats.inputLatency / totalStats.frameCount << " ms"
+		<< ", max input latency " << totalStats.maxInputLatency << " ms";
+	if (totalStats.presentCount > 0) {
+		std::cout << ", avg present latency " << totalStats.presentLatency / totalStats.presentCount << " ms"
+			<< ", max present latency " << totalStats.maxPresentLatency << " ms";
+	}
+	std::cout << std::endl;
+}
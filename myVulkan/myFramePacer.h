@@ -0,0 +1,65 @@
+#pragma once
+
+#include <iostream>
+#include <string>
+#include <chrono>
+
+#ifndef MY_FRAME_PACER
+#define MY_FRAME_PACER
+
+//һʱڵ֡ͳƣʱ䵥λΪms
+struct FrameStats {
+	uint32_t frameCount = 0;
+	double frameTime = 0.0;
+	double fenceWaitTime = 0.0;	//ȴе֡ʱ䣬˵GPUƿ
+	double inputLatency = 0.0;	//뵽vkQueuePresentKHRصƽʱ
+	double maxInputLatency = 0.0;
+	//뵽ʾʱ䣬ҪVK_KHR_present_wait֡ܺframeCountͬ
+	uint32_t presentCount = 0;
+	double presentLatency = 0.0;
+	double maxPresentLatency = 0.0;
+};
+
+//֡ʱԤ֡ʣͳ뵽ֵӳ
+//ȴڲ֮ǰ֡ʱʱ䲻ӳ
+class myFramePacer {
+
+public:
+
+	double targetFrameTime;	//ms0ʾ
+	double reportInterval;	//ûһͳƣms
+
+	FrameStats lastReport;	//һڵƽֵ
+	FrameStats totalStats;	//ڼۼֵ
+
+	myFramePacer(double targetFrameTime, double reportInterval = 500.0);
+
+	//ÿ֡ͷ֮ǰãҪʱ˯һ֡Ľֹʱ
+	void waitForNextFrame();
+	void markInput();
+	void addFenceWait(double time);
+	void addPresentLatency(double time);
+	std::chrono::steady_clock::time_point lastInputTime() { return inputTime; }
+	//vkQueuePresentKHRغãһڽʱtrueʱlastReportѸ
+	bool markPresent();
+
+	std::string statsString();
+	void printStats();
+
+private:
+
+	using Clock = std::chrono::steady_clock;
+
+	Clock::time_point nextDeadline;
+	Clock::time_point frameStartTime;
+	Clock::time_point inputTime;
+	Clock::time_point reportStartTime;
+	bool started = false;
+
+	FrameStats periodStats;
+
+	static double elapsed(Clock::time_point from, Clock::time_point to);
+
+};
+
+#endif
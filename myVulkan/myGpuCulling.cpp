@@ -0,0 +1,336 @@
+#include "myGpuCulling.h"
+
+#include <algorithm>
+
+myGpuCulling::myGpuCulling(myDevice* device, VkQueue queue, VkCommandPool commandPool, std::vector<uint32_t> queueFamilies, const std::vector<Mesh>& meshs, VkBuffer positionBuffer, VkBuffer attributeBuffer, uint32_t frameSize, myPipelineManager* pipelineManager) {
+
+	this->logicalDevice = device->logicalDevice;
+	this->pipelineManager = pipelineManager;
+	this->multiDrawIndirect = device->multiDrawIndirectSupported;
+	this->meshShaderEnabled = device->meshShaderSupported;
+	VkPhysicalDevice physicalDevice = device->physicalDevice;
+
+	//meshӶƫƣӻbaseVertexmeshletVerticesmesh shaderֱӶϣɺϲ󶥵㻺
+	std::vector<CullClusterData> clusterData;
+	std::vector<uint32_t> meshletVertices;
+	std::vector<uint32_t> meshletTriangles;
+	for (const Mesh& mesh : meshs) {
+		//buildMeshletsLOD˳ɣÿmeshletһ
+		std::vector<uint32_t> firstClusters;
+		for (const MeshLod& lod : mesh.lods) {
+			firstClusters.push_back(static_cast<uint32_t>(clusterData.size()) + lod.firstMeshlet);
+		}
+		firstClusters.push_back(static_cast<uint32_t>(clusterData.size() + mesh.meshlets.size()));
+		lodFirstClusters.push_back(firstClusters);
+		for (const Meshlet& meshlet : mesh.meshlets) {
+			CullClusterData data;
+			data.boundingSphere = meshlet.boundingSphere;
+			data.cone = meshlet.cone;
+			data.firstIndex = mesh.firstIndex + meshlet.firstIndex;
+			data.indexCount = meshlet.indexCount;
+			data.vertexOffset = static_cast<uint32_t>(meshletVertices.size()) + meshlet.vertexOffset;
+			data.vertexCount = meshlet.vertexCount;
+			data.baseVertex = static_cast<int32_t>(mesh.firstVertex);
+			data.firstTriangle = static_cast<uint32_t>(meshletTriangles.size()) + meshlet.firstIndex / 3;
+			data.padding[0] = 0;
+			data.padding[1] = 0;
+			clusterData.push_back(data);
+		}
+		if (meshShaderEnabled) {
+			for (uint32_t vertex : mesh.meshletVertices) {
+				meshletVertices.push_back(mesh.firstVertex + vertex);
+			}
+			meshletTriangles.insert(meshletTriangles.end(), mesh.meshletTriangles.begin(), mesh.meshletTriangles.end());
+		}
+	}
+	this->clusterCount = static_cast<uint32_t>(clusterData.size());
+	if (clusterCount == 0) {
+		throw std::runtime_error("failed to create gpu culling: model has no meshlet!");
+	}
+
+	uploadBuffer(physicalDevice, queue, commandPool, clusterData.data(), sizeof(CullClusterData) * clusterCount, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, clusterDataBuffer, clusterDataBufferMemory, queueFamilies);
+
+	indirectBuffers.resize(frameSize);
+	indirectBuffersMemory.resize(frameSize);
+	for (uint32_t i = 0; i < frameSize; i++) {
+		myBuffer::createBuffer(physicalDevice, logicalDevice, sizeof(VkDrawIndexedIndirectCommand) * clusterCount, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, indirectBuffers[i], indirectBuffersMemory[i], queueFamilies);
+	}
+	pushConstants.resize(frameSize);
+	for (CullPushConstants& constants : pushConstants) {
+		constants.firstCluster = 0;
+		constants.clusterCount = clusterCount;
+	}
+
+	createDescriptorSets(frameSize);
+
+	VkPushConstantRange pushConstantRange{};
+	pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+	pushConstantRange.offset = 0;
+	pushConstantRange.size = sizeof(CullPushConstants);
+
+	VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+	pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+	pipelineLayoutInfo.setLayoutCount = 1;
+	pipelineLayoutInfo.pSetLayouts = &descriptorSetLayout;
+	pipelineLayoutInfo.pushConstantRangeCount = 1;
+	pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+	if (vkCreatePipelineLayout(logicalDevice, &pipelineLayoutInfo, nullptr, &pipelineLayout) != VK_SUCCESS) {
+		throw std::runtime_error("failed to create pipeline layout!");
+	}
+
+	ComputePipelineDesc pipelineDesc;
+	pipelineDesc.compShader = "cullComp.spv";
+	pipelineDesc.layout = pipelineLayout;
+	pipelineIndex = pipelineManager->addComputePipeline("cull", std::move(pipelineDesc));
+
+	if (meshShaderEnabled) {
+		uploadBuffer(physicalDevice, queue, commandPool, meshletVertices.data(), sizeof(uint32_t) * meshletVertices.size(), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, meshletVertexBuffer, meshletVertexBufferMemory, queueFamilies);
+		uploadBuffer(physicalDevice, queue, commandPool, meshletTriangles.data(), sizeof(uint32_t) * meshletTriangles.size(), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, meshletTriangleBuffer, meshletTriangleBufferMemory, queueFamilies);
+		createMeshShaderDescriptorSet(positionBuffer, attributeBuffer);
+		//չloaderķҪԼȡ
+		cmdDrawMeshTasks = reinterpret_cast<PFN_vkCmdDrawMeshTasksEXT>(vkGetDeviceProcAddr(logicalDevice, "vkCmdDrawMeshTasksEXT"));
+		if (!cmdDrawMeshTasks) {
+			throw std::runtime_error("failed to load vkCmdDrawMeshTasksEXT!");
+		}
+	}
+
+}
+
+void myGpuCulling::uploadBuffer(VkPhysicalDevice physicalDevice, VkQueue queue, VkCommandPool commandPool, const void* data, VkDeviceSize size, VkBufferUsageFlags usage, VkBuffer& buffer, VkDeviceMemory& bufferMemory, std::vector<uint32_t> queueFamilies) {
+
+	VkBuffer stagingBuffer;
+	VkDeviceMemory stagingBufferMemory;
+	myBuffer::createBuffer(physicalDevice, logicalDevice, size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingBufferMemory);
+	void* mapped;
+	vkMapMemory(logicalDevice, stagingBufferMemory, 0, size, 0, &mapped);
+	memcpy(mapped, data, (size_t)size);
+	vkUnmapMemory(logicalDevice, stagingBufferMemory);
+
+	myBuffer::createBuffer(physicalDevice, logicalDevice, size, VK_BUFFER_USAGE_TRANSFER_DST_BIT | usage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, buffer, bufferMemory, queueFamilies);
+	myBuffer::copyBuffer(logicalDevice, queue, commandPool, stagingBuffer, buffer, size);
+	vkDestroyBuffer(logicalDevice, stagingBuffer, nullptr);
+	vkFreeMemory(logicalDevice, stagingBufferMemory, nullptr);
+
+}
+
+void myGpuCulling::createDescriptorSets(uint32_t frameSize) {
+
+	//binding 0Ϊmeshletݣbinding 1Ϊһ֡ļӻƻ
+	std::array<VkDescriptorSetLayoutBinding, 2> bindings{};
+	for (uint32_t i = 0; i < bindings.size(); i++) {
+		bindings[i].binding = i;
+		bindings[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		bindings[i].descriptorCount = 1;
+		bindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+	}
+
+	VkDescriptorSetLayoutCreateInfo layoutInfo{};
+	layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+	layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+	layoutInfo.pBindings = bindings.data();
+	if (vkCreateDescriptorSetLayout(logicalDevice, &layoutInfo, nullptr, &descriptorSetLayout) != VK_SUCCESS) {
+		throw std::runtime_error("failed to create descriptor set layout!");
+	}
+
+	VkDescriptorPoolSize poolSize{};
+	poolSize.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+	//mesh shaderҲ䣬֡һ
+	poolSize.descriptorCount = static_cast<uint32_t>(bindings.size()) * frameSize + (meshShaderEnabled ? MESH_SHADER_BINDING_NUM : 0);
+	VkDescriptorPoolCreateInfo poolInfo{};
+	poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+	poolInfo.poolSizeCount = 1;
+	poolInfo.pPoolSizes = &poolSize;
+	poolInfo.maxSets = frameSize + (meshShaderEnabled ? 1 : 0);
+	if (vkCreateDescriptorPool(logicalDevice, &poolInfo, nullptr, &descriptorPool) != VK_SUCCESS) {
+		throw std::runtime_error("failed to create descriptor pool!");
+	}
+
+	std::vector<VkDescriptorSetLayout> layouts(frameSize, descriptorSetLayout);
+	VkDescriptorSetAllocateInfo allocInfo{};
+	allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+	allocInfo.descriptorPool = descriptorPool;
+	allocInfo.descriptorSetCount = frameSize;
+	allocInfo.pSetLayouts = layouts.data();
+	descriptorSets.resize(frameSize);
+	if (vkAllocateDescriptorSets(logicalDevice, &allocInfo, descriptorSets.data()) != VK_SUCCESS) {
+		throw std::runtime_error("failed to allocate descriptor sets!");
+	}
+
+	for (uint32_t i = 0; i < frameSize; i++) {
+
+		std::array<VkDescriptorBufferInfo, 2> bufferInfos{};
+		bufferInfos[0].buffer = clusterDataBuffer;
+		bufferInfos[0].offset = 0;
+		bufferInfos[0].range = VK_WHOLE_SIZE;
+		bufferInfos[1].buffer = indirectBuffers[i];
+		bufferInfos[1].offset = 0;
+		bufferInfos[1].range = VK_WHOLE_SIZE;
+
+		std::array<VkWriteDescriptorSet, 2> descriptorWrites{};
+		for (uint32_t j = 0; j < descriptorWrites.size(); j++) {
+			descriptorWrites[j].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			descriptorWrites[j].dstSet = descriptorSets[i];
+			descriptorWrites[j].dstBinding = j;
+			descriptorWrites[j].dstArrayElement = 0;
+			descriptorWrites[j].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+			descriptorWrites[j].descriptorCount = 1;
+			descriptorWrites[j].pBufferInfo = &bufferInfos[j];
+		}
+		vkUpdateDescriptorSets(logicalDevice, static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0, nullptr);
+
+	}
+
+}
+
+//binding 0Ϊmeshletݣ1ΪmeshletVertices2ΪmeshletTriangles3ΪϲĶ㻺
+void myGpuCulling::createMeshShaderDescriptorSet(VkBuffer positionBuffer, VkBuffer attributeBuffer) {
+
+	std::array<VkDescriptorSetLayoutBinding, MESH_SHADER_BINDING_NUM> bindings{};
+	for (uint32_t i = 0; i < bindings.size(); i++) {
+		bindings[i].binding = i;
+		bindings[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		bindings[i].descriptorCount = 1;
+		bindings[i].stageFlags = VK_SHADER_STAGE_TASK_BIT_EXT | VK_SHADER_STAGE_MESH_BIT_EXT;
+	}
+
+	VkDescriptorSetLayoutCreateInfo layoutInfo{};
+	layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+	layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+	layoutInfo.pBindings = bindings.data();
+	if (vkCreateDescriptorSetLayout(logicalDevice, &layoutInfo, nullptr, &meshShaderDescriptorSetLayout) != VK_SUCCESS) {
+		throw std::runtime_error("failed to create descriptor set layout!");
+	}
+
+	VkDescriptorSetAllocateInfo allocInfo{};
+	allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+	allocInfo.descriptorPool = descriptorPool;
+	allocInfo.descriptorSetCount = 1;
+	allocInfo.pSetLayouts = &meshShaderDescriptorSetLayout;
+	if (vkAllocateDescriptorSets(logicalDevice, &allocInfo, &meshShaderDescriptorSet) != VK_SUCCESS) {
+		throw std::runtime_error("failed to allocate descriptor sets!");
+	}
+
+	std::array<VkBuffer, MESH_SHADER_BINDING_NUM> buffers = { clusterDataBuffer, meshletVertexBuffer, meshletTriangleBuffer, positionBuffer, attributeBuffer };
+	std::array<VkDescriptorBufferInfo, MESH_SHADER_BINDING_NUM> bufferInfos{};
+	std::array<VkWriteDescriptorSet, MESH_SHADER_BINDING_NUM> descriptorWrites{};
+	for (uint32_t i = 0; i < descriptorWrites.size(); i++) {
+		bufferInfos[i].buffer = buffers[i];
+		bufferInfos[i].offset = 0;
+		bufferInfos[i].range = VK_WHOLE_SIZE;
+		descriptorWrites[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		descriptorWrites[i].dstSet = meshShaderDescriptorSet;
+		descriptorWrites[i].dstBinding = i;
+		descriptorWrites[i].dstArrayElement = 0;
+		descriptorWrites[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		descriptorWrites[i].descriptorCount = 1;
+		descriptorWrites[i].pBufferInfo = &bufferInfos[i];
+	}
+	vkUpdateDescriptorSets(logicalDevice, static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0, nullptr);
+
+}
+
+void myGpuCulling::setFrustum(uint32_t frameIndex, const glm::mat4& matrix, const glm::vec3& cameraPosition) {
+	std::array<glm::vec4, 6> planes = extractFrustumPlanes(matrix);
+	std::copy(planes.begin(), planes.end(), pushConstants[frameIndex].frustumPlanes);
+	pushConstants[frameIndex].cameraPosition = glm::vec4(cameraPosition, 1.0f);
+}
+
+bool myGpuCulling::record(VkCommandBuffer commandBuffer, uint32_t frameIndex) {
+
+	if (pipelineManager->isFailed(pipelineIndex)) {
+		if (!failureReported) {
+			std::cerr << "GPU culling disabled: cull pipeline failed to compile, drawing all meshes" << std::endl;
+			failureReported = true;
+		}
+		return false;
+	}
+	VkPipeline pipeline = pipelineManager->getPipeline(pipelineIndex);
+	if (pipeline == VK_NULL_HANDLE) {
+		return false;
+	}
+
+	vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+	vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout, 0, 1, &descriptorSets[frameIndex], 0, nullptr);
+	vkCmdPushConstants(commandBuffer, pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(CullPushConstants), &pushConstants[frameIndex]);
+	//cullComp.complocal_size_x = 64
+	vkCmdDispatch(commandBuffer, (clusterCount + 63) / 64, 1, 1);
+	return true;
+
+}
+
+void myGpuCulling::drawIndirect(VkCommandBuffer commandBuffer, uint32_t frameIndex, uint32_t meshIndex, uint32_t lod) {
+
+	uint32_t firstCluster = lodFirstClusters[meshIndex][lod];
+	uint32_t meshClusterCount = lodFirstClusters[meshIndex][lod + 1] - firstCluster;
+	VkDeviceSize stride = sizeof(VkDrawIndexedIndirectCommand);
+	//ûmultiDrawIndirectʱdrawCountֻ01ֻһһ
+	if (multiDrawIndirect) {
+		vkCmdDrawIndexedIndirect(commandBuffer, indirectBuffers[frameIndex], firstCluster * stride, meshClusterCount, static_cast<uint32_t>(stride));
+	}
+	else {
+		for (uint32_t i = 0; i < meshClusterCount; i++) {
+			vkCmdDrawIndexedIndirect(commandBuffer, indirectBuffers[frameIndex], (firstCluster + i) * stride, 1, static_cast<uint32_t>(stride));
+		}
+	}
+
+}
+
+void myGpuCulling::drawMeshTasks(VkCommandBuffer commandBuffer, VkPipelineLayout meshPipelineLayout, uint32_t frameIndex, uint32_t meshIndex, uint32_t lod) {
+
+	CullPushConstants constants = pushConstants[frameIndex];
+	constants.firstCluster = lodFirstClusters[meshIndex][lod];
+	constants.clusterCount = lodFirstClusters[meshIndex][lod + 1] - constants.firstCluster;
+	if (constants.clusterCount == 0) {
+		return;
+	}
+	vkCmdPushConstants(commandBuffer, meshPipelineLayout, VK_SHADER_STAGE_TASK_BIT_EXT | VK_SHADER_STAGE_MESH_BIT_EXT, 0, sizeof(CullPushConstants), &constants);
+	//gBufferTask.tasklocal_size_x = 32
+	cmdDrawMeshTasks(commandBuffer, (constants.clusterCount + 31) / 32, 1, 1);
+
+}
+
+//Gribb-Hartmannüռ-w <= x,y <= w0 <= z <= wGLM_FORCE_DEPTH_ZERO_TO_ONE
+//Zʱz = 0Զƽ棬z = wǽƽ棻ԶͶӰz = 0ƽ˻ͨƽ
+std::array<glm::vec4, 6> myGpuCulling::extractFrustumPlanes(const glm::mat4& matrix) {
+
+	//glmmatrix[c][r]
+	glm::vec4 rows[4];
+	for (int r = 0; r < 4; r++) {
+		rows[r] = glm::vec4(matrix[0][r], matrix[1][r], matrix[2][r], matrix[3][r]);
+	}
+
+	std::array<glm::vec4, 6> planes = {
+		rows[3] + rows[0],	//
+		rows[3] - rows[0],	//
+		rows[3] + rows[1],	//
+		rows[3] - rows[1],	//
+		rows[2],			//ZʱΪԶ
+		rows[3] - rows[2]	//ԶZʱΪ
+	};
+	//һwǵƽľ룬ԲֱӺͰ뾶Ƚ
+	for (glm::vec4& plane : planes) {
+		float length = glm::length(glm::vec3(plane));
+		plane = length > 0.0f ? plane / length : glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+	}
+	return planes;
+
+}
+
+void myGpuCulling::clean() {
+	vkDestroyPipelineLayout(logicalDevice, pipelineLayout, nullptr);
+	vkDestroyDescriptorPool(logicalDevice, descriptorPool, nullptr);
+	vkDestroyDescriptorSetLayout(logicalDevice, descriptorSetLayout, nullptr);
+	for (uint32_t i = 0; i < indirectBuffers.size(); i++) {
+		vkDestroyBuffer(logicalDevice, indirectBuffers[i], nullptr);
+		vkFreeMemory(logicalDevice, indirectBuffersMemory[i], nullptr);
+	}
+	vkDestroyBuffer(logicalDevice, clusterDataBuffer, nullptr);
+	vkFreeMemory(logicalDevice, clusterDataBufferMemory, nullptr);
+	if (meshShaderEnabled) {
+		vkDestroyDescriptorSetLayout(logicalDevice, meshShaderDescriptorSetLayout, nullptr);
+		vkDestroyBuffer(logicalDevice, meshletVertexBuffer, nullptr);
+		vkFreeMemory(logicalDevice, meshletVertexBufferMemory, nullptr);
+		vkDestroyBuffer(logicalDevice, meshletTriangleBuffer, nullptr);
+		vkFreeMemory(logicalDevice, meshletTriangleBufferMemory, nullptr);
+	}
+}
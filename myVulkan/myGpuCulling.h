@@ -0,0 +1,107 @@
+#pragma once
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include <iostream>
+#include <vector>
+#include <array>
+
+#include "structSet.h"
+#include "myDevice.h"
+#include "myBuffer.h"
+#include "myPipelineManager.h"
+
+#ifndef MY_GPU_CULLING
+#define MY_GPU_CULLING
+
+//cullComp.compgBufferTask.taskgBufferMesh.meshеClusterDataӦ
+//std430нṹ尴16ֽڶ룬Բ64ֽ
+struct CullClusterData {
+	glm::vec4 boundingSphere;	//xyzΪģͿռģwΪ뾶
+	glm::vec4 cone;	//xyzΪ׶ᣬwΪ׶ǵ
+	uint32_t firstIndex;	//meshȵһλ
+	uint32_t indexCount;
+	uint32_t vertexOffset;	//ںϲmeshletVerticesеλ
+	uint32_t vertexCount;
+	int32_t baseVertex;	//meshĵһ㣬ӻƵvertexOffsetmeshԼĶ
+	uint32_t firstTriangle;	//ںϲmeshletTrianglesеλ
+	uint32_t padding[2];
+};
+
+//cullComp.compgBufferTask.taskеpush constantӦ128ֽ
+struct CullPushConstants {
+	glm::vec4 frustumPlanes[6];	//ģͿռ׶ƽ棬߳
+	glm::vec4 cameraPosition;	//ģͿռλãڷ׶ı޳
+	uint32_t firstCluster;
+	uint32_t clusterCount;
+};
+
+//meshletΪλ׶޳ͷ׶޳LODmeshletһ޳ʱֻȡѡеһ
+//ӻƣɫÿmeshletдһVkDrawIndexedIndirectCommand޳instanceCountΪ0һmeshmeshletڻһζؼӻƻ
+//mesh shader֧VK_EXT_mesh_shaderʱtask shader޳mesh shaderֱӴӴ洢㣬Ҫpass
+//ÿе֡һӻƻ壬дһ֡ʱͼζпԻڶһ֡
+class myGpuCulling {
+
+public:
+
+	VkDevice logicalDevice;
+	uint32_t clusterCount;
+	//ÿLODmeshletimeshlLODmeshletΪ[lodFirstClusters[i][l], lodFirstClusters[i][l + 1])
+	std::vector<std::vector<uint32_t>> lodFirstClusters;
+	bool multiDrawIndirect;
+
+	VkBuffer clusterDataBuffer;
+	VkDeviceMemory clusterDataBufferMemory;
+	std::vector<VkBuffer> indirectBuffers;
+	std::vector<VkDeviceMemory> indirectBuffersMemory;
+
+	VkDescriptorSetLayout descriptorSetLayout;
+	VkDescriptorPool descriptorPool;
+	std::vector<VkDescriptorSet> descriptorSets;
+	VkPipelineLayout pipelineLayout;
+
+	myPipelineManager* pipelineManager;
+	uint32_t pipelineIndex;
+
+	std::vector<CullPushConstants> pushConstants;	//ÿе֡һݣupdateUniformBufferʱ
+
+	//mesh shaderõԴ֧ʱVK_NULL_HANDLE
+	//set 2bindingΪmeshletݡmeshletVerticesmeshletTrianglesλ
+	static const uint32_t MESH_SHADER_BINDING_NUM = 5;
+	bool meshShaderEnabled;
+	VkBuffer meshletVertexBuffer = VK_NULL_HANDLE;
+	VkDeviceMemory meshletVertexBufferMemory = VK_NULL_HANDLE;
+	VkBuffer meshletTriangleBuffer = VK_NULL_HANDLE;
+	VkDeviceMemory meshletTriangleBufferMemory = VK_NULL_HANDLE;
+	VkDescriptorSetLayout meshShaderDescriptorSetLayout = VK_NULL_HANDLE;
+	VkDescriptorSet meshShaderDescriptorSet = VK_NULL_HANDLE;
+	PFN_vkCmdDrawMeshTasksEXT cmdDrawMeshTasks = nullptr;
+
+	//queueFamiliesΪЩĶ壨ͼκͼ㣩positionBufferattributeBufferΪϲmesh shaderǵ洢
+	myGpuCulling(myDevice* device, VkQueue queue, VkCommandPool commandPool, std::vector<uint32_t> queueFamilies, const std::vector<Mesh>& meshs, VkBuffer positionBuffer, VkBuffer attributeBuffer, uint32_t frameSize, myPipelineManager* pipelineManager);
+
+	//matrixΪproj * view * modelȡģͿռ׶ƽ棻cameraPositionҲҪģͿռ
+	//ģ;ֻоţģͿռķ׶ռĶԲ
+	void setFrustum(uint32_t frameIndex, const glm::mat4& matrix, const glm::vec3& cameraPosition);
+	//ΪmyComputeScheduler񣬹ûû߱ʧʱfalseͼζ˻صֱӻ
+	bool record(VkCommandBuffer commandBuffer, uint32_t frameIndex);
+	//meshIndexmeshlodû޳meshletrecordһ֡뷵trueҪmeshindexType
+	void drawIndirect(VkCommandBuffer commandBuffer, uint32_t frameIndex, uint32_t meshIndex, uint32_t lod);
+	//mesh shaderѾ󶨣set 2ΪmeshShaderDescriptorSettask shaderÿ鴦32meshlet
+	void drawMeshTasks(VkCommandBuffer commandBuffer, VkPipelineLayout meshPipelineLayout, uint32_t frameIndex, uint32_t meshIndex, uint32_t lod);
+
+	static std::array<glm::vec4, 6> extractFrustumPlanes(const glm::mat4& matrix);
+
+	void clean();
+
+private:
+
+	bool failureReported = false;
+
+	void createDescriptorSets(uint32_t frameSize);
+	void createMeshShaderDescriptorSet(VkBuffer positionBuffer, VkBuffer attributeBuffer);
+	void uploadBuffer(VkPhysicalDevice physicalDevice, VkQueue queue, VkCommandPool commandPool, const void* data, VkDeviceSize size, VkBufferUsageFlags usage, VkBuffer& buffer, VkDeviceMemory& bufferMemory, std::vector<uint32_t> queueFamilies);
+
+};
+
+#endif
@@ -0,0 +1,269 @@
+#include "myGpuProfiler.h"
+
+#include <algorithm>
+
+static const size_t MAX_TRACE_EVENTS = 100000;
+
+void GpuScopeStats::addSample(double time) {
+	samples[nextSample] = time;
+	nextSample = (nextSample + 1) % SAMPLE_NUM;
+	sampleCount = std::min(sampleCount + 1, SAMPLE_NUM);
+}
+
+double GpuScopeStats::minTime() {
+	return sampleCount == 0 ? 0.0 : *std::min_element(samples.begin(), samples.begin() + sampleCount);
+}
+
+double GpuScopeStats::avgTime() {
+	double sum = 0.0;
+	for (uint32_t i = 0; i < sampleCount; i++) {
+		sum += samples[i];
+	}
+	return sampleCount == 0 ? 0.0 : sum / sampleCount;
+}
+
+double GpuScopeStats::maxTime() {
+	return sampleCount == 0 ? 0.0 : *std::max_element(samples.begin(), samples.begin() + sampleCount);
+}
+
+myGpuProfiler::myGpuProfiler(VkPhysicalDevice physicalDevice, VkDevice logicalDevice, uint32_t queueFamilyIndex, uint32_t frameSize, uint32_t maxScopes) {
+
+	this->logicalDevice = logicalDevice;
+	this->maxScopes = maxScopes;
+
+	VkPhysicalDeviceProperties deviceProperties;
+	vkGetPhysicalDeviceProperties(physicalDevice, &deviceProperties);
+	this->timestampPeriod = deviceProperties.limits.timestampPeriod;
+
+	uint32_t queueFamilyCount = 0;
+	vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, nullptr);
+	std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+	vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, queueFamilies.data());
+	uint32_t validBits = queueFamilies[queueFamilyIndex].timestampValidBits;
+	if (validBits == 0) {
+		std::cout << "queue family does not support timestamps, GPU profiler disabled" << std::endl;
+		this->enabled = false;
+		return;
+	}
+	this->timestampMask = validBits >= 64 ? ~0ull : ((1ull << validBits) - 1);
+
+	VkQueryPoolCreateInfo queryPoolInfo{};
+	queryPoolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+	queryPoolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+	queryPoolInfo.queryCount = maxScopes * 2;	//ÿΧʼͽһ
+
+	frameQueries.resize(frameSize);
+	for (uint32_t i = 0; i < frameSize; i++) {
+		if (vkCreateQueryPool(logicalDevice, &queryPoolInfo, nullptr, &frameQueries[i].queryPool) != VK_SUCCESS) {
+			throw std::runtime_error("failed to create query pool!");
+		}
+	}
+
+	queryPoolInfo.queryCount = MAX_IMMEDIATE_SCOPES * 2;
+	if (vkCreateQueryPool(logicalDevice, &queryPoolInfo, nullptr, &immediateQueryPool) != VK_SUCCESS) {
+		throw std::runtime_error("failed to create query pool!");
+	}
+	for (uint32_t i = 0; i < MAX_IMMEDIATE_SCOPES; i++) {
+		freeImmediateQueries.push_back(i * 2);
+	}
+
+}
+
+void myGpuProfiler::beginFrame(VkCommandBuffer commandBuffer, uint32_t frameIndex) {
+
+	if (!enabled) {
+		return;
+	}
+
+	currentFrameIndex = frameIndex;
+	GpuFrameQueries& frame = frameQueries[frameIndex];
+	if (frame.pending) {
+		readFrameResults(frame);
+	}
+
+	//queryдǰãҲrender pass
+	vkCmdResetQueryPool(commandBuffer, frame.queryPool, 0, maxScopes * 2);
+	frame.scopeNames.clear();
+	frame.queryCount = 0;
+	frame.cpuRecordTime = nowTime();
+	frame.pending = true;
+
+}
+
+uint32_t myGpuProfiler::beginScope(VkCommandBuffer commandBuffer, const std::string& name) {
+
+	if (!enabled) {
+		return 0;
+	}
+
+	GpuFrameQueries& frame = frameQueries[currentFrameIndex];
+	if (frame.scopeNames.size() >= maxScopes) {
+		return UINT32_MAX;
+	}
+
+	uint32_t scope = static_cast<uint32_t>(frame.scopeNames.size());
+	frame.scopeNames.push_back(name);
+	frame.queryCount = (scope + 1) * 2;
+	vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, frame.queryPool, scope * 2);
+	return scope;
+
+}
+
+void myGpuProfiler::endScope(VkCommandBuffer commandBuffer, uint32_t scope) {
+	if (!enabled || scope == UINT32_MAX) {
+		return;
+	}
+	vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, frameQueries[currentFrameIndex].queryPool, scope * 2 + 1);
+}
+
+void myGpuProfiler::readFrameResults(GpuFrameQueries& frame) {
+
+	frame.pending = false;
+	if (frame.queryCount == 0) {
+		return;
+	}
+
+	//ÿqueryһԵֵWAITûõľͶһ֡Χ
+	std::vector<uint64_t> results(frame.queryCount * 2);
+	vkGetQueryPoolResults(logicalDevice, frame.queryPool, 0, frame.queryCount, results.size() * sizeof(uint64_t), results.data(), sizeof(uint64_t) * 2, VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+
+	for (uint32_t i = 0; i < frame.scopeNames.size(); i++) {
+		uint64_t beginTick = results[i * 4];
+		uint64_t beginAvailable = results[i * 4 + 1];
+		uint64_t endTick = results[i * 4 + 2];
+		uint64_t endAvailable = results[i * 4 + 3];
+		if (beginAvailable && endAvailable) {
+			addResult(frame.scopeNames[i], beginTick, endTick, frame.cpuRecordTime);
+		}
+	}
+
+}
+
+void myGpuProfiler::addResult(const std::string& name, uint64_t beginTick, uint64_t endTick, double cpuTime) {
+
+	//ƫҲǹģ
+	std::lock_guard<std::mutex> lock(resultMutex);
+
+	double beginTime = (beginTick & timestampMask) * timestampPeriod / 1000.0;
+	double duration = ((endTick - beginTick) & timestampMask) * timestampPeriod / 1000.0;
+
+	//GPUʱCPUʱӲһʱõһζصĽԶ뵽¼ʱCPUʱ䣬֮󱣳ƫ
+	//calibrationSourceʱȶ룬֮ǰĽʱԼ¼ʱ
+	if (!calibrated) {
+		if (calibrationSource == nullptr) {
+			gpuToCpuOffset = cpuTime - beginTime;
+			calibrated = true;
+		}
+		else if (calibrationSource->calibrated) {
+			gpuToCpuOffset = calibrationSource->gpuToCpuOffset;
+			calibrated = true;
+		}
+		else {
+			gpuToCpuOffset = cpuTime - beginTime;
+		}
+	}
+
+	scopeStats[name].addSample(duration / 1000.0);
+	if (gpuEvents.size() < MAX_TRACE_EVENTS) {
+		gpuEvents.push_back({ name, beginTime + gpuToCpuOffset, duration, threadID });
+	}
+
+}
+
+void myGpuProfiler::beginImmediateScope(VkCommandBuffer commandBuffer, const std::string& name) {
+	if (!enabled) {
+		return;
+	}
+	ImmediateScope scope;
+	{
+		std::lock_guard<std::mutex> lock(immediateMutex);
+		if (freeImmediateQueries.empty()) {
+			return;
+		}
+		scope.query = freeImmediateQueries.back();
+		freeImmediateQueries.pop_back();
+		scope.name = name;
+		scope.cpuTime = nowTime();
+		immediateScopes[commandBuffer] = scope;
+	}
+	vkCmdResetQueryPool(commandBuffer, immediateQueryPool, scope.query, 2);
+	vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, immediateQueryPool, scope.query);
+}
+
+void myGpuProfiler::endImmediateScope(VkCommandBuffer commandBuffer) {
+	if (!enabled) {
+		return;
+	}
+	uint32_t query;
+	{
+		std::lock_guard<std::mutex> lock(immediateMutex);
+		auto it = immediateScopes.find(commandBuffer);
+		if (it == immediateScopes.end()) {
+			return;
+		}
+		query = it->second.query;
+	}
+	vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, immediateQueryPool, query + 1);
+}
+
+void myGpuProfiler::resolveImmediateScope(VkCommandBuffer commandBuffer) {
+
+	if (!enabled) {
+		return;
+	}
+	ImmediateScope scope;
+	{
+		std::lock_guard<std::mutex> lock(immediateMutex);
+		auto it = immediateScopes.find(commandBuffer);
+		if (it == immediateScopes.end()) {
+			return;
+		}
+		scope = std::move(it->second);
+		immediateScopes.erase(it);
+	}
+
+	//queryֻ߳ãó
+	uint64_t results[2];
+	if (vkGetQueryPoolResults(logicalDevice, immediateQueryPool, scope.query, 2, sizeof(results), results, sizeof(uint64_t), VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT) == VK_SUCCESS) {
+		addResult(scope.name, results[0], results[1], scope.cpuTime);
+	}
+
+	std::lock_guard<std::mutex> lock(immediateMutex);
+	freeImmediateQueries.push_back(scope.query);
+
+}
+
+double myGpuProfiler::nowTime() {
+	return myProfiler::nowTime();
+}
+
+void myGpuProfiler::printStats() {
+	std::lock_guard<std::mutex> lock(resultMutex);
+	for (auto& scope : scopeStats) {
+		std::cout << trackName << " " << scope.first << ": min " << scope.second.minTime() << " ms, avg " << scope.second.avgTime() << " ms, max " << scope.second.maxTime() << " ms" << std::endl;
+	}
+}
+
+void myGpuProfiler::exportChromeTrace(const std::string& path, const std::vector<myGpuProfiler*>& others) {
+	std::vector<TraceEvent> events;
+	{
+		std::lock_guard<std::mutex> lock(resultMutex);
+		events = gpuEvents;
+	}
+	std::map<uint32_t, std::string> tracks = { { threadID, trackName } };
+	for (myGpuProfiler* other : others) {
+		std::lock_guard<std::mutex> lock(other->resultMutex);
+		events.insert(events.end(), other->gpuEvents.begin(), other->gpuEvents.end());
+		tracks[other->threadID] = other->trackName;
+	}
+	myProfiler::exportChromeTrace(path, events, tracks);
+}
+
+void myGpuProfiler::clean() {
+	for (GpuFrameQueries& frame : frameQueries) {
+		vkDestroyQueryPool(logicalDevice, frame.queryPool, nullptr);
+	}
+	if (immediateQueryPool != VK_NULL_HANDLE) {
+		vkDestroyQueryPool(logicalDevice, immediateQueryPool, nullptr);
+	}
+}
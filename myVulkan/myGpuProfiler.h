@@ -0,0 +1,108 @@
+#pragma once
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <array>
+#include <map>
+#include <unordered_map>
+#include <mutex>
+
+#include "structSet.h"
+#include "myProfiler.h"
+
+#ifndef MY_GPU_PROFILER
+#define MY_GPU_PROFILER
+
+//֡ĺʱͳmin/avg/max
+struct GpuScopeStats {
+	static const uint32_t SAMPLE_NUM = 128;
+	std::array<double, SAMPLE_NUM> samples;
+	uint32_t sampleCount = 0;
+	uint32_t nextSample = 0;
+
+	void addSample(double time);
+	double minTime();
+	double avgTime();
+	double maxTime();
+};
+
+//ÿе֡һquery poolȵ֡timelineһ֡ٶؽῨסdrawFrame
+struct GpuFrameQueries {
+	VkQueryPool queryPool = VK_NULL_HANDLE;
+	std::vector<std::string> scopeNames;
+	uint32_t queryCount = 0;
+	double cpuRecordTime = 0.0;
+	bool pending = false;
+};
+
+class myGpuProfiler {
+
+public:
+
+	static const uint32_t GPU_THREAD_ID = 1000;
+
+	VkDevice logicalDevice;
+	bool enabled = true;	//в֧ʱʱΪfalseкֱӷ
+	float timestampPeriod;	//һtick
+	uint64_t timestampMask;
+
+	std::vector<GpuFrameQueries> frameQueries;
+	uint32_t maxScopes;
+
+	//ϴ̶̺߳߳ддҪresultMutex
+	std::map<std::string, GpuScopeStats> scopeStats;
+	std::vector<TraceEvent> gpuEvents;
+
+	//ÿһprofilertraceռһ
+	uint32_t threadID = GPU_THREAD_ID;
+	std::string trackName = "GPU";
+	//ͬһ豸ϸеʱͬһʱúƫƶCPUʱ䣬ͬеܱȽǷص
+	myGpuProfiler* calibrationSource = nullptr;
+
+	myGpuProfiler(VkPhysicalDevice physicalDevice, VkDevice logicalDevice, uint32_t queueFamilyIndex, uint32_t frameSize, uint32_t maxScopes = 32);
+
+	//֡timeline֮render pass֮ãȶλϴεĽquery pool
+	void beginFrame(VkCommandBuffer commandBuffer, uint32_t frameIndex);
+	uint32_t beginScope(VkCommandBuffer commandBuffer, const std::string& name);
+	void endScope(VkCommandBuffer commandBuffer, uint32_t scope);
+
+	//һύϴݣãύѾУֱӶ
+	//߳̿ͬʱϴÿռһqueryһԼǶԣqueryʱϴʱ
+	void beginImmediateScope(VkCommandBuffer commandBuffer, const std::string& name);
+	void endImmediateScope(VkCommandBuffer commandBuffer);
+	void resolveImmediateScope(VkCommandBuffer commandBuffer);
+
+	double nowTime();	//myProfilerͬһʱᣬus
+	void printStats();
+	//GPUʱߺmyProfiler¼CPU򵼳ͬһļothersΪеprofiler
+	void exportChromeTrace(const std::string& path, const std::vector<myGpuProfiler*>& others = {});
+
+	void clean();
+
+private:
+
+	uint32_t currentFrameIndex = 0;
+	bool calibrated = false;
+	double gpuToCpuOffset = 0.0;
+
+	struct ImmediateScope {
+		uint32_t query;	//ʼqueryquery + 1
+		std::string name;
+		double cpuTime;
+	};
+	static const uint32_t MAX_IMMEDIATE_SCOPES = 16;
+	VkQueryPool immediateQueryPool = VK_NULL_HANDLE;
+	std::mutex immediateMutex;
+	std::vector<uint32_t> freeImmediateQueries;
+	std::unordered_map<VkCommandBuffer, ImmediateScope> immediateScopes;
+	std::mutex resultMutex;
+
+	void readFrameResults(GpuFrameQueries& frame);
+	void addResult(const std::string& name, uint64_t beginTick, uint64_t endTick, double cpuTime);
+
+};
+
+#endif
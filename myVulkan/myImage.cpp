@@ -14,6 +14,23 @@ myImage::myImage(std::string path, VkPhysicalDevice physicalDevice, VkDevice log
 
 }
 
+myImage::myImage(const std::vector<unsigned char>& fileData, VkPhysicalDevice physicalDevice, VkDevice logicalDevice, VkQueue queue, VkCommandPool commandPool, bool mipmapEnable) {
+
+	this->physicalDevice = physicalDevice;
+	this->logicalDevice = logicalDevice;
+
+	int texWidth, texHeight, texChannels;
+	stbi_uc* pixels = stbi_load_from_memory(fileData.data(), static_cast<int>(fileData.size()), &texWidth, &texHeight, &texChannels, STBI_rgb_alpha);
+	if (!pixels) {
+		throw std::runtime_error("failed to load texture image!");
+	}
+	createTextureImage(pixels, texWidth, texHeight, queue, commandPool, mipmapEnable);
+	stbi_image_free(pixels);
+	this->imageView = createTextureImageView(this->image, this->mipLevels);
+	this->textureSampler = createTextureSampler();
+
+}
+
 myImage::myImage(VkPhysicalDevice physicalDevice, VkDevice logicalDevice, uint32_t width, uint32_t height, uint32_t mipLevel, VkSampleCountFlagBits numSamples, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage, VkMemoryPropertyFlags properties, VkImageAspectFlags aspectFlags) {
 
 	this->physicalDevice = physicalDevice;
@@ -30,10 +47,17 @@ void myImage::createTextureImage(const char*  texturePath, VkQueue queue, VkComm
 
 	int texWidth, texHeight, texChannels;
 	stbi_uc* pixels = stbi_load(texturePath, &texWidth, &texHeight, &texChannels, STBI_rgb_alpha);
-	VkDeviceSize imageSize = texWidth * texHeight * 4;
 	if (!pixels) {
 		throw std::runtime_error("failed to load texture image!");
 	}
+	createTextureImage(pixels, texWidth, texHeight, queue, commandPool, mipmapEnable);
+	stbi_image_free(pixels);
+
+}
+
+void myImage::createTextureImage(const unsigned char* pixels, int texWidth, int texHeight, VkQueue queue, VkCommandPool commandPool, bool mipmapEnable) {
+
+	VkDeviceSize imageSize = texWidth * texHeight * 4;
 
 	//ɫвֻͬҪGPUɼԺͶ㻺һȽݴ浽ݴ滺Ŵ浽GPU
 	VkBuffer stagingBuffer;
@@ -45,8 +69,6 @@ void myImage::createTextureImage(const char*  texturePath, VkQueue queue, VkComm
 	memcpy(data, pixels, static_cast<size_t>(imageSize));
 	vkUnmapMemory(logicalDevice, stagingBufferMemory);
 
-	stbi_image_free(pixels);
-
 	this->mipLevels = mipmapEnable ? static_cast<uint32_t>(std::floor(std::log2(std::max(texWidth, texHeight)))) + 1 : 1;
 	createImage(texWidth, texHeight, this->mipLevels, VK_SAMPLE_COUNT_1_BIT, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, this->image, this->imageMemory);
 
@@ -75,11 +97,9 @@ VkImageView myImage::createTextureImageView(VkImage textureImage, uint32_t mipLe
 	return createImageView(textureImage, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_ASPECT_COLOR_BIT, mipLevels);
 }
 
+//״̬ͬһ
 VkSampler myImage::createTextureSampler() {
 
-	VkPhysicalDeviceProperties properties{};
-	vkGetPhysicalDeviceProperties(physicalDevice, &properties);
-
 	VkSamplerCreateInfo samplerInfo{};
 	samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
 	samplerInfo.magFilter = VK_FILTER_LINEAR;
@@ -88,7 +108,7 @@ VkSampler myImage::createTextureSampler() {
 	samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_REPEAT;
 	samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_REPEAT;
 	samplerInfo.anisotropyEnable = VK_TRUE;
-	samplerInfo.maxAnisotropy = properties.limits.maxSamplerAnisotropy;
+	samplerInfo.maxAnisotropy = mySamplerCache::maxAnisotropy(physicalDevice);
 	samplerInfo.borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK;
 	samplerInfo.unnormalizedCoordinates = VK_FALSE;
 	samplerInfo.compareEnable = VK_FALSE;
@@ -96,14 +116,9 @@ VkSampler myImage::createTextureSampler() {
 	samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
 	samplerInfo.mipLodBias = 0.0f;
 	samplerInfo.minLod = 0.0f;
-	samplerInfo.maxLod = static_cast<float>(this->mipLevels);
+	samplerInfo.maxLod = VK_LOD_CLAMP_NONE;	//ʱᱻضϵͼͼʵʵmipԲͬmipԹ
 
-	VkSampler textureSampler;
-	if (vkCreateSampler(logicalDevice, &samplerInfo, nullptr, &textureSampler) != VK_SUCCESS) {
-		throw std::runtime_error("failed to create texture sampler!");
-	}
-
-	return textureSampler;
+	return mySamplerCache::getSampler(logicalDevice, samplerInfo);
 
 }
 
@@ -397,11 +412,30 @@ bool myImage::hasStencilComponent(VkFormat format) {
 	return format == VK_FORMAT_D32_SFLOAT_S8_UINT || format == VK_FORMAT_D24_UNORM_S8_UINT;
 }
 
+bool myImage::isFloatDepthFormat(VkFormat format) {
+	return format == VK_FORMAT_D32_SFLOAT || format == VK_FORMAT_D32_SFLOAT_S8_UINT;
+}
+
+void myImage::retire(myDeletionQueue& deletionQueue) {
+
+	VkDevice logicalDevice = this->logicalDevice;
+	VkImageView view = imageView;
+	VkImage oldImage = image;
+	VkDeviceMemory memory = imageMemory;
+	deletionQueue.push([logicalDevice, view, oldImage, memory]() {
+		vkDestroyImageView(logicalDevice, view, nullptr);
+		vkDestroyImage(logicalDevice, oldImage, nullptr);
+		vkFreeMemory(logicalDevice, memory, nullptr);
+	});
+	textureSampler = VK_NULL_HANDLE;
+	imageView = VK_NULL_HANDLE;
+	image = VK_NULL_HANDLE;
+	imageMemory = VK_NULL_HANDLE;
+
+}
+
 void myImage::clean() {
 
-	if (textureSampler) {
-		vkDestroySampler(logicalDevice, textureSampler, nullptr);
-	}
 	vkDestroyImageView(logicalDevice, this->imageView, nullptr);
 	vkDestroyImage(logicalDevice, this->image, nullptr);
 	vkFreeMemory(logicalDevice, this->imageMemory, nullptr);
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "myBuffer.h"
+#include "mySamplerCache.h"
 
 #ifndef MY_IMAGE
 #define MY_IMAGE
@@ -14,13 +15,17 @@ public:
 	VkImage image;
 	VkImageView imageView;
 	VkDeviceMemory imageMemory;
-	VkSampler textureSampler;
+	VkSampler textureSampler = VK_NULL_HANDLE;	//mySamplerCacheͼ
 	uint32_t mipLevels = 1;
 
 	myImage(std::string path, VkPhysicalDevice physicalDevice, VkDevice logicalDevice, VkQueue queue, VkCommandPool commandPool, bool mipmapEnable);
+	//fileDataΪûͼƬļ
+	myImage(const std::vector<unsigned char>& fileData, VkPhysicalDevice physicalDevice, VkDevice logicalDevice, VkQueue queue, VkCommandPool commandPool, bool mipmapEnable);
 	myImage(VkPhysicalDevice physicalDevice, VkDevice logicalDevice, uint32_t width, uint32_t height, uint32_t mipLevel, VkSampleCountFlagBits numSamples, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage, VkMemoryPropertyFlags properties, VkImageAspectFlags aspectFlags);
 
 	void createTextureImage(const char* texturePath, VkQueue queue, VkCommandPool commandPool, bool mipmapEnable);
+	//pixelsΪRGBA8
+	void createTextureImage(const unsigned char* pixels, int texWidth, int texHeight, VkQueue queue, VkCommandPool commandPool, bool mipmapEnable);
 	VkImageView createTextureImageView(VkImage textureImage, uint32_t mipLevels);
 	VkSampler createTextureSampler();
 	
@@ -34,8 +39,11 @@ public:
 	static VkFormat findDepthFormat(VkPhysicalDevice physicalDevice);
 	static VkFormat findSupportedFormat(VkPhysicalDevice physicalDevice, const std::vector<VkFormat>& candidates, VkImageTiling tiling, VkFormatFeatureFlags features);
 	static bool hasStencilComponent(VkFormat format);
+	static bool isFloatDepthFormat(VkFormat format);
 
 	void clean();
+	//deletionQueueӳ٣ڻڷе֡ŵͼؽG-bufferʽص
+	void retire(myDeletionQueue& deletionQueue);
 
 };
 #endif
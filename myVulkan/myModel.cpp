@@ -1,8 +1,27 @@
 #include "myModel.h"
 
+//LODޣ԰ΧеĶԽ
+static const float LOD_MAX_ERROR = 0.05f;
+
 myModel::myModel(std::string path) {
 	loadModel(path);
 	optimize();
+	for (Mesh& mesh : meshs) {
+		buildLods(mesh);
+		mesh.meshlets.clear();
+		mesh.meshletVertices.clear();
+		mesh.meshletTriangles.clear();
+		for (MeshLod& lod : mesh.lods) {
+			buildMeshlets(mesh, lod);
+		}
+	}
+
+	meshBounds.resize(meshs.size());
+	for (size_t i = 0; i < meshs.size(); i++) {
+		for (const Vertex& vertex : meshs[i].vertices) {
+			meshBounds[i].grow(vertex.pos);
+		}
+	}
 }
 
 void myModel::loadModel(std::string path) {
@@ -16,20 +35,37 @@ void myModel::loadModel(std::string path) {
 	}
 
 	directory = path.substr(0, path.find_last_of('/'));
-	processNode(scene->mRootNode, scene);
+	processNode(scene->mRootNode, scene, myScene::NO_PARENT);
+
+	//ݹȵģźͬһĽڵһи
+	std::vector<uint32_t> remap = this->scene.sortByDepth();
+	for (uint32_t& node : meshNodes) {
+		node = remap[node];
+	}
+	this->scene.update();
 
 }
 
-//һnodemeshnodeҪݹ飬еmeshó
-void myModel::processNode(aiNode* node, const aiScene* scene) {
+//һnodemeshnodeҪݹ飬еmeshóͬʱ½ڵľֲ任͸ӹϵ
+void myModel::processNode(aiNode* node, const aiScene* scene, int32_t parentNode) {
+
+	aiVector3D scaling;
+	aiQuaternion rotation;
+	aiVector3D position;
+	node->mTransformation.Decompose(scaling, rotation, position);
+	uint32_t sceneNode = this->scene.addNode(node->mName.C_Str(), parentNode,
+		glm::vec3(position.x, position.y, position.z),
+		glm::quat(rotation.w, rotation.x, rotation.y, rotation.z),
+		glm::vec3(scaling.x, scaling.y, scaling.z));
 
 	for (uint32_t i = 0; i < node->mNumMeshes; i++) {
 		aiMesh* mesh = scene->mMeshes[node->mMeshes[i]];
 		this->meshs.push_back(processMesh(mesh, scene));
+		this->meshNodes.push_back(sceneNode);
 	}
 
 	for (uint32_t i = 0; i < node->mNumChildren; i++) {
-		processNode(node->mChildren[i], scene);
+		processNode(node->mChildren[i], scene, static_cast<int32_t>(sceneNode));
 	}
 
 }
@@ -39,6 +75,9 @@ Mesh myModel::processMesh(aiMesh* mesh, const aiScene* scene) {
 	std::vector<Vertex> vertices;
 	std::vector<uint32_t> indices;
 	std::vector<Texture> textures;
+	//aiProcess_Triangulate֮ÿ涼
+	vertices.reserve(mesh->mNumVertices);
+	indices.reserve(mesh->mNumFaces * 3);
 
 	for (uint32_t i = 0; i < mesh->mNumVertices; i++) {
 
@@ -94,53 +133,49 @@ Mesh myModel::processMesh(aiMesh* mesh, const aiScene* scene) {
 		
 		aiMaterial* material = scene->mMaterials[mesh->mMaterialIndex];
 
-		std::vector<Texture> diffuseMaps = loadMaterialTextures(material, aiTextureType_DIFFUSE, "texture_albedo");
+		std::vector<Texture> diffuseMaps = loadMaterialTextures(material, aiTextureType_DIFFUSE, TEXTURE_ALBEDO);
 		textures.insert(textures.end(), diffuseMaps.begin(), diffuseMaps.end());
 
-		//std::vector<Texture> specularMaps = loadMaterialTextures(material, aiTextureType_SPECULAR, "texture_specular");
+		//std::vector<Texture> specularMaps = loadMaterialTextures(material, aiTextureType_SPECULAR, TEXTURE_SPECULAR);
 		//textures.insert(textures.end(), specularMaps.begin(), specularMaps.end());
 
-		std::vector<Texture> normalMaps = loadMaterialTextures(material, aiTextureType_HEIGHT, "texture_normal");
+		std::vector<Texture> normalMaps = loadMaterialTextures(material, aiTextureType_HEIGHT, TEXTURE_NORMAL);
 		textures.insert(textures.end(), normalMaps.begin(), normalMaps.end());
 
 	}
 
-	return Mesh(vertices, indices, textures);
+	return Mesh(std::move(vertices), std::move(indices), std::move(textures));
 
 }
 
-std::vector<Texture> myModel::loadMaterialTextures(aiMaterial* mat, aiTextureType type, std::string typeName) {
+//ȥؽmyTextureRegistry·ݶϣɨѼص
+//mipmap
+std::vector<Texture> myModel::loadMaterialTextures(aiMaterial* mat, aiTextureType type, TextureType textureType) {
 
 	std::vector<Texture> textures;
 	for (unsigned int i = 0; i < mat->GetTextureCount(type); i++)
 	{
 		aiString str;
 		mat->GetTexture(type, i, &str);
-		bool skip = false;
-		for (unsigned int j = 0; j < textures_loaded.size(); j++)
-		{
-			if (std::strcmp(textures_loaded[j].path.data(), str.C_Str()) == 0)
-			{
-				textures.push_back(textures_loaded[j]);
-				skip = true;
-				break;
-			}
-		}
-		if (!skip)
-		{   // ûбأ
-			Texture texture;
-			//texture.id = TextureFromFile(str.C_Str(), directory);
-			texture.type = typeName;
-			texture.path = directory + '/' + str.C_Str();
-			textures.push_back(texture);
-			textures_loaded.push_back(texture); // ӵѼص
-		}
+		Texture texture;
+		texture.type = textureType;
+		texture.id = myTextureRegistry::acquire(directory + '/' + str.C_Str(), textureType == TEXTURE_ALBEDO);
+		textures.push_back(texture);
 	}
 
 	return textures;
 
 }
 
+void myModel::releaseTextures(myDeletionQueue* deletionQueue) {
+	for (Mesh& mesh : meshs) {
+		for (const Texture& texture : mesh.textures) {
+			myTextureRegistry::release(texture.id, deletionQueue);
+		}
+		mesh.textures.clear();
+	}
+}
+
 /*
 unsigned int myModel::TextureFromFile(const char* path, const std::string& directory, bool gamma)
 {
@@ -207,9 +242,220 @@ void myModel::optimize() {
 			}
 			uniqueIndices.push_back(uniqueVerticesMap[vertex]);
 		}
-		this->meshs[i].vertices = uniqueVertices;
-		this->meshs[i].indices = uniqueIndices;
+		this->meshs[i].vertices = std::move(uniqueVertices);
+		this->meshs[i].indices = std::move(uniqueIndices);
+
+	}
+
+}
+
+//ÿһĿ룬һż򻯣ÿζԭʼʼһ̮
+//ǲʽۼӣԭʼϽ磻򻯲ˣ类ӷͱ߽סΧжԽߵLOD_MAX_ERRORʱֹͣ
+void myModel::buildLods(Mesh& mesh) {
+
+	mesh.lods.clear();
+	uint32_t baseIndexCount = static_cast<uint32_t>(mesh.indices.size());
+	mesh.lods.push_back({ 0, baseIndexCount, 0, 0, 0.0f });
+
+	AABB bounds;
+	for (const Vertex& vertex : mesh.vertices) {
+		bounds.grow(vertex.pos);
+	}
+	if (!bounds.valid()) {
+		return;
+	}
+	float maxError = glm::length(bounds.max - bounds.min) * LOD_MAX_ERROR;
+
+	std::vector<uint32_t> lastIndices = mesh.indices;
+	for (uint32_t level = 1; level < MAX_LOD_NUM; level++) {
+
+		size_t targetIndexCount = (baseIndexCount >> level) / 3 * 3;
+		if (targetIndexCount < LOD_MIN_TRIANGLES * 3) {
+			break;
+		}
+
+		float error;
+		float lastError = mesh.lods.back().error;
+		std::vector<uint32_t> lodIndices = mySimplifier::simplify(mesh.vertices, lastIndices, targetIndexCount, maxError - lastError, error);
+		//һٲ1/4Ļֵöһ
+		if (lodIndices.empty() || lodIndices.size() * 4 > lastIndices.size() * 3) {
+			break;
+		}
+
+		MeshLod lod{};
+		lod.firstIndex = static_cast<uint32_t>(mesh.indices.size());
+		lod.indexCount = static_cast<uint32_t>(lodIndices.size());
+		lod.error = lastError + error;
+		mesh.lods.push_back(lod);
+		mesh.indices.insert(mesh.indices.end(), lodIndices.begin(), lodIndices.end());
+		lastIndices = std::move(lodIndices);
+
+	}
+
+}
+
+uint32_t myModel::selectLod(uint32_t meshIndex, float pixelsPerUnit, float maxPixelError) {
+	const std::vector<MeshLod>& lods = meshs[meshIndex].lods;
+	uint32_t level = 0;
+	while (level + 1 < lods.size() && lods[level + 1].error * pixelsPerUnit <= maxPixelError) {
+		level++;
+	}
+	return level;
+}
+
+//̰ĵǰmeshletΣѡmeshletжٵΣmeshletڿռϽգΧͷ׶С
+//Χûпѡʱԭ˳ȡһûù
+void myModel::buildMeshlets(Mesh& mesh, MeshLod& lod) {
+
+	uint32_t vertexNum = static_cast<uint32_t>(mesh.vertices.size());
+	uint32_t triangleNum = lod.indexCount / 3;
+	const uint32_t* indices = mesh.indices.data() + lod.firstIndex;
+	lod.firstMeshlet = static_cast<uint32_t>(mesh.meshlets.size());
+	lod.meshletCount = 0;
+	if (triangleNum == 0) {
+		return;
+	}
+
+	//㵽ʹεڽӱCSR
+	std::vector<uint32_t> adjacencyOffsets(vertexNum + 1, 0);
+	for (uint32_t i = 0; i < triangleNum * 3; i++) {
+		adjacencyOffsets[indices[i] + 1]++;
+	}
+	for (uint32_t v = 0; v < vertexNum; v++) {
+		adjacencyOffsets[v + 1] += adjacencyOffsets[v];
+	}
+	std::vector<uint32_t> adjacency(triangleNum * 3);
+	std::vector<uint32_t> adjacencyCursor(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+	for (uint32_t i = 0; i < triangleNum * 3; i++) {
+		adjacency[adjacencyCursor[indices[i]]++] = i / 3;
+	}
+
+	std::vector<uint8_t> emitted(triangleNum, 0);
+	std::vector<int32_t> localIndices(vertexNum, -1);	//ڵǰmeshletеľֲʱΪ-1
+	std::vector<uint32_t> sortedIndices;
+	sortedIndices.reserve(lod.indexCount);
+	mesh.meshletTriangles.reserve(mesh.meshletTriangles.size() + triangleNum);
+
+	auto newVertexNum = [&](uint32_t triangle) {
+		uint32_t num = 0;
+		for (uint32_t k = 0; k < 3; k++) {
+			num += localIndices[indices[triangle * 3 + k]] < 0 ? 1 : 0;
+		}
+		return num;
+	};
+
+	Meshlet meshlet{};
+	meshlet.firstIndex = lod.firstIndex;
+	meshlet.vertexOffset = static_cast<uint32_t>(mesh.meshletVertices.size());
+	auto finishMeshlet = [&]() {
+		computeMeshletBounds(mesh, meshlet);
+		for (uint32_t v = 0; v < meshlet.vertexCount; v++) {
+			localIndices[mesh.meshletVertices[meshlet.vertexOffset + v]] = -1;
+		}
+		mesh.meshlets.push_back(meshlet);
+		meshlet = Meshlet{};
+		meshlet.firstIndex = lod.firstIndex + static_cast<uint32_t>(sortedIndices.size());
+		meshlet.vertexOffset = static_cast<uint32_t>(mesh.meshletVertices.size());
+	};
+
+	uint32_t nextTriangle = 0;
+	for (uint32_t emittedNum = 0; emittedNum < triangleNum; emittedNum++) {
+
+		int32_t best = -1;
+		uint32_t bestNewVertexNum = 4;
+		for (uint32_t v = 0; v < meshlet.vertexCount && bestNewVertexNum > 0; v++) {
+			uint32_t vertex = mesh.meshletVertices[meshlet.vertexOffset + v];
+			for (uint32_t a = adjacencyOffsets[vertex]; a < adjacencyOffsets[vertex + 1]; a++) {
+				uint32_t triangle = adjacency[a];
+				if (emitted[triangle]) {
+					continue;
+				}
+				uint32_t num = newVertexNum(triangle);
+				if (num < bestNewVertexNum) {
+					best = static_cast<int32_t>(triangle);
+					bestNewVertexNum = num;
+				}
+			}
+		}
+		if (best < 0) {
+			while (emitted[nextTriangle]) {
+				nextTriangle++;
+			}
+			best = static_cast<int32_t>(nextTriangle);
+			bestNewVertexNum = newVertexNum(nextTriangle);
+		}
+
+		if (meshlet.vertexCount + bestNewVertexNum > Meshlet::MAX_VERTICES || meshlet.indexCount / 3 + 1 > Meshlet::MAX_TRIANGLES) {
+			finishMeshlet();
+		}
+
+		uint32_t packedTriangle = 0;
+		for (uint32_t k = 0; k < 3; k++) {
+			uint32_t vertex = indices[best * 3 + k];
+			if (localIndices[vertex] < 0) {
+				localIndices[vertex] = static_cast<int32_t>(meshlet.vertexCount++);
+				mesh.meshletVertices.push_back(vertex);
+			}
+			packedTriangle |= static_cast<uint32_t>(localIndices[vertex]) << (k * 8);
+			sortedIndices.push_back(vertex);
+		}
+		mesh.meshletTriangles.push_back(packedTriangle);
+		meshlet.indexCount += 3;
+		emitted[best] = 1;
 
 	}
+	finishMeshlet();
+	lod.meshletCount = static_cast<uint32_t>(mesh.meshlets.size()) - lod.firstMeshlet;
+
+	std::copy(sortedIndices.begin(), sortedIndices.end(), mesh.indices.begin() + lod.firstIndex);
 
-}
\ No newline at end of file
+}
+
+//Χģ׶ȡ淨ߵƽ׶ƫԶ淨߾
+void myModel::computeMeshletBounds(Mesh& mesh, Meshlet& meshlet) {
+
+	AABB bounds;
+	for (uint32_t v = 0; v < meshlet.vertexCount; v++) {
+		bounds.grow(mesh.vertices[mesh.meshletVertices[meshlet.vertexOffset + v]].pos);
+	}
+	glm::vec3 center = bounds.center();
+	float radius = 0.0f;
+	for (uint32_t v = 0; v < meshlet.vertexCount; v++) {
+		radius = std::max(radius, glm::length(mesh.vertices[mesh.meshletVertices[meshlet.vertexOffset + v]].pos - center));
+	}
+	meshlet.boundingSphere = glm::vec4(center, radius);
+
+	//ʱΪ棬gBufferߵfrontFaceһ
+	std::vector<glm::vec3> normals;
+	normals.reserve(meshlet.indexCount / 3);
+	glm::vec3 axis(0.0f);
+	for (uint32_t i = meshlet.firstIndex; i < meshlet.firstIndex + meshlet.indexCount; i += 3) {
+		//ʱindicesﻹǰ˳򣬰meshletTrianglesһض
+		uint32_t packedTriangle = mesh.meshletTriangles[i / 3];
+		glm::vec3 p[3];
+		for (uint32_t k = 0; k < 3; k++) {
+			p[k] = mesh.vertices[mesh.meshletVertices[meshlet.vertexOffset + ((packedTriangle >> (k * 8)) & 0xFF)]].pos;
+		}
+		glm::vec3 normal = glm::cross(p[1] - p[0], p[2] - p[0]);
+		float length = glm::length(normal);
+		if (length > 0.0f) {
+			normals.push_back(normal / length);
+			axis += normal / length;
+		}
+	}
+
+	float axisLength = glm::length(axis);
+	if (normals.empty() || axisLength < 1e-6f) {
+		meshlet.cone = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f);
+		return;
+	}
+	axis /= axisLength;
+	float minDot = 1.0f;
+	for (const glm::vec3& normal : normals) {
+		minDot = std::min(minDot, glm::dot(axis, normal));
+	}
+	//׶ǳ90ʱκηܿ
+	float cutoff = minDot <= 0.0f ? 1.0f : std::sqrt(1.0f - minDot * minDot);
+	meshlet.cone = glm::vec4(axis, cutoff);
+
+}
@@ -12,6 +12,10 @@
 
 #include "structSet.h"
 #include "myImage.h"
+#include "myScene.h"
+#include "myBvh.h"
+#include "mySimplifier.h"
+#include "myTextureRegistry.h"
 
 #include <iostream>
 #include <string>
@@ -34,21 +38,38 @@ class myModel {
 public:
 
 	std::vector<Mesh> meshs;
-	std::vector<Texture> textures_loaded;
+	//assimpĽڵ㼶meshNodes[i]ΪimeshڵĽڵ㣬meshĶڵľֲռ
+	myScene scene;
+	std::vector<uint32_t> meshNodes;
+	//ÿmeshİΧУmeshԼĿռ
+	std::vector<AABB> meshBounds;
 	//std::vector<std::vector<Texture>> textures_loaded;
 
+	static const uint32_t MAX_LOD_NUM = 4;
+	static const uint32_t LOD_MIN_TRIANGLES = 64;	//ĿͲ¼
+
 	myModel(std::string path);
 
+	//pixelsPerUnitΪģͿռеλͶӰĻϵͶӰ󲻳maxPixelErrorֵһ
+	uint32_t selectLod(uint32_t meshIndex, float pixelsPerUnit, float maxPixelError);
+	//ÿmeshڵʱmyTextureRegistryacquireģʱɶrelease
+	void releaseTextures(myDeletionQueue* deletionQueue);
+
 private:
 
 	std::string directory;
 
 	void loadModel(std::string path);
-	void processNode(aiNode* node, const aiScene* scene);
+	void processNode(aiNode* node, const aiScene* scene, int32_t parentNode);
 	Mesh processMesh(aiMesh* mesh, const aiScene* scene);
-	std::vector<Texture> loadMaterialTextures(aiMaterial* mat, aiTextureType type, std::string typeName);
+	std::vector<Texture> loadMaterialTextures(aiMaterial* mat, aiTextureType type, TextureType textureType);
 	//unsigned int TextureFromFile(const char* path, const std::string& directory, bool gamma = false);
 	void optimize();
+	//QEMɸLOD׷mesh.indices
+	void buildLods(Mesh& mesh);
+	//һLODгmeshletһindicesÿmeshletindices
+	void buildMeshlets(Mesh& mesh, MeshLod& lod);
+	void computeMeshletBounds(Mesh& mesh, Meshlet& meshlet);
 
 	void Draw();
 
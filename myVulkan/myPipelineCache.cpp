@@ -0,0 +1,162 @@
+#include "myPipelineCache.h"
+
+#include <fstream>
+#include <filesystem>
+
+static const uint32_t PIPELINE_CACHE_FILE_MAGIC = 0x43504B56;	//"VKPC"
+static const uint32_t PIPELINE_CACHE_FILE_VERSION = 1;
+
+myPipelineCache::myPipelineCache(VkPhysicalDevice physicalDevice, VkDevice logicalDevice, std::string cacheFilePath) {
+
+	this->cacheFilePath = cacheFilePath;
+	vkGetPhysicalDeviceProperties(physicalDevice, &deviceProperties);
+
+	//У鲻ͨ͵һյĻ
+	std::vector<char> cacheData = loadFromDisk();
+	this->loadedFromDisk = !cacheData.empty();
+
+	VkPipelineCacheCreateInfo createInfo{};
+	createInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+	createInfo.initialDataSize = cacheData.size();
+	createInfo.pInitialData = cacheData.empty() ? nullptr : cacheData.data();
+	if (vkCreatePipelineCache(logicalDevice, &createInfo, nullptr, &this->pipelineCache) != VK_SUCCESS) {
+		//ݵʧܿݣÿջһ
+		createInfo.initialDataSize = 0;
+		createInfo.pInitialData = nullptr;
+		this->loadedFromDisk = false;
+		if (vkCreatePipelineCache(logicalDevice, &createInfo, nullptr, &this->pipelineCache) != VK_SUCCESS) {
+			throw std::runtime_error("failed to create pipeline cache!");
+		}
+	}
+
+}
+
+std::vector<char> myPipelineCache::loadFromDisk() {
+
+	std::ifstream file(cacheFilePath, std::ios::binary);
+	if (!file.is_open()) {
+		return {};
+	}
+
+	PipelineCacheFileHeader fileHeader{};
+	if (!file.read(reinterpret_cast<char*>(&fileHeader), sizeof(fileHeader))) {
+		return {};
+	}
+	//ȼԼͷֹdataSizeǸ׵ֵ
+	if (fileHeader.magic != PIPELINE_CACHE_FILE_MAGIC || fileHeader.headerVersion != PIPELINE_CACHE_FILE_VERSION || fileHeader.dataSize == 0) {
+		return {};
+	}
+
+	file.seekg(0, std::ios::end);
+	uint64_t remainSize = static_cast<uint64_t>(file.tellg()) - sizeof(fileHeader);
+	if (remainSize != fileHeader.dataSize) {
+		return {};
+	}
+	file.seekg(sizeof(fileHeader));
+
+	std::vector<char> cacheData(fileHeader.dataSize);
+	if (!file.read(cacheData.data(), cacheData.size())) {
+		return {};
+	}
+
+	if (!isCompatible(fileHeader, cacheData)) {
+		std::cout << "pipeline cache " << cacheFilePath << " is stale, rebuilding" << std::endl;
+		return {};
+	}
+
+	return cacheData;
+
+}
+
+//Կ߸󣬾ɵĻ治ãҪ
+bool myPipelineCache::isCompatible(const PipelineCacheFileHeader& fileHeader, const std::vector<char>& cacheData) {
+
+	if (fileHeader.vendorID != deviceProperties.vendorID || fileHeader.deviceID != deviceProperties.deviceID || fileHeader.driverVersion != deviceProperties.driverVersion) {
+		return false;
+	}
+	if (memcmp(fileHeader.pipelineCacheUUID, deviceProperties.pipelineCacheUUID, VK_UUID_SIZE) != 0) {
+		return false;
+	}
+	if (hashData(cacheData.data(), cacheData.size()) != fileHeader.dataHash) {
+		return false;
+	}
+
+	//vulkanԼͷҲҪһ
+	if (cacheData.size() < sizeof(VkPipelineCacheHeaderVersionOne)) {
+		return false;
+	}
+	VkPipelineCacheHeaderVersionOne vkHeader;
+	memcpy(&vkHeader, cacheData.data(), sizeof(vkHeader));
+	if (vkHeader.headerSize < sizeof(VkPipelineCacheHeaderVersionOne) || vkHeader.headerVersion != VK_PIPELINE_CACHE_HEADER_VERSION_ONE) {
+		return false;
+	}
+	if (vkHeader.vendorID != deviceProperties.vendorID || vkHeader.deviceID != deviceProperties.deviceID) {
+		return false;
+	}
+	if (memcmp(vkHeader.pipelineCacheUUID, deviceProperties.pipelineCacheUUID, VK_UUID_SIZE) != 0) {
+		return false;
+	}
+
+	return true;
+
+}
+
+void myPipelineCache::saveToDisk(VkDevice logicalDevice) {
+
+	size_t dataSize = 0;
+	if (vkGetPipelineCacheData(logicalDevice, pipelineCache, &dataSize, nullptr) != VK_SUCCESS || dataSize == 0) {
+		return;
+	}
+	std::vector<char> cacheData(dataSize);
+	if (vkGetPipelineCacheData(logicalDevice, pipelineCache, &dataSize, cacheData.data()) != VK_SUCCESS) {
+		return;
+	}
+	cacheData.resize(dataSize);
+
+	PipelineCacheFileHeader fileHeader{};
+	fileHeader.magic = PIPELINE_CACHE_FILE_MAGIC;
+	fileHeader.headerVersion = PIPELINE_CACHE_FILE_VERSION;
+	fileHeader.vendorID = deviceProperties.vendorID;
+	fileHeader.deviceID = deviceProperties.deviceID;
+	fileHeader.driverVersion = deviceProperties.driverVersion;
+	memcpy(fileHeader.pipelineCacheUUID, deviceProperties.pipelineCacheUUID, VK_UUID_SIZE);
+	fileHeader.dataSize = cacheData.size();
+	fileHeader.dataHash = hashData(cacheData.data(), cacheData.size());
+
+	//дʱļٸֹдһ°ļ
+	std::string tempPath = cacheFilePath + ".tmp";
+	{
+		std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+		if (!file.is_open()) {
+			std::cerr << "failed to write pipeline cache " << tempPath << std::endl;
+			return;
+		}
+		file.write(reinterpret_cast<const char*>(&fileHeader), sizeof(fileHeader));
+		file.write(cacheData.data(), cacheData.size());
+		if (!file) {
+			std::cerr << "failed to write pipeline cache " << tempPath << std::endl;
+			return;
+		}
+	}
+
+	std::error_code ec;
+	std::filesystem::rename(tempPath, cacheFilePath, ec);
+	if (ec) {
+		std::cerr << "failed to write pipeline cache " << cacheFilePath << ": " << ec.message() << std::endl;
+	}
+
+}
+
+//FNV-1aֻļ
+uint64_t myPipelineCache::hashData(const char* data, size_t size) {
+	uint64_t hash = 14695981039346656037ull;
+	for (size_t i = 0; i < size; i++) {
+		hash ^= static_cast<uint8_t>(data[i]);
+		hash *= 1099511628211ull;
+	}
+	return hash;
+}
+
+void myPipelineCache::clean(VkDevice logicalDevice) {
+	vkDestroyPipelineCache(logicalDevice, pipelineCache, nullptr);
+}
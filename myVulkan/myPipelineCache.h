@@ -0,0 +1,50 @@
+#pragma once
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include <iostream>
+#include <vector>
+#include <string>
+
+#include "structSet.h"
+
+#ifndef MY_PIPELINE_CACHE
+#define MY_PIPELINE_CACHE
+
+//дڴļǰͷvulkanԼͷûdriverVersion𻵵ĻݲһᱨԼټһУ
+struct PipelineCacheFileHeader {
+	uint32_t magic;
+	uint32_t headerVersion;
+	uint32_t vendorID;
+	uint32_t deviceID;
+	uint32_t driverVersion;
+	uint8_t pipelineCacheUUID[VK_UUID_SIZE];
+	uint64_t dataSize;
+	uint64_t dataHash;
+};
+
+class myPipelineCache {
+
+public:
+
+	VkPipelineCache pipelineCache;
+	std::string cacheFilePath;
+	bool loadedFromDisk = false;	//Ϊtrue˵߿ֱӴӻеõ
+
+	myPipelineCache(VkPhysicalDevice physicalDevice, VkDevice logicalDevice, std::string cacheFilePath);
+
+	void saveToDisk(VkDevice logicalDevice);
+	void clean(VkDevice logicalDevice);
+
+	static uint64_t hashData(const char* data, size_t size);
+
+private:
+
+	VkPhysicalDeviceProperties deviceProperties;
+
+	std::vector<char> loadFromDisk();
+	bool isCompatible(const PipelineCacheFileHeader& fileHeader, const std::vector<char>& cacheData);
+
+};
+
+#endif
@@ -0,0 +1,357 @@
+#include "myPipelineManager.h"
+#include "myProfiler.h"
+
+myPipelineManager::myPipelineManager(VkDevice logicalDevice, VkPipelineCache pipelineCache, myShaderCache* shaderCache, myDeletionQueue* deletionQueue, uint32_t threadNum) {
+	this->logicalDevice = logicalDevice;
+	this->pipelineCache = pipelineCache;
+	this->shaderCache = shaderCache;
+	this->deletionQueue = deletionQueue;
+	this->threadPool = std::make_unique<myThreadPool>(threadNum);
+}
+
+uint32_t myPipelineManager::addGraphicsPipeline(std::string name, GraphicsPipelineDesc desc) {
+	std::unique_ptr<PipelineEntry> entry = std::make_unique<PipelineEntry>();
+	entry->name = name;
+	entry->desc = std::move(desc);
+	return addEntry(std::move(entry));
+}
+
+uint32_t myPipelineManager::addComputePipeline(std::string name, ComputePipelineDesc desc) {
+	std::unique_ptr<PipelineEntry> entry = std::make_unique<PipelineEntry>();
+	entry->name = name;
+	entry->isCompute = true;
+	entry->computeDesc = std::move(desc);
+	return addEntry(std::move(entry));
+}
+
+uint32_t myPipelineManager::addEntry(std::unique_ptr<PipelineEntry> entry) {
+
+	PipelineEntry* entryPtr = entry.get();
+	uint32_t index;
+	{
+		std::lock_guard<std::mutex> lock(entryMutex);
+		index = static_cast<uint32_t>(pipelines.size());
+		pipelines.push_back(std::move(entry));
+	}
+
+	submitCompile(entryPtr, false);
+
+	return index;
+
+}
+
+void myPipelineManager::submitCompile(PipelineEntry* entry, bool rebuild) {
+	std::chrono::high_resolution_clock::time_point submitTime = std::chrono::high_resolution_clock::now();
+	uint32_t generation = entry->generation.fetch_add(1, std::memory_order_acq_rel) + 1;
+	threadPool->submit([this, entry, rebuild, submitTime, generation]() { compilePipeline(entry, rebuild, submitTime, generation); });
+}
+
+VkPipeline myPipelineManager::getPipeline(uint32_t index) {
+	PipelineEntry* entry = pipelines[index].get();
+	//߳ﲻ쳣̣߳߳ȡߵʱ
+	if (entry->failed.load(std::memory_order_acquire)) {
+		std::lock_guard<std::mutex> lock(logMutex);
+		throw std::runtime_error("failed to create graphics pipeline " + entry->name + ": " + entry->errorMessage);
+	}
+	return entry->pipeline.load(std::memory_order_acquire);
+}
+
+bool myPipelineManager::isFailed(uint32_t index) {
+	return pipelines[index]->failed.load(std::memory_order_acquire);
+}
+
+bool myPipelineManager::allReady() {
+	for (auto& entry : pipelines) {
+		if (entry->pipeline.load(std::memory_order_acquire) == VK_NULL_HANDLE) {
+			return false;
+		}
+	}
+	return true;
+}
+
+void myPipelineManager::waitAll() {
+	threadPool->waitIdle();
+}
+
+void myPipelineManager::rebuildPipelinesUsing(const std::string& shaderName) {
+
+	if (!shaderCache->reload(shaderName)) {
+		std::cerr << "shader " << shaderName << " is not valid SPIR-V yet, keep the old one" << std::endl;
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock(entryMutex);
+	for (auto& entry : pipelines) {
+		bool used = entry->isCompute ? entry->computeDesc.compShader == shaderName : (entry->desc.vertShader == shaderName || entry->desc.fragShader == shaderName || entry->desc.taskShader == shaderName || entry->desc.meshShader == shaderName);
+		if (used) {
+			submitCompile(entry.get(), true);
+		}
+	}
+
+}
+
+//rebuildΪtrueʱأʧֻӡ󣬼þɹ
+void myPipelineManager::compilePipeline(PipelineEntry* entry, bool rebuild, std::chrono::high_resolution_clock::time_point submitTime, uint32_t generation) {
+	if (entry->isCompute) {
+		compileComputePipeline(entry, rebuild, submitTime, generation);
+	}
+	else {
+		compileGraphicsPipeline(entry, rebuild, submitTime, generation);
+	}
+}
+
+void myPipelineManager::compileGraphicsPipeline(PipelineEntry* entry, bool rebuild, std::chrono::high_resolution_clock::time_point submitTime, uint32_t generation) {
+
+	MY_PROFILE_FUNCTION();
+	auto startTime = std::chrono::high_resolution_clock::now();
+	double queueLatency = std::chrono::duration<double, std::milli>(startTime - submitTime).count();
+
+	const GraphicsPipelineDesc& desc = entry->desc;
+
+	//mesh shadertaskmesh涥ɫ
+	bool meshPipeline = !desc.meshShader.empty();
+	std::vector<std::pair<VkShaderStageFlagBits, std::shared_ptr<ShaderModule>>> shaderModules;
+	try {
+		if (meshPipeline) {
+			if (!desc.taskShader.empty()) {
+				shaderModules.push_back({ VK_SHADER_STAGE_TASK_BIT_EXT, shaderCache->getShaderModule(desc.taskShader) });
+			}
+			shaderModules.push_back({ VK_SHADER_STAGE_MESH_BIT_EXT, shaderCache->getShaderModule(desc.meshShader) });
+		}
+		else {
+			shaderModules.push_back({ VK_SHADER_STAGE_VERTEX_BIT, shaderCache->getShaderModule(desc.vertShader) });
+		}
+		if (!desc.fragShader.empty()) {
+			shaderModules.push_back({ VK_SHADER_STAGE_FRAGMENT_BIT, shaderCache->getShaderModule(desc.fragShader) });
+		}
+	}
+	catch (const std::exception& e) {
+		if (rebuild) {
+			std::lock_guard<std::mutex> lock(logMutex);
+			std::cerr << "failed to rebuild pipeline " << entry->name << ": " << e.what() << std::endl;
+			return;
+		}
+		markFailed(entry, e.what());
+		return;
+	}
+
+	std::vector<VkPipelineShaderStageCreateInfo> shaderStages(shaderModules.size());
+	for (size_t i = 0; i < shaderModules.size(); i++) {
+		shaderStages[i].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+		shaderStages[i].stage = shaderModules[i].first;
+		shaderStages[i].module = shaderModules[i].second->module;
+		shaderStages[i].pName = "main";
+	}
+
+	std::vector<VkSpecializationMapEntry> fragSpecEntries(desc.fragSpecConstants.size());
+	for (uint32_t i = 0; i < fragSpecEntries.size(); i++) {
+		fragSpecEntries[i].constantID = i;
+		fragSpecEntries[i].offset = i * sizeof(uint32_t);
+		fragSpecEntries[i].size = sizeof(uint32_t);
+	}
+	VkSpecializationInfo fragSpecInfo{};
+	fragSpecInfo.mapEntryCount = static_cast<uint32_t>(fragSpecEntries.size());
+	fragSpecInfo.pMapEntries = fragSpecEntries.data();
+	fragSpecInfo.dataSize = desc.fragSpecConstants.size() * sizeof(uint32_t);
+	fragSpecInfo.pData = desc.fragSpecConstants.data();
+	if (!fragSpecEntries.empty() && !desc.fragShader.empty()) {
+		shaderStages.back().pSpecializationInfo = &fragSpecInfo;	//ƬԪɫ
+	}
+
+	VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
+	vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+	vertexInputInfo.vertexBindingDescriptionCount = static_cast<uint32_t>(desc.vertexBindings.size());
+	vertexInputInfo.pVertexBindingDescriptions = desc.vertexBindings.data();
+	vertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(desc.vertexAttributes.size());
+	vertexInputInfo.pVertexAttributeDescriptions = desc.vertexAttributes.data();
+
+	VkPipelineInputAssemblyStateCreateInfo inputAssembly{};
+	inputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+	inputAssembly.topology = desc.topology;
+	inputAssembly.primitiveRestartEnable = VK_FALSE;
+
+	//ӿںͲüǶ̬״̬
+	VkPipelineViewportStateCreateInfo viewportState{};
+	viewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+	viewportState.viewportCount = 1;
+	viewportState.scissorCount = 1;
+
+	VkPipelineRasterizationStateCreateInfo rasterizer{};
+	rasterizer.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+	rasterizer.depthClampEnable = VK_FALSE;
+	rasterizer.rasterizerDiscardEnable = VK_FALSE;
+	rasterizer.polygonMode = VK_POLYGON_MODE_FILL;
+	rasterizer.lineWidth = 1.0f;
+	rasterizer.cullMode = desc.cullMode;
+	rasterizer.frontFace = desc.frontFace;
+	rasterizer.depthBiasEnable = VK_FALSE;
+
+	VkPipelineMultisampleStateCreateInfo multisampling{};
+	multisampling.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+	multisampling.sampleShadingEnable = VK_FALSE;
+	multisampling.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+	multisampling.minSampleShading = 1.0f;
+
+	//ÿһҪһɫ״̬
+	std::vector<VkPipelineColorBlendAttachmentState> blendAttachmentStates(desc.colorAttachmentCount);
+	for (uint32_t i = 0; i < desc.colorAttachmentCount; i++) {
+		VkPipelineColorBlendAttachmentState colorBlendAttachment{};
+		colorBlendAttachment.colorWriteMask = desc.colorWriteMask;
+		colorBlendAttachment.blendEnable = VK_FALSE;
+		colorBlendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_ONE;
+		colorBlendAttachment.colorBlendOp = VK_BLEND_OP_ADD;
+		colorBlendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+		colorBlendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
+		colorBlendAttachment.alphaBlendOp = VK_BLEND_OP_ADD;
+		blendAttachmentStates[i] = colorBlendAttachment;
+	}
+	VkPipelineColorBlendStateCreateInfo colorBlending{};
+	colorBlending.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+	colorBlending.logicOpEnable = VK_FALSE;
+	colorBlending.logicOp = VK_LOGIC_OP_COPY;
+	colorBlending.attachmentCount = desc.colorAttachmentCount;
+	colorBlending.pAttachments = blendAttachmentStates.data();
+
+	VkPipelineDepthStencilStateCreateInfo depthStencil{};
+	depthStencil.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+	depthStencil.depthTestEnable = desc.depthTestEnable;
+	depthStencil.depthWriteEnable = desc.depthWriteEnable;
+	depthStencil.depthCompareOp = desc.depthCompareOp;
+	depthStencil.depthBoundsTestEnable = VK_FALSE;
+	depthStencil.minDepthBounds = 0.0f;
+	depthStencil.maxDepthBounds = 1.0f;
+	depthStencil.stencilTestEnable = VK_FALSE;
+
+	std::array<VkDynamicState, 2> dynamicStates = {
+		VK_DYNAMIC_STATE_VIEWPORT,
+		VK_DYNAMIC_STATE_SCISSOR
+	};
+	VkPipelineDynamicStateCreateInfo dynamicState{};
+	dynamicState.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+	dynamicState.dynamicStateCount = static_cast<uint32_t>(dynamicStates.size());
+	dynamicState.pDynamicStates = dynamicStates.data();
+
+	VkGraphicsPipelineCreateInfo pipelineInfo{};
+	pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+	pipelineInfo.stageCount = static_cast<uint32_t>(shaderStages.size());
+	pipelineInfo.pStages = shaderStages.data();
+	//mesh shaderûжͼԪװ׶
+	pipelineInfo.pVertexInputState = meshPipeline ? nullptr : &vertexInputInfo;
+	pipelineInfo.pInputAssemblyState = meshPipeline ? nullptr : &inputAssembly;
+	pipelineInfo.pViewportState = &viewportState;
+	pipelineInfo.pRasterizationState = &rasterizer;
+	pipelineInfo.pMultisampleState = &multisampling;
+	pipelineInfo.pDepthStencilState = &depthStencil;
+	pipelineInfo.pColorBlendState = &colorBlending;
+	pipelineInfo.pDynamicState = &dynamicState;
+	pipelineInfo.layout = desc.layout;
+	pipelineInfo.renderPass = desc.renderPass;
+	pipelineInfo.subpass = desc.subpass;
+	pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
+	pipelineInfo.basePipelineIndex = -1;
+
+	VkPipeline pipeline = VK_NULL_HANDLE;
+	VkResult result = vkCreateGraphicsPipelines(logicalDevice, pipelineCache, 1, &pipelineInfo, nullptr, &pipeline);
+
+	double compileTime = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - startTime).count();
+	publishPipeline(entry, rebuild, generation, result, pipeline, queueLatency, compileTime);
+
+}
+
+void myPipelineManager::compileComputePipeline(PipelineEntry* entry, bool rebuild, std::chrono::high_resolution_clock::time_point submitTime, uint32_t generation) {
+
+	MY_PROFILE_FUNCTION();
+	auto startTime = std::chrono::high_resolution_clock::now();
+	double queueLatency = std::chrono::duration<double, std::milli>(startTime - submitTime).count();
+
+	const ComputePipelineDesc& desc = entry->computeDesc;
+
+	std::shared_ptr<ShaderModule> compShaderModule;
+	try {
+		compShaderModule = shaderCache->getShaderModule(desc.compShader);
+	}
+	catch (const std::exception& e) {
+		if (rebuild) {
+			std::lock_guard<std::mutex> lock(logMutex);
+			std::cerr << "failed to rebuild pipeline " << entry->name << ": " << e.what() << std::endl;
+			return;
+		}
+		markFailed(entry, e.what());
+		return;
+	}
+
+	VkComputePipelineCreateInfo pipelineInfo{};
+	pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+	pipelineInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+	pipelineInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+	pipelineInfo.stage.module = compShaderModule->module;
+	pipelineInfo.stage.pName = "main";
+	pipelineInfo.layout = desc.layout;
+	pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
+	pipelineInfo.basePipelineIndex = -1;
+
+	VkPipeline pipeline = VK_NULL_HANDLE;
+	VkResult result = vkCreateComputePipelines(logicalDevice, pipelineCache, 1, &pipelineInfo, nullptr, &pipeline);
+
+	double compileTime = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - startTime).count();
+	publishPipeline(entry, rebuild, generation, result, pipeline, queueLatency, compileTime);
+
+}
+
+void myPipelineManager::markFailed(PipelineEntry* entry, const std::string& errorMessage) {
+	std::lock_guard<std::mutex> lock(logMutex);
+	entry->errorMessage = errorMessage;
+	entry->failed.store(true, std::memory_order_release);
+}
+
+void myPipelineManager::publishPipeline(PipelineEntry* entry, bool rebuild, uint32_t generation, VkResult result, VkPipeline pipeline, double queueLatency, double compileTime) {
+
+	const char* createFunction = entry->isCompute ? "vkCreateComputePipelines" : "vkCreateGraphicsPipelines";
+	//滻߶ͬʱʱҲþɵǸ滻
+	std::lock_guard<std::mutex> lock(logMutex);
+	if (entry->generation.load(std::memory_order_acquire) != generation) {
+		//¹߻ûȥֱ
+		if (pipeline != VK_NULL_HANDLE) {
+			vkDestroyPipeline(logicalDevice, pipeline, nullptr);
+		}
+		std::cout << "pipeline " << entry->name << " superseded by a newer compile, result dropped" << std::endl;
+		return;
+	}
+	if (result != VK_SUCCESS) {
+		if (rebuild) {
+			std::cerr << "failed to rebuild pipeline " << entry->name << ": " << createFunction << " returned " << result << std::endl;
+			return;
+		}
+		entry->errorMessage = std::string(createFunction) + " returned " + std::to_string(result);
+		entry->failed.store(true, std::memory_order_release);
+		return;
+	}
+
+	//֮ǰʧܹĹسɹˣgetPipelineisFailedٱʧ
+	entry->errorMessage.clear();
+	entry->failed.store(false, std::memory_order_release);
+	entry->queueLatency = queueLatency;
+	entry->compileTime = compileTime;
+	VkPipeline oldPipeline = entry->pipeline.exchange(pipeline, std::memory_order_acq_rel);
+	if (oldPipeline != VK_NULL_HANDLE) {
+		VkDevice logicalDevice = this->logicalDevice;
+		deletionQueue->push([logicalDevice, oldPipeline]() { vkDestroyPipeline(logicalDevice, oldPipeline, nullptr); });
+	}
+
+	std::cout << "pipeline " << entry->name << (rebuild ? " rebuilt" : " ready") << ": queued " << queueLatency << " ms, compiled " << compileTime << " ms" << std::endl;
+
+}
+
+void myPipelineManager::clean() {
+
+	//豸ǰȺ̨ı
+	threadPool->waitIdle();
+	for (auto& entry : pipelines) {
+		VkPipeline pipeline = entry->pipeline.load();
+		if (pipeline != VK_NULL_HANDLE) {
+			vkDestroyPipeline(logicalDevice, pipeline, nullptr);
+		}
+	}
+	pipelines.clear();
+
+}
@@ -0,0 +1,127 @@
+#pragma once
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <chrono>
+
+#include "structSet.h"
+#include "myThreadPool.h"
+#include "myShaderCache.h"
+#include "myDeletionQueue.h"
+
+#ifndef MY_PIPELINE_MANAGER
+#define MY_PIPELINE_MANAGER
+
+//߳ϴʱcreateGraphicsPipelineջϵcreate infoûˣݶҪԼ
+struct GraphicsPipelineDesc {
+
+	//ɫĿ¼µļģmyShaderCacheȡʱҵӰĹ
+	std::string vertShader;
+	std::string fragShader;	//ΪʱֻдȣԤͨ
+	//ƬԪɫػiֵconstant_id = igBufferFragĳ
+	std::vector<uint32_t> fragSpecConstants;
+	//meshShaderΪʱmesh shaderߣvertShaderͶ룻taskShaderΪ
+	std::string taskShader;
+	std::string meshShader;
+
+	std::vector<VkVertexInputBindingDescription> vertexBindings;
+	std::vector<VkVertexInputAttributeDescription> vertexAttributes;
+	VkPrimitiveTopology topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+
+	VkCullModeFlags cullMode = VK_CULL_MODE_BACK_BIT;
+	VkFrontFace frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+
+	VkBool32 depthTestEnable = VK_TRUE;
+	VkBool32 depthWriteEnable = VK_TRUE;
+	VkCompareOp depthCompareOp = VK_COMPARE_OP_LESS;
+
+	//subpassɫֻдȵĹҲҪÿһ״̬colorWriteMaskΪ0
+	uint32_t colorAttachmentCount = 1;
+	VkColorComponentFlags colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+
+	VkPipelineLayout layout = VK_NULL_HANDLE;
+	VkRenderPass renderPass = VK_NULL_HANDLE;
+	uint32_t subpass = 0;
+
+};
+
+//ֻҪһɫͲ
+struct ComputePipelineDesc {
+	std::string compShader;
+	VkPipelineLayout layout = VK_NULL_HANDLE;
+};
+
+struct PipelineEntry {
+
+	std::string name;
+	bool isCompute = false;
+	GraphicsPipelineDesc desc;
+	ComputePipelineDesc computeDesc;
+
+	std::atomic<VkPipeline> pipeline{ VK_NULL_HANDLE };
+	//رɹĺɫָܻerrorMessagelogMutexд
+	std::atomic<bool> failed{ false };
+	std::string errorMessage;
+
+	//ÿύһʱύʱֵ˵ѾиµıˣֱӶ
+	//ɫʱύıܺɣĻɹ߻Ḳ¹
+	std::atomic<uint32_t> generation{ 0 };
+	double queueLatency = 0.0;	//ύʼĵȴʱ䣬ms
+	double compileTime = 0.0;	//vkCreateGraphicsPipelinesʱ䣬ms
+
+};
+
+class myPipelineManager {
+
+public:
+
+	VkDevice logicalDevice;
+	VkPipelineCache pipelineCache;	//vulkanĹ߻汾̰߳ȫģ߳̿Թ
+	myShaderCache* shaderCache;
+	myDeletionQueue* deletionQueue;	//滻Ĺ߿ܻڷе֡ţŽȥЩ֡
+
+	std::vector<std::unique_ptr<PipelineEntry>> pipelines;
+
+	myPipelineManager(VkDevice logicalDevice, VkPipelineCache pipelineCache, myShaderCache* shaderCache, myDeletionQueue* deletionQueue, uint32_t threadNum = 0);
+
+	//عߵ߻ں̨߳б
+	uint32_t addGraphicsPipeline(std::string name, GraphicsPipelineDesc desc);
+	uint32_t addComputePipeline(std::string name, ComputePipelineDesc desc);
+	//û÷VK_NULL_HANDLEλƼ
+	VkPipeline getPipeline(uint32_t index);
+	//ѡĹߣGPU޳ʧʱ쳣Լ˻ص·
+	bool isFailed(uint32_t index);
+	bool allReady();
+	void waitAll();
+
+	//ɫļ仯ں̨±õĹߣú滻ɹ
+	void rebuildPipelinesUsing(const std::string& shaderName);
+
+	void clean();
+
+private:
+
+	std::unique_ptr<myThreadPool> threadPool;
+	std::mutex entryMutex;
+	std::mutex logMutex;
+
+	uint32_t addEntry(std::unique_ptr<PipelineEntry> entry);
+	//ύʱʹֵ񣬲ڹentryϣڱύдֵ
+	void submitCompile(PipelineEntry* entry, bool rebuild);
+	void compilePipeline(PipelineEntry* entry, bool rebuild, std::chrono::high_resolution_clock::time_point submitTime, uint32_t generation);
+	void compileGraphicsPipeline(PipelineEntry* entry, bool rebuild, std::chrono::high_resolution_clock::time_point submitTime, uint32_t generation);
+	void compileComputePipeline(PipelineEntry* entry, bool rebuild, std::chrono::high_resolution_clock::time_point submitTime, uint32_t generation);
+	//һαʧʱ´getPipeline׸߳
+	void markFailed(PipelineEntry* entry, const std::string& errorMessage);
+	//ɺ滻ɹ߲ʧ״̬ʧʱ¼generationѾʱĻεĽ
+	void publishPipeline(PipelineEntry* entry, bool rebuild, uint32_t generation, VkResult result, VkPipeline pipeline, double queueLatency, double compileTime);
+
+};
+
+#endif
@@ -0,0 +1,96 @@
+#include "myPresentMonitor.h"
+
+myPresentMonitor::myPresentMonitor(VkDevice logicalDevice) {
+
+	this->logicalDevice = logicalDevice;
+	this->waitForPresent = (PFN_vkWaitForPresentKHR)vkGetDeviceProcAddr(logicalDevice, "vkWaitForPresentKHR");
+	if (waitForPresent == nullptr) {
+		throw std::runtime_error("failed to load vkWaitForPresentKHR!");
+	}
+
+	running = true;
+	monitorThread = std::thread(&myPresentMonitor::monitorLoop, this);
+
+}
+
+myPresentMonitor::~myPresentMonitor() {
+	stop();
+}
+
+void myPresentMonitor::setSwapChain(VkSwapchainKHR swapChain) {
+	std::lock_guard<std::mutex> lock(pendingMutex);
+	this->swapChain = swapChain;
+	pendingPresents.clear();
+}
+
+void myPresentMonitor::releaseSwapChain(VkSwapchainKHR swapChain) {
+	std::unique_lock<std::mutex> lock(pendingMutex);
+	waitDoneCondition.wait(lock, [this, swapChain] { return waitingSwapChain != swapChain; });
+}
+
+void myPresentMonitor::addPresent(uint64_t presentID, std::chrono::steady_clock::time_point inputTime) {
+	{
+		std::lock_guard<std::mutex> lock(pendingMutex);
+		pendingPresents.push_back({ presentID, inputTime });
+	}
+	pendingCondition.notify_one();
+}
+
+std::vector<double> myPresentMonitor::collectLatencies() {
+	std::lock_guard<std::mutex> lock(pendingMutex);
+	std::vector<double> result;
+	result.swap(latencies);
+	return result;
+}
+
+void myPresentMonitor::monitorLoop() {
+
+	while (running) {
+
+		PendingPresent present;
+		VkSwapchainKHR targetSwapChain;
+		{
+			std::unique_lock<std::mutex> lock(pendingMutex);
+			pendingCondition.wait(lock, [this] { return !running || !pendingPresents.empty(); });
+			if (!running) {
+				return;
+			}
+			present = pendingPresents.front();
+			targetSwapChain = swapChain;
+			waitingSwapChain = targetSwapChain;
+		}
+
+		//ȴǿreleaseSwapChain֤֮ǰ
+		VkResult result = waitForPresent(logicalDevice, targetSwapChain, present.presentID, WAIT_TIMEOUT);
+		auto now = std::chrono::steady_clock::now();
+
+		std::lock_guard<std::mutex> lock(pendingMutex);
+		waitingSwapChain = VK_NULL_HANDLE;
+		waitDoneCondition.notify_all();
+		if (result == VK_TIMEOUT) {
+			continue;
+		}
+		//ڵȴڼ䱻Ļһ֡Ѿ
+		if (swapChain == targetSwapChain && !pendingPresents.empty() && pendingPresents.front().presentID == present.presentID) {
+			pendingPresents.pop_front();
+			//ڻ߱涪ʧʱ㣬ؽ֡
+			if (result == VK_SUCCESS || result == VK_SUBOPTIMAL_KHR) {
+				latencies.push_back(std::chrono::duration<double, std::milli>(now - present.inputTime).count());
+			}
+		}
+
+	}
+
+}
+
+void myPresentMonitor::stop() {
+	if (!monitorThread.joinable()) {
+		return;
+	}
+	{
+		std::lock_guard<std::mutex> lock(pendingMutex);
+		running = false;
+	}
+	pendingCondition.notify_all();
+	monitorThread.join();
+}
@@ -0,0 +1,69 @@
+#pragma once
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include <iostream>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+
+#include "structSet.h"
+
+#ifndef MY_PRESENT_MONITOR
+#define MY_PRESENT_MONITOR
+
+struct PendingPresent {
+	uint64_t presentID;
+	std::chrono::steady_clock::time_point inputTime;
+};
+
+//VK_KHR_present_waitں̵̨߳ÿһ֡ʾ뵽ʾӳ
+//̨߳̿һݽصȣ̵߳acquirepresentؽᱻס
+//ɽǰҪreleaseSwapChain̨֤߳Ѿ
+class myPresentMonitor {
+
+public:
+
+	//ÿεȴĳʱʱһǷҪֹͣٽŵ
+	static const uint64_t WAIT_TIMEOUT = 100000000;	//ns
+
+	myPresentMonitor(VkDevice logicalDevice);
+	~myPresentMonitor();
+
+	//ؽãɽϻûȵֱ֡Ӷ
+	void setSwapChain(VkSwapchainKHR swapChain);
+	//̨̲߳ٵӳvkDestroySwapchainKHR֮ǰ
+	void releaseSwapChain(VkSwapchainKHR swapChain);
+	//vkQueuePresentKHRɹ
+	void addPresent(uint64_t presentID, std::chrono::steady_clock::time_point inputTime);
+	//ȡϴε⵽ӳ٣ms
+	std::vector<double> collectLatencies();
+
+	void stop();
+
+private:
+
+	VkDevice logicalDevice;
+	PFN_vkWaitForPresentKHR waitForPresent;
+
+	std::thread monitorThread;
+	std::atomic<bool> running{ false };
+
+	//ĶpendingMutex
+	std::mutex pendingMutex;
+	std::condition_variable pendingCondition;
+	std::condition_variable waitDoneCondition;
+	VkSwapchainKHR swapChain = VK_NULL_HANDLE;
+	VkSwapchainKHR waitingSwapChain = VK_NULL_HANDLE;	//̨߳ڵȵĽûڵʱΪ
+	std::deque<PendingPresent> pendingPresents;
+	std::vector<double> latencies;
+
+	void monitorLoop();
+
+};
+
+#endif
@@ -0,0 +1,205 @@
+#include "myProfiler.h"
+
+#include <fstream>
+#include <algorithm>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+#ifdef MY_PROFILER_USE_RDTSC
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#endif
+
+std::mutex myProfiler::registryMutex;
+std::vector<std::shared_ptr<ThreadProfileBuffer>> myProfiler::buffers;
+
+static const std::chrono::steady_clock::time_point programStartTime = std::chrono::steady_clock::now();
+#ifdef MY_PROFILER_USE_RDTSC
+static const uint64_t programStartTick = __rdtsc();
+#endif
+
+uint64_t myProfiler::nowTick() {
+#ifdef MY_PROFILER_USE_RDTSC
+	return __rdtsc();
+#else
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - programStartTime).count();
+#endif
+}
+
+double myProfiler::nowTime() {
+	return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - programStartTime).count();
+}
+
+double myProfiler::tickToTime(uint64_t tick) {
+#ifdef MY_PROFILER_USE_RDTSC
+	//óһ궨TSCƵʣʱã㹻
+	double ticksPerUs = (__rdtsc() - programStartTick) / std::max(nowTime(), 1.0);
+	return (tick - programStartTick) / ticksPerUs;
+#else
+	return tick / 1000.0;
+#endif
+}
+
+ThreadProfileBuffer& myProfiler::threadBuffer() {
+
+	//̵ֻ߳һμ¼ʱŻעᣬ֮Ƿthread_local
+	thread_local std::shared_ptr<ThreadProfileBuffer> buffer;
+	if (!buffer) {
+		buffer = std::make_shared<ThreadProfileBuffer>();
+		buffer->zones.resize(ThreadProfileBuffer::CAPACITY);
+		std::lock_guard<std::mutex> lock(registryMutex);
+		buffer->threadID = static_cast<uint32_t>(buffers.size()) + 1;
+		buffer->threadName = "thread " + std::to_string(buffer->threadID);
+		buffers.push_back(buffer);
+	}
+	return *buffer;
+
+}
+
+void myProfiler::setThreadName(const std::string& name) {
+	ThreadProfileBuffer& buffer = threadBuffer();
+	std::lock_guard<std::mutex> lock(registryMutex);
+	buffer.threadName = name;
+}
+
+void myProfiler::recordZone(ThreadProfileBuffer& buffer, const char* name, uint64_t startTick, uint64_t endTick, uint32_t depth) {
+	uint64_t index = buffer.zoneCount.load(std::memory_order_relaxed);
+	buffer.zones[index % ThreadProfileBuffer::CAPACITY] = { name, startTick, endTick, depth };
+	buffer.zoneCount.store(index + 1, std::memory_order_release);
+}
+
+std::vector<TraceEvent> myProfiler::collectEvents() {
+
+	std::lock_guard<std::mutex> lock(registryMutex);
+	std::vector<TraceEvent> events;
+	for (std::shared_ptr<ThreadProfileBuffer>& buffer : buffers) {
+		uint64_t zoneCount = buffer->zoneCount.load(std::memory_order_acquire);
+		uint64_t first = zoneCount > ThreadProfileBuffer::CAPACITY ? zoneCount - ThreadProfileBuffer::CAPACITY : 0;
+		for (uint64_t i = first; i < zoneCount; i++) {
+			const ProfileZone& zone = buffer->zones[i % ThreadProfileBuffer::CAPACITY];
+			double startTime = tickToTime(zone.startTick);
+			events.push_back({ zone.name, startTime, tickToTime(zone.endTick) - startTime, buffer->threadID });
+		}
+	}
+	return events;
+
+}
+
+size_t myProfiler::currentResidentMemory() {
+#ifdef _WIN32
+	PROCESS_MEMORY_COUNTERS counters;
+	if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+		return 0;
+	}
+	return counters.WorkingSetSize;
+#else
+	//statmĵڶΪפҳ
+	std::ifstream statm("/proc/self/statm");
+	size_t totalPages = 0;
+	size_t residentPages = 0;
+	statm >> totalPages >> residentPages;
+	return residentPages * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+#endif
+}
+
+size_t myProfiler::peakResidentMemory() {
+#ifdef _WIN32
+	PROCESS_MEMORY_COUNTERS counters;
+	if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+		return 0;
+	}
+	return counters.PeakWorkingSetSize;
+#else
+	struct rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+	return static_cast<size_t>(usage.ru_maxrss) * 1024;	//Linuxru_maxrssĵλKB
+#endif
+}
+
+void myProfiler::printMemory(const char* label) {
+	std::cout << "memory " << label << ": current " << currentResidentMemory() / (1024.0 * 1024.0)
+		<< " MB, peak " << peakResidentMemory() / (1024.0 * 1024.0) << " MB" << std::endl;
+}
+
+void myProfiler::printStats() {
+
+	struct ZoneStats {
+		uint32_t count = 0;
+		double totalTime = 0.0;
+		double maxTime = 0.0;
+	};
+	std::map<std::string, ZoneStats> stats;
+	for (const TraceEvent& event : collectEvents()) {
+		ZoneStats& zoneStats = stats[event.name];
+		zoneStats.count++;
+		zoneStats.totalTime += event.duration;
+		zoneStats.maxTime = std::max(zoneStats.maxTime, event.duration);
+	}
+
+	for (auto& zone : stats) {
+		std::cout << "CPU " << zone.first << ": " << zone.second.count << " calls, avg " << zone.second.totalTime / zone.second.count / 1000.0 << " ms, max " << zone.second.maxTime / 1000.0 << " ms" << std::endl;
+	}
+
+}
+
+static std::string escapeJson(const std::string& str) {
+	std::string result;
+	for (char c : str) {
+		if (c == '"' || c == '\\') {
+			result += '\\';
+		}
+		result += c;
+	}
+	return result;
+}
+
+//chrome://tracingui.perfetto.devԴ
+void myProfiler::exportChromeTrace(const std::string& path, const std::vector<TraceEvent>& extraEvents, const std::map<uint32_t, std::string>& extraTracks) {
+
+	std::ofstream file(path, std::ios::trunc);
+	if (!file.is_open()) {
+		std::cerr << "failed to write trace " << path << std::endl;
+		return;
+	}
+
+	std::map<uint32_t, std::string> tracks = extraTracks;
+	{
+		std::lock_guard<std::mutex> lock(registryMutex);
+		for (std::shared_ptr<ThreadProfileBuffer>& buffer : buffers) {
+			tracks[buffer->threadID] = buffer->threadName;
+		}
+	}
+
+	file << "{\"traceEvents\":[\n";
+	bool first = true;
+	for (auto& track : tracks) {
+		file << (first ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << track.first << ",\"args\":{\"name\":\"" << escapeJson(track.second) << "\"}}";
+		first = false;
+	}
+
+	std::vector<TraceEvent> cpuEvents = collectEvents();
+	const std::vector<TraceEvent>* allEvents[] = { &cpuEvents, &extraEvents };
+	for (const std::vector<TraceEvent>* events : allEvents) {
+		for (const TraceEvent& event : *events) {
+			file << (first ? "" : ",\n") << "{\"name\":\"" << escapeJson(event.name) << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << event.threadID
+				<< ",\"ts\":" << std::fixed << event.startTime << ",\"dur\":" << event.duration << "}";
+			first = false;
+		}
+	}
+	file << "\n]}\n";
+
+	std::cout << "trace written to " << path << std::endl;
+
+}
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <map>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <chrono>
+
+//ڹ̵ԤMY_PROFILER_ENABLE=0MY_PROFILE_궼չΪգκο
+#ifndef MY_PROFILER_ENABLE
+#define MY_PROFILER_ENABLE 1
+#endif
+
+//rdtscȡʱsteady_clockˣҪCPUTSCǺ㶨Ƶʵģx86ǣ
+//#define MY_PROFILER_USE_RDTSC
+
+#ifndef MY_PROFILER
+#define MY_PROFILER
+
+//chrome://tracingеһ¼ʱ䵥λΪus
+struct TraceEvent {
+	std::string name;
+	double startTime;
+	double duration;
+	uint32_t threadID;
+};
+
+struct ProfileZone {
+	const char* name;	//ָֻ룬ֱַ
+	uint64_t startTick;
+	uint64_t endTick;
+	uint32_t depth;
+};
+
+//ÿ߳һֻ̻߳дҪд󸲸ɵ
+struct ThreadProfileBuffer {
+	static const uint32_t CAPACITY = 1 << 16;
+	uint32_t threadID;
+	std::string threadName;
+	std::vector<ProfileZone> zones;
+	std::atomic<uint64_t> zoneCount{ 0 };
+	uint32_t depth = 0;
+};
+
+class myProfiler {
+
+public:
+
+	static uint64_t nowTick();
+	static double nowTime();	//ڳCPUʱ䣬us
+	static double tickToTime(uint64_t tick);
+
+	static ThreadProfileBuffer& threadBuffer();
+	static void setThreadName(const std::string& name);
+	static void recordZone(ThreadProfileBuffer& buffer, const char* name, uint64_t startTick, uint64_t endTick, uint32_t depth);
+
+	//ʱ߳Ѿͣˣڱǵܶһ
+	static std::vector<TraceEvent> collectEvents();
+	static void printStats();
+	//̵ǰͷֵĳפڴ棨WindowsΪֽ
+	static size_t currentResidentMemory();
+	static size_t peakResidentMemory();
+	static void printMemory(const char* label);
+	//extraEventsڰGPUʱһ𵼳extraTracksΪЩʱߵthreadID
+	static void exportChromeTrace(const std::string& path, const std::vector<TraceEvent>& extraEvents = {}, const std::map<uint32_t, std::string>& extraTracks = {});
+
+private:
+
+	static std::mutex registryMutex;
+	static std::vector<std::shared_ptr<ThreadProfileBuffer>> buffers;
+
+};
+
+//ʱǿʼʱ䣬ʱд뵱ǰ̵߳Ļ
+class myProfileZone {
+
+public:
+
+	myProfileZone(const char* name) : buffer(myProfiler::threadBuffer()), name(name) {
+		depth = buffer.depth++;
+		startTick = myProfiler::nowTick();
+	}
+
+	~myProfileZone() {
+		uint64_t endTick = myProfiler::nowTick();
+		buffer.depth--;
+		myProfiler::recordZone(buffer, name, startTick, endTick, depth);
+	}
+
+private:
+
+	ThreadProfileBuffer& buffer;
+	const char* name;
+	uint64_t startTick;
+	uint32_t depth;
+
+};
+
+#define MY_PROFILE_CONCAT_INNER(a, b) a##b
+#define MY_PROFILE_CONCAT(a, b) MY_PROFILE_CONCAT_INNER(a, b)
+
+#if MY_PROFILER_ENABLE
+#define MY_PROFILE_SCOPE(name) myProfileZone MY_PROFILE_CONCAT(profileZone, __LINE__)(name)
+#define MY_PROFILE_FUNCTION() MY_PROFILE_SCOPE(__FUNCTION__)
+#define MY_PROFILE_THREAD(name) myProfiler::setThreadName(name)
+#else
+#define MY_PROFILE_SCOPE(name)
+#define MY_PROFILE_FUNCTION()
+#define MY_PROFILE_THREAD(name)
+#endif
+
+#endif
@@ -0,0 +1,54 @@
+#include "myRadixSort.h"
+
+uint32_t myRadixSort::floatToKey(float value) {
+	uint32_t bits;
+	memcpy(&bits, &value, sizeof(bits));
+	return bits & 0x80000000u ? ~bits : bits | 0x80000000u;
+}
+
+void myRadixSort::sortHigh32(std::vector<uint64_t>& keys, std::vector<uint64_t>& scratch) {
+
+	size_t keyNum = keys.size();
+	scratch.resize(keyNum);
+	if (keyNum < 2) {
+		return;
+	}
+
+	//˵ֱͼһ
+	uint32_t counts[4][256] = {};
+	for (uint64_t key : keys) {
+		for (uint32_t pass = 0; pass < 4; pass++) {
+			counts[pass][(key >> (32 + pass * 8)) & 0xFF]++;
+		}
+	}
+
+	uint64_t* src = keys.data();
+	uint64_t* dst = scratch.data();
+	for (uint32_t pass = 0; pass < 4; pass++) {
+
+		//һλмͬʱ򲻻ı˳Ƚӽʱλһ
+		uint32_t* count = counts[pass];
+		uint32_t firstByte = static_cast<uint32_t>((src[0] >> (32 + pass * 8)) & 0xFF);
+		if (count[firstByte] == keyNum) {
+			continue;
+		}
+
+		uint32_t offset = 0;
+		for (uint32_t b = 0; b < 256; b++) {
+			uint32_t num = count[b];
+			count[b] = offset;
+			offset += num;
+		}
+		for (size_t i = 0; i < keyNum; i++) {
+			dst[count[(src[i] >> (32 + pass * 8)) & 0xFF]++] = src[i];
+		}
+		std::swap(src, dst);
+
+	}
+
+	//ʱscratch
+	if (src != keys.data()) {
+		keys.swap(scratch);
+	}
+
+}
@@ -0,0 +1,31 @@
+#pragma once
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include <iostream>
+#include <vector>
+#include <cstring>
+#include <algorithm>
+
+#ifndef MY_RADIX_SORT
+#define MY_RADIX_SORT
+
+//λĻÿδ8λӵλλÿһ˶ȶļ
+//бÿ֡Ҫţڼǧʱstd::sort죬ʱ䲻ݵķֲ仯
+class myRadixSort {
+
+public:
+
+	//ĸ32λΪ32λŻƵֻ32λͬԭ˳
+	static uint64_t makeKey(uint32_t sortKey, uint32_t index) { return static_cast<uint64_t>(sortKey) << 32 | index; }
+	static uint32_t keyIndex(uint64_t key) { return static_cast<uint32_t>(key); }
+
+	//Ѹӳ޷ĴС˳͸ͬתλתλ
+	static uint32_t floatToKey(float value);
+
+	//scratchkeysһɵ߳Уÿ֡ظʹò·
+	static void sortHigh32(std::vector<uint64_t>& keys, std::vector<uint64_t>& scratch);
+
+};
+
+#endif
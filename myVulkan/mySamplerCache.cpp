@@ -0,0 +1,117 @@
+#include "mySamplerCache.h"
+
+std::mutex mySamplerCache::cacheMutex;
+VkDevice mySamplerCache::logicalDevice = VK_NULL_HANDLE;
+std::unordered_map<SamplerKey, VkSampler, SamplerKeyHash> mySamplerCache::samplers;
+float mySamplerCache::deviceMaxAnisotropy = 0.0f;
+uint64_t mySamplerCache::requestCount = 0;
+
+SamplerKey::SamplerKey(const VkSamplerCreateInfo& samplerInfo) {
+	flags = samplerInfo.flags;
+	magFilter = samplerInfo.magFilter;
+	minFilter = samplerInfo.minFilter;
+	mipmapMode = samplerInfo.mipmapMode;
+	addressModeU = samplerInfo.addressModeU;
+	addressModeV = samplerInfo.addressModeV;
+	addressModeW = samplerInfo.addressModeW;
+	mipLodBias = samplerInfo.mipLodBias;
+	anisotropyEnable = samplerInfo.anisotropyEnable;
+	maxAnisotropy = samplerInfo.maxAnisotropy;
+	compareEnable = samplerInfo.compareEnable;
+	compareOp = samplerInfo.compareOp;
+	minLod = samplerInfo.minLod;
+	maxLod = samplerInfo.maxLod;
+	borderColor = samplerInfo.borderColor;
+	unnormalizedCoordinates = samplerInfo.unnormalizedCoordinates;
+}
+
+bool SamplerKey::operator==(const SamplerKey& other) const {
+	return flags == other.flags && magFilter == other.magFilter && minFilter == other.minFilter && mipmapMode == other.mipmapMode
+		&& addressModeU == other.addressModeU && addressModeV == other.addressModeV && addressModeW == other.addressModeW
+		&& mipLodBias == other.mipLodBias && anisotropyEnable == other.anisotropyEnable && maxAnisotropy == other.maxAnisotropy
+		&& compareEnable == other.compareEnable && compareOp == other.compareOp && minLod == other.minLod && maxLod == other.maxLod
+		&& borderColor == other.borderColor && unnormalizedCoordinates == other.unnormalizedCoordinates;
+}
+
+//FNV-1a㰴λϣ==Ľһ£ﲻNaN
+uint64_t SamplerKey::hash() const {
+	uint64_t hash = 14695981039346656037ull;
+	auto mix = [&hash](uint32_t value) {
+		for (int i = 0; i < 4; i++) {
+			hash ^= (value >> (i * 8)) & 0xFF;
+			hash *= 1099511628211ull;
+		}
+	};
+	auto mixFloat = [&mix](float value) {
+		uint32_t bits;
+		memcpy(&bits, &value, sizeof(bits));
+		mix(value == 0.0f ? 0 : bits);	//-0.00.0ȣϣҲҪͬ
+	};
+	mix(flags);
+	mix(magFilter);
+	mix(minFilter);
+	mix(mipmapMode);
+	mix(addressModeU);
+	mix(addressModeV);
+	mix(addressModeW);
+	mixFloat(mipLodBias);
+	mix(anisotropyEnable);
+	mixFloat(maxAnisotropy);
+	mix(compareEnable);
+	mix(compareOp);
+	mixFloat(minLod);
+	mixFloat(maxLod);
+	mix(borderColor);
+	mix(unnormalizedCoordinates);
+	return hash;
+}
+
+VkSampler mySamplerCache::getSampler(VkDevice logicalDevice, const VkSamplerCreateInfo& samplerInfo) {
+
+	std::lock_guard<std::mutex> lock(cacheMutex);
+	requestCount++;
+	mySamplerCache::logicalDevice = logicalDevice;
+
+	SamplerKey key(samplerInfo);
+	auto it = samplers.find(key);
+	if (it != samplers.end()) {
+		return it->second;
+	}
+
+	VkSampler sampler;
+	if (vkCreateSampler(logicalDevice, &samplerInfo, nullptr, &sampler) != VK_SUCCESS) {
+		throw std::runtime_error("failed to create texture sampler!");
+	}
+	samplers.emplace(key, sampler);
+	return sampler;
+
+}
+
+float mySamplerCache::maxAnisotropy(VkPhysicalDevice physicalDevice) {
+	std::lock_guard<std::mutex> lock(cacheMutex);
+	if (deviceMaxAnisotropy == 0.0f) {
+		VkPhysicalDeviceProperties properties{};
+		vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+		deviceMaxAnisotropy = properties.limits.maxSamplerAnisotropy;
+	}
+	return deviceMaxAnisotropy;
+}
+
+uint32_t mySamplerCache::samplerCount() {
+	std::lock_guard<std::mutex> lock(cacheMutex);
+	return static_cast<uint32_t>(samplers.size());
+}
+
+void mySamplerCache::printStats() {
+	std::lock_guard<std::mutex> lock(cacheMutex);
+	std::cout << "samplers: " << requestCount << " requests, " << samplers.size() << " created" << std::endl;
+}
+
+void mySamplerCache::clean() {
+	std::lock_guard<std::mutex> lock(cacheMutex);
+	for (auto& entry : samplers) {
+		vkDestroySampler(logicalDevice, entry.second, nullptr);
+	}
+	samplers.clear();
+	deviceMaxAnisotropy = 0.0f;
+}
@@ -0,0 +1,71 @@
+#pragma once
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include <iostream>
+#include <vector>
+#include <mutex>
+#include <unordered_map>
+#include <stdexcept>
+#include <cstring>
+
+#ifndef MY_SAMPLER_CACHE
+#define MY_SAMPLER_CACHE
+
+//״̬VkSamplerCreateInfosTypepNextֶ
+struct SamplerKey {
+
+	VkSamplerCreateFlags flags;
+	VkFilter magFilter;
+	VkFilter minFilter;
+	VkSamplerMipmapMode mipmapMode;
+	VkSamplerAddressMode addressModeU;
+	VkSamplerAddressMode addressModeV;
+	VkSamplerAddressMode addressModeW;
+	float mipLodBias;
+	VkBool32 anisotropyEnable;
+	float maxAnisotropy;
+	VkBool32 compareEnable;
+	VkCompareOp compareOp;
+	float minLod;
+	float maxLod;
+	VkBorderColor borderColor;
+	VkBool32 unnormalizedCoordinates;
+
+	SamplerKey(const VkSamplerCreateInfo& samplerInfo);
+	bool operator==(const SamplerKey& other) const;
+	uint64_t hash() const;
+
+};
+
+struct SamplerKeyHash {
+	size_t operator()(const SamplerKey& key) const { return static_cast<size_t>(key.hash()); }
+};
+
+//ȫֵĲ棬״̬ͬһVkSampler
+//maxLodͳһVK_LOD_CLAMP_NONEmipͬҲͬһǧֻҪԶmaxSamplerAllocationCount
+class mySamplerCache {
+
+public:
+
+	//صĲ黺Уʹ߲Ҫ٣pNextȽϣֻûչṹĴϢ
+	static VkSampler getSampler(VkDevice logicalDevice, const VkSamplerCreateInfo& samplerInfo);
+	//ֻڵһεʱѯ豸
+	static float maxAnisotropy(VkPhysicalDevice physicalDevice);
+
+	static uint32_t samplerCount();
+	static void printStats();
+	//豸С֮
+	static void clean();
+
+private:
+
+	static std::mutex cacheMutex;
+	static VkDevice logicalDevice;
+	static std::unordered_map<SamplerKey, VkSampler, SamplerKeyHash> samplers;
+	static float deviceMaxAnisotropy;	//0ʾûѯ
+	static uint64_t requestCount;
+
+};
+
+#endif
@@ -0,0 +1,205 @@
+#include "myScene.h"
+#include "myProfiler.h"
+
+uint32_t myScene::addNode(std::string name, int32_t parent, glm::vec3 translation, glm::quat rotation, glm::vec3 scale) {
+
+	if (parent != NO_PARENT && (parent < 0 || parent >= static_cast<int32_t>(nodeCount()))) {
+		throw std::runtime_error("failed to add scene node: parent does not exist!");
+	}
+
+	uint32_t node = nodeCount();
+	parents.push_back(parent);
+	translations.push_back(translation);
+	rotations.push_back(rotation);
+	scales.push_back(scale);
+	localMatrices.push_back(glm::mat4(1.0f));
+	worldMatrices.push_back(glm::mat4(1.0f));
+	localDirty.push_back(1);
+	worldChanged.push_back(0);
+	names.push_back(std::move(name));
+	dirtyNodeNum++;
+	return node;
+
+}
+
+std::vector<uint32_t> myScene::sortByDepth() {
+
+	uint32_t nodeNum = nodeCount();
+
+	//ڵȼ룬һ
+	std::vector<uint32_t> depths(nodeNum);
+	uint32_t maxDepth = 0;
+	for (uint32_t i = 0; i < nodeNum; i++) {
+		depths[i] = parents[i] == NO_PARENT ? 0 : depths[parents[i]] + 1;
+		maxDepth = std::max(maxDepth, depths[i]);
+	}
+
+	//ȼͬһڱּ˳
+	levelOffsets.assign(nodeNum > 0 ? maxDepth + 2 : 1, 0);
+	for (uint32_t i = 0; i < nodeNum; i++) {
+		levelOffsets[depths[i] + 1]++;
+	}
+	for (uint32_t d = 1; d < levelOffsets.size(); d++) {
+		levelOffsets[d] += levelOffsets[d - 1];
+	}
+	std::vector<uint32_t> remap(nodeNum);
+	std::vector<uint32_t> levelCursor(levelOffsets.begin(), levelOffsets.end() - 1);
+	for (uint32_t i = 0; i < nodeNum; i++) {
+		remap[i] = levelCursor[depths[i]]++;
+	}
+
+	std::vector<int32_t> sortedParents(nodeNum);
+	std::vector<glm::vec3> sortedTranslations(nodeNum);
+	std::vector<glm::quat> sortedRotations(nodeNum);
+	std::vector<glm::vec3> sortedScales(nodeNum);
+	std::vector<glm::mat4> sortedLocalMatrices(nodeNum);
+	std::vector<glm::mat4> sortedWorldMatrices(nodeNum);
+	std::vector<uint8_t> sortedLocalDirty(nodeNum);
+	std::vector<std::string> sortedNames(nodeNum);
+	for (uint32_t i = 0; i < nodeNum; i++) {
+		uint32_t j = remap[i];
+		sortedParents[j] = parents[i] == NO_PARENT ? NO_PARENT : static_cast<int32_t>(remap[parents[i]]);
+		sortedTranslations[j] = translations[i];
+		sortedRotations[j] = rotations[i];
+		sortedScales[j] = scales[i];
+		sortedLocalMatrices[j] = localMatrices[i];
+		sortedWorldMatrices[j] = worldMatrices[i];
+		sortedLocalDirty[j] = localDirty[i];
+		sortedNames[j] = std::move(names[i]);
+	}
+	parents = std::move(sortedParents);
+	translations = std::move(sortedTranslations);
+	rotations = std::move(sortedRotations);
+	scales = std::move(sortedScales);
+	localMatrices = std::move(sortedLocalMatrices);
+	worldMatrices = std::move(sortedWorldMatrices);
+	localDirty = std::move(sortedLocalDirty);
+	names = std::move(sortedNames);
+	worldChanged.assign(nodeNum, 0);
+
+	return remap;
+
+}
+
+int32_t myScene::findNode(const std::string& name) {
+	for (uint32_t i = 0; i < nodeCount(); i++) {
+		if (names[i] == name) {
+			return static_cast<int32_t>(i);
+		}
+	}
+	return NO_PARENT;
+}
+
+void myScene::markDirty(uint32_t node) {
+	if (!localDirty[node]) {
+		localDirty[node] = 1;
+		dirtyNodeNum++;
+	}
+}
+
+void myScene::setTranslation(uint32_t node, glm::vec3 translation) {
+	translations[node] = translation;
+	markDirty(node);
+}
+
+void myScene::setRotation(uint32_t node, glm::quat rotation) {
+	rotations[node] = rotation;
+	markDirty(node);
+}
+
+void myScene::setScale(uint32_t node, glm::vec3 scale) {
+	scales[node] = scale;
+	markDirty(node);
+}
+
+//ڵǰĲѾ꣬[begin, end)ڵĽڵ㻥
+void myScene::updateRange(uint32_t begin, uint32_t end, uint32_t* updatedNum) {
+
+	uint32_t num = 0;
+	for (uint32_t i = begin; i < end; i++) {
+
+		int32_t parent = parents[i];
+		bool changed = localDirty[i] || (parent != NO_PARENT && worldChanged[parent]);
+		worldChanged[i] = changed;
+		if (!changed) {
+			continue;
+		}
+
+		if (localDirty[i]) {
+			//T * R * SֱдУξ˷
+			glm::mat4& local = localMatrices[i];
+			local = glm::mat4_cast(rotations[i]);
+			local[0] *= scales[i].x;
+			local[1] *= scales[i].y;
+			local[2] *= scales[i].z;
+			local[3] = glm::vec4(translations[i], 1.0f);
+			localDirty[i] = 0;
+		}
+
+		worldMatrices[i] = parent == NO_PARENT ? localMatrices[i] : worldMatrices[parent] * localMatrices[i];
+		num++;
+
+	}
+	*updatedNum = num;
+
+}
+
+uint32_t myScene::update() {
+
+	MY_PROFILE_FUNCTION();
+
+	uint32_t nodeNum = nodeCount();
+	if (dirtyNodeNum == 0) {
+		//һαıҪȻʹ߻Ϊһֱ֡
+		if (lastUpdatedNum > 0) {
+			std::fill(worldChanged.begin(), worldChanged.end(), 0);
+			lastUpdatedNum = 0;
+		}
+		return 0;
+	}
+
+	uint32_t updatedNum = 0;
+	//ûʱڵȻӽڵǰ棬ֻǲܰ㲢
+	if (levelOffsets.empty() || levelOffsets.back() != nodeNum) {
+		updateRange(0, nodeNum, &updatedNum);
+	}
+	else {
+		std::vector<uint32_t> chunkUpdatedNums;
+		for (uint32_t d = 0; d + 1 < levelOffsets.size(); d++) {
+
+			uint32_t begin = levelOffsets[d];
+			uint32_t end = levelOffsets[d + 1];
+			if (end - begin <= PARALLEL_CHUNK_SIZE) {
+				uint32_t num;
+				updateRange(begin, end, &num);
+				updatedNum += num;
+				continue;
+			}
+
+			if (!threadPool) {
+				threadPool = std::make_unique<myThreadPool>();
+			}
+			uint32_t chunkNum = (end - begin + PARALLEL_CHUNK_SIZE - 1) / PARALLEL_CHUNK_SIZE;
+			chunkUpdatedNums.assign(chunkNum, 0);
+			//һǰ̣̳߳߳صʱҲ
+			for (uint32_t c = 0; c + 1 < chunkNum; c++) {
+				uint32_t chunkBegin = begin + c * PARALLEL_CHUNK_SIZE;
+				uint32_t* chunkUpdatedNum = &chunkUpdatedNums[c];
+				threadPool->submit([this, chunkBegin, chunkUpdatedNum]() {
+					updateRange(chunkBegin, chunkBegin + PARALLEL_CHUNK_SIZE, chunkUpdatedNum);
+				});
+			}
+			updateRange(begin + (chunkNum - 1) * PARALLEL_CHUNK_SIZE, end, &chunkUpdatedNums[chunkNum - 1]);
+			threadPool->waitIdle();
+			for (uint32_t num : chunkUpdatedNums) {
+				updatedNum += num;
+			}
+
+		}
+	}
+
+	dirtyNodeNum = 0;
+	lastUpdatedNum = updatedNum;
+	return updatedNum;
+
+}
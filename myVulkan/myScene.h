@@ -0,0 +1,72 @@
+#pragma once
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#define GLM_FORCE_RADIANS
+#define GLM_ENABLE_EXPERIMENTAL
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <memory>
+#include <algorithm>
+#include <stdexcept>
+
+#include "myThreadPool.h"
+
+#ifndef MY_SCENE
+#define MY_SCENE
+
+//Ľڵ㼶ṹ棬ڵiÿĵi
+//ڵ㰴ź򣺸ڵһӽڵǰ棬ͬһȵĽڵţͬһԲи
+//޸ľֲ任ֻǣupdateʱֻ¼ڵǵ
+class myScene {
+
+public:
+
+	static const int32_t NO_PARENT = -1;
+	//һеĽڵ㳬ŷָ̳߳أֵ̫ĻȱȾ˷
+	static const uint32_t PARALLEL_CHUNK_SIZE = 4096;
+
+	std::vector<int32_t> parents;
+	std::vector<glm::vec3> translations;
+	std::vector<glm::quat> rotations;
+	std::vector<glm::vec3> scales;
+	std::vector<glm::mat4> localMatrices;	//ֻԼı任˲㣬ڵ㶯ֻҪһξ˷
+	std::vector<glm::mat4> worldMatrices;
+	std::vector<uint8_t> localDirty;	//ֲ任Ĺû
+	std::vector<uint8_t> worldChanged;	//һupdateˣϴ֮
+	std::vector<std::string> names;
+
+	//levelOffsets[d]levelOffsets[d + 1]ΪdĽڵ
+	std::vector<uint32_t> levelOffsets;
+
+	//parentѾӽĽڵ㣬ؽڵsortByDepth֮ǰǼ˳
+	uint32_t addNode(std::string name, int32_t parent, glm::vec3 translation, glm::quat rotation, glm::vec3 scale);
+	//ѽڵ㰴Уؾӳ䣬ĽڵҪ
+	std::vector<uint32_t> sortByDepth();
+
+	uint32_t nodeCount() { return static_cast<uint32_t>(parents.size()); }
+	int32_t findNode(const std::string& name);
+
+	void setTranslation(uint32_t node, glm::vec3 translation);
+	void setRotation(uint32_t node, glm::quat rotation);
+	void setScale(uint32_t node, glm::vec3 scale);
+
+	//¼ڵ㼰󣬷¼Ľڵ
+	uint32_t update();
+
+private:
+
+	uint32_t dirtyNodeNum = 0;
+	uint32_t lastUpdatedNum = 0;
+	std::unique_ptr<myThreadPool> threadPool;	//һ㹻ĲʱŴ
+
+	void markDirty(uint32_t node);
+	void updateRange(uint32_t begin, uint32_t end, uint32_t* updatedNum);
+
+};
+
+#endif
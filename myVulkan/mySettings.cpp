@@ -0,0 +1,161 @@
+#include "mySettings.h"
+
+#include <stdexcept>
+#include <cstdlib>
+
+static std::string nextArgument(int argc, char** argv, int& index) {
+	if (index + 1 >= argc) {
+		throw std::runtime_error(std::string("missing value for ") + argv[index] + "!");
+	}
+	return argv[++index];
+}
+
+static double parseNumber(const std::string& option, const std::string& value) {
+	try {
+		size_t end = 0;
+		double number = std::stod(value, &end);
+		if (end == value.size()) {
+			return number;
+		}
+	}
+	catch (const std::exception&) {
+	}
+	throw std::runtime_error("invalid value " + value + " for " + option + "!");
+}
+
+mySettings::mySettings(int argc, char** argv) {
+
+	for (int i = 1; i < argc; i++) {
+
+		std::string option = argv[i];
+		if (option == "--frames-in-flight") {
+			double value = parseNumber(option, nextArgument(argc, argv, i));
+			if (value < MIN_FRAMES_IN_FLIGHT || value > MAX_FRAMES_IN_FLIGHT || value != static_cast<uint32_t>(value)) {
+				throw std::runtime_error("frames in flight must be an integer in [1, 4]!");
+			}
+			framesInFlight = static_cast<uint32_t>(value);
+		}
+		else if (option == "--target-fps") {
+			double fps = parseNumber(option, nextArgument(argc, argv, i));
+			if (fps < 0.0) {
+				throw std::runtime_error("target fps must not be negative!");
+			}
+			targetFrameTime = fps == 0.0 ? 0.0 : 1000.0 / fps;
+		}
+		else if (option == "--frame-budget") {
+			targetFrameTime = parseNumber(option, nextArgument(argc, argv, i));
+			if (targetFrameTime < 0.0) {
+				throw std::runtime_error("frame budget must not be negative!");
+			}
+		}
+		else if (option == "--present-mode") {
+			std::string mode = nextArgument(argc, argv, i);
+			if (mode == "immediate") {
+				presentMode = VK_PRESENT_MODE_IMMEDIATE_KHR;
+			}
+			else if (mode == "mailbox") {
+				presentMode = VK_PRESENT_MODE_MAILBOX_KHR;
+			}
+			else if (mode == "fifo") {
+				presentMode = VK_PRESENT_MODE_FIFO_KHR;
+			}
+			else if (mode == "fifo_relaxed") {
+				presentMode = VK_PRESENT_MODE_FIFO_RELAXED_KHR;
+			}
+			else {
+				throw std::runtime_error("unknown present mode " + mode + "!");
+			}
+		}
+		else if (option == "--swapchain-images") {
+			double value = parseNumber(option, nextArgument(argc, argv, i));
+			if (value < 0.0 || value != static_cast<uint32_t>(value)) {
+				throw std::runtime_error("swapchain image count must be a non-negative integer!");
+			}
+			swapChainImageCount = static_cast<uint32_t>(value);
+		}
+		else if (option == "--async-compute") {
+			std::string value = nextArgument(argc, argv, i);
+			if (value == "on") {
+				asyncCompute = true;
+			}
+			else if (value == "off") {
+				asyncCompute = false;
+			}
+			else {
+				throw std::runtime_error("async compute must be on or off!");
+			}
+		}
+		else if (option == "--lod-error") {
+			double value = parseNumber(option, nextArgument(argc, argv, i));
+			if (value < 0.0) {
+				throw std::runtime_error("lod error must not be negative!");
+			}
+			lodPixelError = static_cast<float>(value);
+		}
+		else if (option == "--depth-prepass") {
+			std::string value = nextArgument(argc, argv, i);
+			if (value == "on") {
+				depthPrepass = true;
+			}
+			else if (value == "off") {
+				depthPrepass = false;
+			}
+			else {
+				throw std::runtime_error("depth prepass must be on or off!");
+			}
+		}
+		else if (option == "--reverse-z") {
+			std::string value = nextArgument(argc, argv, i);
+			if (value == "on") {
+				reverseZ = true;
+			}
+			else if (value == "off") {
+				reverseZ = false;
+			}
+			else {
+				throw std::runtime_error("reverse z must be on or off!");
+			}
+		}
+		else if (option == "--bench-bvh") {
+			double value = parseNumber(option, nextArgument(argc, argv, i));
+			if (value < 1.0 || value != static_cast<uint32_t>(value)) {
+				throw std::runtime_error("bvh benchmark primitive count must be a positive integer!");
+			}
+			bvhBenchmarkPrimitives = static_cast<uint32_t>(value);
+		}
+		else if (option == "--help" || option == "-h") {
+			printUsage();
+			std::exit(EXIT_SUCCESS);
+		}
+		else {
+			printUsage();
+			throw std::runtime_error("unknown option " + option + "!");
+		}
+
+	}
+
+}
+
+void mySettings::printUsage() {
+	std::cout << "options:" << std::endl;
+	std::cout << "  --frames-in-flight N   frames queued on the GPU, 1-4 (default 2)" << std::endl;
+	std::cout << "  --target-fps F         pace frames to F fps, 0 = unlimited" << std::endl;
+	std::cout << "  --frame-budget MS      pace frames to MS milliseconds, 0 = unlimited" << std::endl;
+	std::cout << "  --present-mode M       immediate, mailbox, fifo or fifo_relaxed (default mailbox)" << std::endl;
+	std::cout << "  --swapchain-images N   swapchain image count, 0 = minimum + 1" << std::endl;
+	std::cout << "  --async-compute on|off run compute passes on a separate queue when available (default on)" << std::endl;
+	std::cout << "  --lod-error PX         screen-space error allowed when picking mesh LODs, 0 = full detail (default 1)" << std::endl;
+	std::cout << "  --depth-prepass on|off depth-only pass before the G-buffer, shaded with EQUAL depth test (default on)" << std::endl;
+	std::cout << "  --reverse-z on|off     reverse-Z depth with an infinite far plane, needs a float depth format (default on)" << std::endl;
+	std::cout << "  --bench-bvh N          benchmark BVH build and queries over N random boxes, then exit" << std::endl;
+}
+
+const char* mySettings::presentModeName(VkPresentModeKHR presentMode) {
+	switch (presentMode) {
+	case VK_PRESENT_MODE_IMMEDIATE_KHR: return "immediate";
+	case VK_PRESENT_MODE_MAILBOX_KHR: return "mailbox";
+	case VK_PRESENT_MODE_FIFO_KHR: return "fifo";
+	case VK_PRESENT_MODE_FIFO_RELAXED_KHR: return "fifo_relaxed";
+	default: return "unknown";
+	}
+}
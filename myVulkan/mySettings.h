@@ -0,0 +1,49 @@
+#pragma once
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include <iostream>
+#include <string>
+
+#ifndef MY_SETTINGS
+#define MY_SETTINGS
+
+//ʱãжȡͬĲӳ֮ȡ
+class mySettings {
+
+public:
+
+	static const uint32_t MIN_FRAMES_IN_FLIGHT = 1;
+	static const uint32_t MAX_FRAMES_IN_FLIGHT = 4;
+
+	//ͬʱGPUϷе֡ԽԽߣ뵽ʾӳҲԽ
+	uint32_t framesInFlight = 2;
+	//ÿ֡ʱԤ㣬ms0ʾƣ֡ʱڲ֮ǰȴָ
+	double targetFrameTime = 0.0;
+
+	//֧ʱ˻FIFOFIFOһֵ֧ģ
+	//IMMEDIATEӳ͵˺ѣMAILBOX˺ӳٽϵͣFIFOˢŶӣӳ
+	VkPresentModeKHR presentMode = VK_PRESENT_MODE_MAILBOX_KHR;
+	//ͼ0ʾminImageCount + 1ֵ֧ķΧʱᱻض
+	uint32_t swapChainImageCount = 0;
+	//жļʱ޳ȼŵϺͼζصִ
+	bool asyncCompute = true;
+	//LODͶӰĻأ0ʾϸһ
+	float lodPixelError = 1.0f;
+	//ȻһֻȵԤͨgBufferEQUALԣӳٱڵƬԪɫ
+	bool depthPrepass = true;
+	//ZԶƽ棺Ϊ1ԶΪ0ȵľԶҲãҪԶƽ
+	bool reverseZ = true;
+	//Ϊ0ʱ򿪴ڣôΧһBVHĹͲѯܲ
+	uint32_t bvhBenchmarkPrimitives = 0;
+
+	mySettings() = default;
+	//Ϸʱ׳쳣
+	mySettings(int argc, char** argv);
+
+	static void printUsage();
+	static const char* presentModeName(VkPresentModeKHR presentMode);
+
+};
+
+#endif
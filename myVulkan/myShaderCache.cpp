@@ -0,0 +1,253 @@
+#include "myShaderCache.h"
+
+#include <fstream>
+#include <filesystem>
+#include <chrono>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#endif
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+static const uint32_t SPIRV_MAGIC = 0x07230203;
+
+ShaderModule::ShaderModule(VkDevice logicalDevice, const std::vector<char>& code) {
+
+	this->logicalDevice = logicalDevice;
+	this->reflection = myShaderReflection::reflect(code);
+
+	VkShaderModuleCreateInfo createInfo{};
+	createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+	createInfo.codeSize = code.size();
+	createInfo.pCode = reinterpret_cast<const uint32_t*>(code.data());
+
+	if (vkCreateShaderModule(logicalDevice, &createInfo, nullptr, &this->module) != VK_SUCCESS) {
+		throw std::runtime_error("failed to create shader module!");
+	}
+
+}
+
+ShaderModule::~ShaderModule() {
+	vkDestroyShaderModule(logicalDevice, module, nullptr);
+}
+
+myShaderCache::myShaderCache(VkDevice logicalDevice, std::string shaderDir) {
+	this->logicalDevice = logicalDevice;
+	this->shaderDir = findPath(shaderDir);
+	std::cout << "shader directory: " << this->shaderDir << std::endl;
+}
+
+std::shared_ptr<ShaderModule> myShaderCache::getShaderModule(const std::string& name) {
+
+	std::lock_guard<std::mutex> lock(cacheMutex);
+	auto it = modules.find(name);
+	if (it != modules.end()) {
+		return it->second;
+	}
+
+	std::shared_ptr<ShaderModule> shaderModule = loadShaderModule(name);
+	if (!shaderModule) {
+		throw std::runtime_error("failed to load shader " + name + "!");
+	}
+	modules[name] = shaderModule;
+	return shaderModule;
+
+}
+
+bool myShaderCache::reload(const std::string& name) {
+
+	std::shared_ptr<ShaderModule> shaderModule;
+	try {
+		shaderModule = loadShaderModule(name);
+	}
+	catch (const std::exception& e) {
+		std::cerr << e.what() << std::endl;
+		return false;
+	}
+	if (!shaderModule) {
+		return false;
+	}
+
+	//ģܻڱ߳ʹãֻǻ
+	std::lock_guard<std::mutex> lock(cacheMutex);
+	modules[name] = shaderModule;
+	return true;
+
+}
+
+std::shared_ptr<ShaderModule> myShaderCache::loadShaderModule(const std::string& name) {
+
+	std::vector<char> code = readFile((std::filesystem::path(shaderDir) / name).string());
+	//ܻûдļȻħԾ͵Ч
+	if (code.size() < sizeof(uint32_t) || code.size() % sizeof(uint32_t) != 0) {
+		return nullptr;
+	}
+	uint32_t magic;
+	memcpy(&magic, code.data(), sizeof(magic));
+	if (magic != SPIRV_MAGIC) {
+		return nullptr;
+	}
+
+	return std::make_shared<ShaderModule>(logicalDevice, code);
+
+}
+
+void myShaderCache::startWatching(std::function<void(const std::string&)> onChanged) {
+	watching = true;
+	watchThread = std::thread(&myShaderCache::watchLoop, this, onChanged);
+}
+
+void myShaderCache::stopWatching() {
+	watching = false;
+	if (watchThread.joinable()) {
+		watchThread.join();
+	}
+}
+
+#ifdef __linux__
+//linuxinotifyļرд߱ʱ֪ͨ
+void myShaderCache::watchLoop(std::function<void(const std::string&)> onChanged) {
+
+	int fd = inotify_init1(IN_NONBLOCK);
+	if (fd < 0) {
+		std::cerr << "failed to init inotify, shader hot reload disabled" << std::endl;
+		return;
+	}
+	if (inotify_add_watch(fd, shaderDir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+		std::cerr << "failed to watch " << shaderDir << ", shader hot reload disabled" << std::endl;
+		close(fd);
+		return;
+	}
+
+	alignas(inotify_event) char buffer[4096];
+	while (watching) {
+
+		pollfd pfd{ fd, POLLIN, 0 };
+		if (poll(&pfd, 1, 100) <= 0) {	//ʱ˾ͻȥһǷҪ˳
+			continue;
+		}
+
+		ssize_t length = read(fd, buffer, sizeof(buffer));
+		for (ssize_t offset = 0; offset < length;) {
+			const inotify_event* event = reinterpret_cast<const inotify_event*>(buffer + offset);
+			if (event->len > 0) {
+				std::string name = event->name;
+				if (std::filesystem::path(name).extension() == ".spv") {
+					onChanged(name);
+				}
+			}
+			offset += sizeof(inotify_event) + event->len;
+		}
+
+	}
+
+	close(fd);
+
+}
+#else
+//ƽ̨ѯļ޸ʱ
+void myShaderCache::watchLoop(std::function<void(const std::string&)> onChanged) {
+
+	std::unordered_map<std::string, std::filesystem::file_time_type> lastWriteTimes;
+	bool firstScan = true;
+	while (watching) {
+
+		std::error_code ec;
+		for (const auto& file : std::filesystem::directory_iterator(shaderDir, ec)) {
+			if (file.path().extension() != ".spv") {
+				continue;
+			}
+			std::string name = file.path().filename().string();
+			std::filesystem::file_time_type writeTime = file.last_write_time(ec);
+			if (ec) {
+				continue;
+			}
+			auto it = lastWriteTimes.find(name);
+			if (it == lastWriteTimes.end() || it->second != writeTime) {
+				lastWriteTimes[name] = writeTime;
+				if (!firstScan) {
+					onChanged(name);
+				}
+			}
+		}
+		firstScan = false;
+
+		std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+	}
+
+}
+#endif
+
+void myShaderCache::clean() {
+	stopWatching();
+	std::lock_guard<std::mutex> lock(cacheMutex);
+	modules.clear();
+}
+
+std::string myShaderCache::getExecutablePath() {
+#ifdef _WIN32
+	char path[MAX_PATH];
+	DWORD length = GetModuleFileNameA(nullptr, path, MAX_PATH);
+	return std::string(path, length);
+#else
+	std::error_code ec;
+	std::filesystem::path path = std::filesystem::read_symlink("/proc/self/exe", ec);
+	return ec ? std::string() : path.string();
+#endif
+}
+
+//ӿִļĿ¼ңvsĿ¼x64/Debug£ԴĿĿ¼£ÿһҲһºͿִļͬĿĿ¼
+//ҲùĿ¼
+std::string myShaderCache::findPath(const std::string& relativePath) {
+
+	std::error_code ec;
+	std::filesystem::path exePath = getExecutablePath();
+	if (!exePath.empty()) {
+		std::filesystem::path projectName = exePath.stem();
+		for (std::filesystem::path dir = exePath.parent_path(); !dir.empty(); dir = dir.parent_path()) {
+			if (std::filesystem::exists(dir / relativePath, ec)) {
+				return (dir / relativePath).lexically_normal().string();
+			}
+			if (std::filesystem::exists(dir / projectName / relativePath, ec)) {
+				return (dir / projectName / relativePath).lexically_normal().string();
+			}
+			if (dir == dir.parent_path()) {
+				break;
+			}
+		}
+	}
+
+	std::filesystem::path workPath = std::filesystem::current_path() / relativePath;
+	if (std::filesystem::exists(workPath, ec)) {
+		return workPath.lexically_normal().string();
+	}
+
+	throw std::runtime_error("failed to find " + relativePath + "!");
+
+}
+
+std::vector<char> myShaderCache::readFile(const std::string& filename) {
+
+	std::ifstream file(filename, std::ios::ate | std::ios::binary);
+	if (!file.is_open()) {
+		throw std::runtime_error("failed to open file " + filename + "!");
+	}
+
+	size_t fileSize = (size_t)file.tellg();
+	std::vector<char> buffer(fileSize);
+
+	file.seekg(0);
+	file.read(buffer.data(), fileSize);
+
+	file.close();
+	return buffer;
+
+}
@@ -0,0 +1,72 @@
+#pragma once
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <memory>
+#include <unordered_map>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <functional>
+
+#include "structSet.h"
+#include "myShaderReflection.h"
+
+#ifndef MY_SHADER_CACHE
+#define MY_SHADER_CACHE
+
+//ɫģͬʱ߳ʹã滻Ҫһʹ٣shared_ptr
+struct ShaderModule {
+
+	VkDevice logicalDevice;
+	VkShaderModule module;
+	ShaderReflection reflection;	//ʱSPIR-Vpush constantͶ
+
+	//codeʧʱ׳쳣ʱģ
+	ShaderModule(VkDevice logicalDevice, const std::vector<char>& code);
+	~ShaderModule();
+
+};
+
+class myShaderCache {
+
+public:
+
+	VkDevice logicalDevice;
+	std::string shaderDir;	//ɫĿ¼
+
+	//shaderDirڿִļ·"shaders/deferredShading"
+	myShaderCache(VkDevice logicalDevice, std::string shaderDir);
+
+	//nameΪshaderDirµļ"gBufferVert.spv"
+	std::shared_ptr<ShaderModule> getShaderModule(const std::string& name);
+	//¶ȡļļǺϷSPIR-Vʱģ鲢false
+	bool reload(const std::string& name);
+
+	//ļ仯ʱڼ߳ϻصΪļ
+	void startWatching(std::function<void(const std::string&)> onChanged);
+	void stopWatching();
+
+	void clean();
+
+	static std::string getExecutablePath();
+	static std::string findPath(const std::string& relativePath);
+	static std::vector<char> readFile(const std::string& filename);
+
+private:
+
+	std::mutex cacheMutex;
+	std::unordered_map<std::string, std::shared_ptr<ShaderModule>> modules;
+
+	std::thread watchThread;
+	std::atomic<bool> watching{ false };
+
+	std::shared_ptr<ShaderModule> loadShaderModule(const std::string& name);
+	void watchLoop(std::function<void(const std::string&)> onChanged);
+
+};
+
+#endif
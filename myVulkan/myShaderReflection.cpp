@@ -0,0 +1,449 @@
+#include "myShaderReflection.h"
+
+#include <cstring>
+
+//SPIR-V淶ıţֻгõ
+static const uint32_t SPIRV_MAGIC = 0x07230203;
+
+static const uint32_t OP_NAME = 5;
+static const uint32_t OP_ENTRY_POINT = 15;
+static const uint32_t OP_TYPE_INT = 21;
+static const uint32_t OP_TYPE_FLOAT = 22;
+static const uint32_t OP_TYPE_VECTOR = 23;
+static const uint32_t OP_TYPE_MATRIX = 24;
+static const uint32_t OP_TYPE_IMAGE = 25;
+static const uint32_t OP_TYPE_SAMPLER = 26;
+static const uint32_t OP_TYPE_SAMPLED_IMAGE = 27;
+static const uint32_t OP_TYPE_ARRAY = 28;
+static const uint32_t OP_TYPE_RUNTIME_ARRAY = 29;
+static const uint32_t OP_TYPE_STRUCT = 30;
+static const uint32_t OP_TYPE_POINTER = 32;
+static const uint32_t OP_CONSTANT = 43;
+static const uint32_t OP_SPEC_CONSTANT = 50;
+static const uint32_t OP_VARIABLE = 59;
+static const uint32_t OP_DECORATE = 71;
+static const uint32_t OP_MEMBER_DECORATE = 72;
+
+static const uint32_t DECORATION_BLOCK = 2;
+static const uint32_t DECORATION_BUFFER_BLOCK = 3;
+static const uint32_t DECORATION_ARRAY_STRIDE = 6;
+static const uint32_t DECORATION_MATRIX_STRIDE = 7;
+static const uint32_t DECORATION_BUILT_IN = 11;
+static const uint32_t DECORATION_LOCATION = 30;
+static const uint32_t DECORATION_BINDING = 33;
+static const uint32_t DECORATION_DESCRIPTOR_SET = 34;
+static const uint32_t DECORATION_OFFSET = 35;
+
+static const uint32_t STORAGE_UNIFORM_CONSTANT = 0;
+static const uint32_t STORAGE_INPUT = 1;
+static const uint32_t STORAGE_UNIFORM = 2;
+static const uint32_t STORAGE_PUSH_CONSTANT = 9;
+static const uint32_t STORAGE_STORAGE_BUFFER = 12;
+
+static const uint32_t DIM_BUFFER = 5;
+static const uint32_t DIM_SUBPASS_DATA = 6;
+
+static const uint32_t UNSET = UINT32_MAX;
+
+//аIDµϢ
+struct SpirvId {
+	uint32_t opcode = 0;
+	std::vector<uint32_t> operands;	//ID֮Ĳ
+	std::string name;
+	uint32_t set = UNSET;
+	uint32_t binding = UNSET;
+	uint32_t location = UNSET;
+	uint32_t arrayStride = 0;
+	bool builtIn = false;
+	bool block = false;
+	bool bufferBlock = false;
+	std::vector<uint32_t> memberOffsets;
+	std::vector<uint32_t> memberMatrixStrides;
+	uint32_t constant = 0;
+	uint32_t storageClass = 0;	//OpVariableĴ洢
+	uint32_t typeID = 0;	//OpVariableOpConstantĽ
+};
+
+static std::string readString(const uint32_t* words, uint32_t wordCount) {
+	const char* chars = reinterpret_cast<const char*>(words);
+	return std::string(chars, strnlen(chars, wordCount * sizeof(uint32_t)));
+}
+
+static VkShaderStageFlagBits executionModelStage(uint32_t executionModel) {
+	switch (executionModel) {
+	case 0: return VK_SHADER_STAGE_VERTEX_BIT;
+	case 1: return VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT;
+	case 2: return VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT;
+	case 3: return VK_SHADER_STAGE_GEOMETRY_BIT;
+	case 4: return VK_SHADER_STAGE_FRAGMENT_BIT;
+	case 5: return VK_SHADER_STAGE_COMPUTE_BIT;
+	case 5267: case 5364: return VK_SHADER_STAGE_TASK_BIT_EXT;	//NVEXT
+	case 5268: case 5365: return VK_SHADER_STAGE_MESH_BIT_EXT;
+	default: throw std::runtime_error("failed to reflect shader: unsupported execution model!");
+	}
+}
+
+//std140/std430ʵռõֽṹȡһԱĩβ
+static uint32_t typeSize(const std::vector<SpirvId>& ids, uint32_t typeID, uint32_t matrixStride) {
+	const SpirvId& type = ids[typeID];
+	switch (type.opcode) {
+	case OP_TYPE_INT:
+	case OP_TYPE_FLOAT:
+		return type.operands[0] / 8;
+	case OP_TYPE_VECTOR:
+		return typeSize(ids, type.operands[0], 0) * type.operands[1];
+	case OP_TYPE_MATRIX:
+		return (matrixStride > 0 ? matrixStride : typeSize(ids, type.operands[0], 0)) * type.operands[1];
+	case OP_TYPE_ARRAY:
+		return type.arrayStride * ids[type.operands[1]].constant;
+	case OP_TYPE_STRUCT: {
+		uint32_t size = 0;
+		for (size_t m = 0; m < type.operands.size(); m++) {
+			uint32_t offset = m < type.memberOffsets.size() ? type.memberOffsets[m] : 0;
+			uint32_t stride = m < type.memberMatrixStrides.size() ? type.memberMatrixStrides[m] : 0;
+			size = std::max(size, offset + typeSize(ids, type.operands[m], stride));
+		}
+		return size;
+	}
+	default:
+		throw std::runtime_error("failed to reflect shader: unsupported type in push constant block!");
+	}
+}
+
+static VkFormat vertexInputFormat(const std::vector<SpirvId>& ids, uint32_t typeID) {
+	const SpirvId& type = ids[typeID];
+	uint32_t componentNum = 1;
+	const SpirvId* component = &type;
+	if (type.opcode == OP_TYPE_VECTOR) {
+		componentNum = type.operands[1];
+		component = &ids[type.operands[0]];
+	}
+	if ((component->opcode != OP_TYPE_FLOAT && component->opcode != OP_TYPE_INT) || component->operands[0] != 32 || componentNum < 1 || componentNum > 4) {
+		throw std::runtime_error("failed to reflect shader: unsupported vertex input type!");
+	}
+	static const VkFormat floatFormats[4] = { VK_FORMAT_R32_SFLOAT, VK_FORMAT_R32G32_SFLOAT, VK_FORMAT_R32G32B32_SFLOAT, VK_FORMAT_R32G32B32A32_SFLOAT };
+	static const VkFormat intFormats[4] = { VK_FORMAT_R32_SINT, VK_FORMAT_R32G32_SINT, VK_FORMAT_R32G32B32_SINT, VK_FORMAT_R32G32B32A32_SINT };
+	static const VkFormat uintFormats[4] = { VK_FORMAT_R32_UINT, VK_FORMAT_R32G32_UINT, VK_FORMAT_R32G32B32_UINT, VK_FORMAT_R32G32B32A32_UINT };
+	if (component->opcode == OP_TYPE_FLOAT) {
+		return floatFormats[componentNum - 1];
+	}
+	return component->operands[1] ? intFormats[componentNum - 1] : uintFormats[componentNum - 1];
+}
+
+ShaderReflection myShaderReflection::reflect(const std::vector<char>& code) {
+
+	if (code.size() < 5 * sizeof(uint32_t) || code.size() % sizeof(uint32_t) != 0) {
+		throw std::runtime_error("failed to reflect shader: code is not SPIR-V!");
+	}
+	std::vector<uint32_t> words(code.size() / sizeof(uint32_t));
+	memcpy(words.data(), code.data(), code.size());
+	if (words[0] != SPIRV_MAGIC) {
+		throw std::runtime_error("failed to reflect shader: code is not SPIR-V!");
+	}
+
+	//ͷ4ΪIDϽ磬нIDС
+	uint32_t idBound = words[3];
+	std::vector<SpirvId> ids(idBound);
+	std::vector<uint32_t> variables;
+	bool entryPointFound = false;
+	ShaderReflection reflection;
+
+	auto checkID = [idBound](uint32_t id) {
+		if (id >= idBound) {
+			throw std::runtime_error("failed to reflect shader: id out of bound!");
+		}
+		return id;
+	};
+
+	size_t i = 5;
+	while (i < words.size()) {
+
+		uint32_t opcode = words[i] & 0xFFFF;
+		uint32_t wordCount = words[i] >> 16;
+		if (wordCount == 0 || i + wordCount > words.size()) {
+			throw std::runtime_error("failed to reflect shader: truncated instruction!");
+		}
+		const uint32_t* op = &words[i + 1];
+		uint32_t operandNum = wordCount - 1;
+
+		switch (opcode) {
+		case OP_NAME:
+			if (operandNum >= 2) {
+				ids[checkID(op[0])].name = readString(op + 1, operandNum - 1);
+			}
+			break;
+		case OP_ENTRY_POINT:
+			//һģֻϵһڵ
+			if (!entryPointFound && operandNum >= 1) {
+				reflection.stage = executionModelStage(op[0]);
+				entryPointFound = true;
+			}
+			break;
+		case OP_DECORATE: {
+			if (operandNum < 2) {
+				break;
+			}
+			SpirvId& target = ids[checkID(op[0])];
+			uint32_t literal = operandNum >= 3 ? op[2] : 0;
+			switch (op[1]) {
+			case DECORATION_BLOCK: target.block = true; break;
+			case DECORATION_BUFFER_BLOCK: target.bufferBlock = true; break;
+			case DECORATION_ARRAY_STRIDE: target.arrayStride = literal; break;
+			case DECORATION_BUILT_IN: target.builtIn = true; break;
+			case DECORATION_LOCATION: target.location = literal; break;
+			case DECORATION_BINDING: target.binding = literal; break;
+			case DECORATION_DESCRIPTOR_SET: target.set = literal; break;
+			}
+			break;
+		}
+		case OP_MEMBER_DECORATE: {
+			if (operandNum < 4) {
+				break;
+			}
+			SpirvId& target = ids[checkID(op[0])];
+			uint32_t member = op[1];
+			if (op[2] == DECORATION_OFFSET) {
+				target.memberOffsets.resize(std::max<size_t>(target.memberOffsets.size(), member + 1), 0);
+				target.memberOffsets[member] = op[3];
+			}
+			else if (op[2] == DECORATION_MATRIX_STRIDE) {
+				target.memberMatrixStrides.resize(std::max<size_t>(target.memberMatrixStrides.size(), member + 1), 0);
+				target.memberMatrixStrides[member] = op[3];
+			}
+			break;
+		}
+		case OP_TYPE_INT:
+		case OP_TYPE_FLOAT:
+		case OP_TYPE_VECTOR:
+		case OP_TYPE_MATRIX:
+		case OP_TYPE_IMAGE:
+		case OP_TYPE_SAMPLER:
+		case OP_TYPE_SAMPLED_IMAGE:
+		case OP_TYPE_ARRAY:
+		case OP_TYPE_RUNTIME_ARRAY:
+		case OP_TYPE_STRUCT:
+		case OP_TYPE_POINTER: {
+			if (operandNum < 1) {
+				break;
+			}
+			SpirvId& type = ids[checkID(op[0])];
+			type.opcode = opcode;
+			type.operands.assign(op + 1, op + operandNum);
+			break;
+		}
+		case OP_CONSTANT:
+		case OP_SPEC_CONSTANT: {	//ػȰĬֵ㣬ĳɴʱػϢ
+			if (operandNum < 3) {
+				break;
+			}
+			SpirvId& constant = ids[checkID(op[1])];
+			constant.opcode = opcode;
+			constant.typeID = op[0];
+			constant.constant = op[2];	//ֻȡ鳤ȣ32λ
+			break;
+		}
+		case OP_VARIABLE: {
+			if (operandNum < 3) {
+				break;
+			}
+			SpirvId& variable = ids[checkID(op[1])];
+			variable.opcode = opcode;
+			variable.typeID = checkID(op[0]);
+			variable.storageClass = op[2];
+			variables.push_back(op[1]);
+			break;
+		}
+		}
+		i += wordCount;
+
+	}
+
+	if (!entryPointFound) {
+		throw std::runtime_error("failed to reflect shader: no entry point!");
+	}
+
+	for (uint32_t variableID : variables) {
+
+		const SpirvId& variable = ids[variableID];
+		const SpirvId& pointer = ids[variable.typeID];
+		if (pointer.opcode != OP_TYPE_POINTER || pointer.operands.size() < 2) {
+			continue;
+		}
+		uint32_t typeID = checkID(pointer.operands[1]);
+
+		if (variable.storageClass == STORAGE_PUSH_CONSTANT) {
+			const SpirvId& block = ids[typeID];
+			if (block.opcode != OP_TYPE_STRUCT) {
+				continue;
+			}
+			uint32_t offset = block.memberOffsets.empty() ? 0 : *std::min_element(block.memberOffsets.begin(), block.memberOffsets.end());
+			uint32_t end = typeSize(ids, typeID, 0);
+			//VulkanҪΧ4ֽڶ
+			reflection.pushConstantOffset = offset & ~3u;
+			reflection.pushConstantSize = ((end + 3) & ~3u) - reflection.pushConstantOffset;
+			continue;
+		}
+
+		if (variable.storageClass == STORAGE_INPUT) {
+			if (reflection.stage != VK_SHADER_STAGE_VERTEX_BIT || variable.builtIn || variable.location == UNSET) {
+				continue;
+			}
+			const SpirvId& type = ids[typeID];
+			if (type.opcode == OP_TYPE_STRUCT && type.operands.empty()) {
+				continue;
+			}
+			reflection.vertexInputs.push_back({ variable.location, vertexInputFormat(ids, typeID), variable.name });
+			continue;
+		}
+
+		if (variable.storageClass != STORAGE_UNIFORM_CONSTANT && variable.storageClass != STORAGE_UNIFORM && variable.storageClass != STORAGE_STORAGE_BUFFER) {
+			continue;
+		}
+		if (variable.set == UNSET || variable.binding == UNSET) {
+			continue;
+		}
+
+		//飬鳤һ
+		uint32_t count = 1;
+		const SpirvId* type = &ids[typeID];
+		if (type->opcode == OP_TYPE_RUNTIME_ARRAY) {
+			throw std::runtime_error("failed to reflect shader: unbounded descriptor array " + variable.name + " is not supported!");
+		}
+		if (type->opcode == OP_TYPE_ARRAY) {
+			count = ids[checkID(type->operands[1])].constant;
+			type = &ids[checkID(type->operands[0])];
+		}
+
+		VkDescriptorType descriptorType;
+		if (variable.storageClass == STORAGE_STORAGE_BUFFER) {
+			descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		}
+		else if (variable.storageClass == STORAGE_UNIFORM) {
+			//ɰ汾SPIR-Vstorage bufferUniform洢BufferBlock
+			descriptorType = type->bufferBlock ? VK_DESCRIPTOR_TYPE_STORAGE_BUFFER : VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+		}
+		else if (type->opcode == OP_TYPE_SAMPLED_IMAGE) {
+			const SpirvId& image = ids[checkID(type->operands[0])];
+			descriptorType = image.operands.size() >= 2 && image.operands[1] == DIM_BUFFER ? VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER : VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+		}
+		else if (type->opcode == OP_TYPE_SAMPLER) {
+			descriptorType = VK_DESCRIPTOR_TYPE_SAMPLER;
+		}
+		else if (type->opcode == OP_TYPE_IMAGE && type->operands.size() >= 6) {
+			//͡άȡȡ顢زsampled1Ͳһã2Ϊ洢ͼ
+			uint32_t dim = type->operands[1];
+			uint32_t sampled = type->operands[5];
+			if (dim == DIM_SUBPASS_DATA) {
+				descriptorType = VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT;
+			}
+			else if (dim == DIM_BUFFER) {
+				descriptorType = sampled == 2 ? VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER : VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER;
+			}
+			else {
+				descriptorType = sampled == 2 ? VK_DESCRIPTOR_TYPE_STORAGE_IMAGE : VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+			}
+		}
+		else {
+			continue;
+		}
+
+		reflection.bindings.push_back({ variable.set, variable.binding, descriptorType, count, variable.name });
+
+	}
+
+	std::sort(reflection.bindings.begin(), reflection.bindings.end(), [](const ReflectedBinding& a, const ReflectedBinding& b) {
+		return a.set != b.set ? a.set < b.set : a.binding < b.binding;
+	});
+	std::sort(reflection.vertexInputs.begin(), reflection.vertexInputs.end(), [](const ReflectedVertexInput& a, const ReflectedVertexInput& b) {
+		return a.location < b.location;
+	});
+	return reflection;
+
+}
+
+void myShaderReflection::mergeBindings(std::vector<VkDescriptorSetLayoutBinding>& dst, const std::vector<VkDescriptorSetLayoutBinding>& src) {
+
+	for (const VkDescriptorSetLayoutBinding& binding : src) {
+		auto it = std::find_if(dst.begin(), dst.end(), [&binding](const VkDescriptorSetLayoutBinding& other) {
+			return other.binding == binding.binding;
+		});
+		if (it == dst.end()) {
+			dst.push_back(binding);
+			continue;
+		}
+		if (it->descriptorType != binding.descriptorType || it->descriptorCount != binding.descriptorCount) {
+			throw std::runtime_error("failed to merge shader reflection: binding " + std::to_string(binding.binding) + " differs between stages!");
+		}
+		it->stageFlags |= binding.stageFlags;
+	}
+	std::sort(dst.begin(), dst.end(), [](const VkDescriptorSetLayoutBinding& a, const VkDescriptorSetLayoutBinding& b) {
+		return a.binding < b.binding;
+	});
+
+}
+
+ReflectedPipelineLayout myShaderReflection::merge(const std::vector<const ShaderReflection*>& stages) {
+
+	ReflectedPipelineLayout layout;
+	for (const ShaderReflection* stage : stages) {
+
+		std::vector<std::vector<VkDescriptorSetLayoutBinding>> stageSets;
+		for (const ReflectedBinding& reflected : stage->bindings) {
+			if (reflected.set >= stageSets.size()) {
+				stageSets.resize(reflected.set + 1);
+			}
+			VkDescriptorSetLayoutBinding binding{};
+			binding.binding = reflected.binding;
+			binding.descriptorType = reflected.type;
+			binding.descriptorCount = reflected.count;
+			binding.stageFlags = stage->stage;
+			binding.pImmutableSamplers = nullptr;
+			stageSets[reflected.set].push_back(binding);
+		}
+		if (stageSets.size() > layout.sets.size()) {
+			layout.sets.resize(stageSets.size());
+		}
+		for (size_t s = 0; s < stageSets.size(); s++) {
+			mergeBindings(layout.sets[s], stageSets[s]);
+		}
+
+		if (stage->pushConstantSize > 0) {
+			//ÿ׶ֻܳһΧΧȫͬĽ׶κϳһ
+			auto it = std::find_if(layout.pushConstantRanges.begin(), layout.pushConstantRanges.end(), [stage](const VkPushConstantRange& range) {
+				return range.offset == stage->pushConstantOffset && range.size == stage->pushConstantSize;
+			});
+			if (it != layout.pushConstantRanges.end()) {
+				it->stageFlags |= stage->stage;
+			}
+			else {
+				layout.pushConstantRanges.push_back({ static_cast<VkShaderStageFlags>(stage->stage), stage->pushConstantOffset, stage->pushConstantSize });
+			}
+		}
+
+		if (stage->stage == VK_SHADER_STAGE_VERTEX_BIT) {
+			layout.vertexInputs = stage->vertexInputs;
+		}
+
+	}
+	return layout;
+
+}
+
+std::vector<VkVertexInputAttributeDescription> myShaderReflection::filterVertexAttributes(const std::vector<ReflectedVertexInput>& inputs, const std::vector<VkVertexInputAttributeDescription>& attributes) {
+
+	std::vector<VkVertexInputAttributeDescription> used;
+	for (const ReflectedVertexInput& input : inputs) {
+		auto it = std::find_if(attributes.begin(), attributes.end(), [&input](const VkVertexInputAttributeDescription& attribute) {
+			return attribute.location == input.location;
+		});
+		if (it == attributes.end()) {
+			throw std::runtime_error("failed to match vertex input " + input.name + ": no vertex attribute at location " + std::to_string(input.location) + "!");
+		}
+		if (it->format != input.format) {
+			throw std::runtime_error("failed to match vertex input " + input.name + ": format differs from the vertex attribute!");
+		}
+		used.push_back(*it);
+	}
+	return used;
+
+}
@@ -0,0 +1,66 @@
+#pragma once
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <algorithm>
+#include <stdexcept>
+
+#ifndef MY_SHADER_REFLECTION
+#define MY_SHADER_REFLECTION
+
+//ɫһ
+struct ReflectedBinding {
+	uint32_t set;
+	uint32_t binding;
+	VkDescriptorType type;
+	uint32_t count;	//ĳȣʱΪ1
+	std::string name;
+};
+
+//ɫһ룬ñgl_VertexIndexȣ
+struct ReflectedVertexInput {
+	uint32_t location;
+	VkFormat format;
+	std::string name;
+};
+
+//һɫģ鷴Ľӿ
+struct ShaderReflection {
+	VkShaderStageFlagBits stage = VK_SHADER_STAGE_VERTEX_BIT;
+	std::vector<ReflectedBinding> bindings;
+	//push constantõķΧsizeΪ0ʾû
+	uint32_t pushConstantOffset = 0;
+	uint32_t pushConstantSize = 0;
+	std::vector<ReflectedVertexInput> vertexInputs;	//location
+};
+
+//һн׶κϲĲ
+struct ReflectedPipelineLayout {
+	std::vector<std::vector<VkDescriptorSetLayoutBinding>> sets;	//sets[s]Ϊset sİ󶨣bindingɫûõsetΪ
+	std::vector<VkPushConstantRange> pushConstantRanges;
+	std::vector<ReflectedVertexInput> vertexInputs;
+};
+
+//ֱӽSPIR-Vָֻpush constantͶҪЩָⲿķ
+class myShaderReflection {
+
+public:
+
+	//codeǺϷSPIR-Võ˲ֵ֧ȣʱ׳쳣
+	static ShaderReflection reflect(const std::vector<char>& code);
+
+	//ͬһڲͬ׶εͺһ£׳쳣׶α־ȡ
+	static ReflectedPipelineLayout merge(const std::vector<const ShaderReflection*>& stages);
+	//srcİ󶨲dstڼ߹õset
+	static void mergeBindings(std::vector<VkDescriptorSetLayoutBinding>& dst, const std::vector<VkDescriptorSetLayoutBinding>& src);
+
+	//C++߶壨ƫ󶨵ֻɫõlocationʽǷһ
+	static std::vector<VkVertexInputAttributeDescription> filterVertexAttributes(const std::vector<ReflectedVertexInput>& inputs, const std::vector<VkVertexInputAttributeDescription>& attributes);
+
+};
+
+#endif
@@ -0,0 +1,377 @@
+#include "mySimplifier.h"
+#include "myProfiler.h"
+
+#include <unordered_map>
+#include <unordered_set>
+#include <algorithm>
+#include <numeric>
+#include <cmath>
+
+#define GLM_ENABLE_EXPERIMENTAL
+#include <glm/gtx/hash.hpp>
+
+//ߺUV仯ȨأԱ߳ƽλõ
+static const float NORMAL_WEIGHT = 0.5f;
+static const float UV_WEIGHT = 1.0f;
+//߽ͽӷϴֱεԼƽȨأԽԽ
+static const float BOUNDARY_WEIGHT = 10.0f;
+
+enum VertexKind { KIND_MANIFOLD, KIND_BORDER, KIND_SEAM, KIND_LOCKED };
+
+//ԳƾֻǣQ(p) = p^T A p + 2 b^T p + cȨغǵƽƽļȨƽ
+struct Quadric {
+
+	float a00 = 0.0f, a01 = 0.0f, a02 = 0.0f, a11 = 0.0f, a12 = 0.0f, a22 = 0.0f;
+	float b0 = 0.0f, b1 = 0.0f, b2 = 0.0f;
+	float c = 0.0f;
+	float weight = 0.0f;
+
+	//ƽΪdot(normal, p) + d = 0normalѹһ
+	void addPlane(const glm::vec3& normal, float d, float w) {
+		a00 += w * normal.x * normal.x;
+		a01 += w * normal.x * normal.y;
+		a02 += w * normal.x * normal.z;
+		a11 += w * normal.y * normal.y;
+		a12 += w * normal.y * normal.z;
+		a22 += w * normal.z * normal.z;
+		b0 += w * normal.x * d;
+		b1 += w * normal.y * d;
+		b2 += w * normal.z * d;
+		c += w * d * d;
+		weight += w;
+	}
+
+	void add(const Quadric& other) {
+		a00 += other.a00; a01 += other.a01; a02 += other.a02;
+		a11 += other.a11; a12 += other.a12; a22 += other.a22;
+		b0 += other.b0; b1 += other.b1; b2 += other.b2;
+		c += other.c;
+		weight += other.weight;
+	}
+
+	float error(const glm::vec3& p) const {
+		if (weight <= 0.0f) {
+			return 0.0f;
+		}
+		float rx = a00 * p.x + a01 * p.y + a02 * p.z;
+		float ry = a01 * p.x + a11 * p.y + a12 * p.z;
+		float rz = a02 * p.x + a12 * p.y + a22 * p.z;
+		float e = p.x * rx + p.y * ry + p.z * rz + 2.0f * (b0 * p.x + b1 * p.y + b2 * p.z) + c;
+		return std::fabs(e) / weight;
+	}
+
+};
+
+struct Collapse {
+	uint32_t from;
+	uint32_t to;
+	float cost;
+};
+
+static uint64_t edgeKey(uint32_t a, uint32_t b) {
+	return (static_cast<uint64_t>(a) << 32) | b;
+}
+
+std::vector<uint32_t> mySimplifier::simplify(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices, size_t targetIndexCount, float targetError, float& resultError) {
+
+	MY_PROFILE_FUNCTION();
+
+	resultError = 0.0f;
+	std::vector<uint32_t> result = indices;
+	uint32_t vertexNum = static_cast<uint32_t>(vertices.size());
+	if (result.size() <= targetIndexCount) {
+		return result;
+	}
+
+	//λͬĶ㣨UVӷ߷߲Ϊһ飬groupsΪһ㣬siblingsͬĶ㴮ɻ
+	std::vector<uint32_t> groups(vertexNum);
+	std::vector<uint32_t> siblings(vertexNum);
+	std::vector<uint32_t> groupSizes(vertexNum, 0);
+	std::unordered_map<glm::vec3, uint32_t> positionMap;
+	for (uint32_t v = 0; v < vertexNum; v++) {
+		auto it = positionMap.find(vertices[v].pos);
+		if (it == positionMap.end()) {
+			positionMap[vertices[v].pos] = v;
+			groups[v] = v;
+			siblings[v] = v;
+		}
+		else {
+			uint32_t group = it->second;
+			groups[v] = group;
+			siblings[v] = siblings[group];
+			siblings[group] = v;
+		}
+		groupSizes[groups[v]]++;
+	}
+
+	//ÿλõĶεƽ水Ȩŵıߣ߽ͽӷ죩ټһֱεƽ
+	std::unordered_set<uint64_t> vertexEdges;
+	for (size_t i = 0; i < result.size(); i += 3) {
+		for (uint32_t k = 0; k < 3; k++) {
+			vertexEdges.insert(edgeKey(result[i + k], result[i + (k + 1) % 3]));
+		}
+	}
+	std::vector<Quadric> quadrics(vertexNum);
+	for (size_t i = 0; i < result.size(); i += 3) {
+		glm::vec3 p[3] = { vertices[result[i]].pos, vertices[result[i + 1]].pos, vertices[result[i + 2]].pos };
+		glm::vec3 normal = glm::cross(p[1] - p[0], p[2] - p[0]);
+		float length = glm::length(normal);
+		if (length == 0.0f) {
+			continue;
+		}
+		normal /= length;
+		float d = -glm::dot(normal, p[0]);
+		for (uint32_t k = 0; k < 3; k++) {
+			quadrics[groups[result[i + k]]].addPlane(normal, d, length * 0.5f);
+		}
+		for (uint32_t k = 0; k < 3; k++) {
+			uint32_t a = result[i + k];
+			uint32_t b = result[i + (k + 1) % 3];
+			if (vertexEdges.count(edgeKey(b, a))) {
+				continue;
+			}
+			glm::vec3 edge = p[(k + 1) % 3] - p[k];
+			glm::vec3 edgeNormal = glm::cross(edge, normal);
+			float edgeLength = glm::length(edgeNormal);
+			if (edgeLength == 0.0f) {
+				continue;
+			}
+			edgeNormal /= edgeLength;
+			float edgeD = -glm::dot(edgeNormal, p[k]);
+			float w = BOUNDARY_WEIGHT * glm::dot(edge, edge);
+			quadrics[groups[a]].addPlane(edgeNormal, edgeD, w);
+			quadrics[groups[b]].addPlane(edgeNormal, edgeD, w);
+		}
+	}
+
+	std::vector<VertexKind> kinds(vertexNum);
+	std::vector<uint8_t> openOut(vertexNum), openIn(vertexNum), borderOut(vertexNum), borderIn(vertexNum);
+	std::unordered_set<uint64_t> positionEdges;
+	std::vector<uint32_t> adjacencyOffsets(vertexNum + 1);
+	std::vector<uint32_t> adjacency;
+	std::vector<uint32_t> remap(vertexNum);
+	std::vector<uint8_t> touched(vertexNum);
+	std::vector<Collapse> collapses;
+	size_t targetTriangleNum = targetIndexCount / 3;
+	float maxError = targetError * targetError;
+	float appliedError = 0.0f;
+
+	auto isOpen = [&](uint32_t a, uint32_t b) {
+		return vertexEdges.count(edgeKey(a, b)) != vertexEdges.count(edgeKey(b, a));
+	};
+	auto isBorder = [&](uint32_t a, uint32_t b) {
+		uint32_t ga = groups[a];
+		uint32_t gb = groups[b];
+		return positionEdges.count(edgeKey(ga, gb)) != positionEdges.count(edgeKey(gb, ga));
+	};
+
+	auto canCollapse = [&](uint32_t from, uint32_t to) {
+		if (groups[from] == groups[to]) {
+			return false;
+		}
+		switch (kinds[from]) {
+		case KIND_MANIFOLD:
+			return true;
+		case KIND_BORDER:
+			return kinds[to] == KIND_BORDER && isBorder(from, to);
+		case KIND_SEAM: {
+			//һĶҲҪؽӷ̮toһ
+			uint32_t otherFrom = siblings[from];
+			uint32_t otherTo = siblings[to];
+			return kinds[to] == KIND_SEAM && isOpen(from, to) && isOpen(otherFrom, otherTo);
+		}
+		default:
+			return false;
+		}
+	};
+
+	auto attributeCost = [&](uint32_t from, uint32_t to) {
+		const Vertex& a = vertices[from];
+		const Vertex& b = vertices[to];
+		glm::vec3 normalDelta = a.normal - b.normal;
+		glm::vec2 uvDelta = a.texCoord - b.texCoord;
+		glm::vec3 edge = b.pos - a.pos;
+		return (NORMAL_WEIGHT * glm::dot(normalDelta, normalDelta) + UV_WEIGHT * glm::dot(uvDelta, uvDelta)) * glm::dot(edge, edge);
+	};
+
+	auto collapseCost = [&](uint32_t from, uint32_t to) {
+		float cost = quadrics[groups[from]].error(vertices[to].pos) + attributeCost(from, to);
+		if (kinds[from] == KIND_SEAM) {
+			cost = std::max(cost, quadrics[groups[from]].error(vertices[to].pos) + attributeCost(siblings[from], siblings[to]));
+		}
+		return cost;
+	};
+
+	//̮ڱϵηת̫ࣨ棩ʱ̮
+	auto flips = [&](uint32_t fromGroup, uint32_t toGroup, const glm::vec3& target) {
+		for (uint32_t a = adjacencyOffsets[fromGroup]; a < adjacencyOffsets[fromGroup + 1]; a++) {
+			size_t i = adjacency[a] * 3;
+			glm::vec3 p[3];
+			int32_t moved = -1;
+			bool collapsed = false;
+			for (uint32_t k = 0; k < 3; k++) {
+				uint32_t group = groups[result[i + k]];
+				collapsed |= group == toGroup;
+				if (group == fromGroup) {
+					moved = static_cast<int32_t>(k);
+				}
+				p[k] = vertices[result[i + k]].pos;
+			}
+			if (collapsed || moved < 0) {
+				continue;
+			}
+			glm::vec3 before = glm::cross(p[1] - p[0], p[2] - p[0]);
+			p[moved] = target;
+			glm::vec3 after = glm::cross(p[1] - p[0], p[2] - p[0]);
+			if (glm::dot(before, after) < 0.25f * glm::length(before) * glm::length(after)) {
+				return true;
+			}
+		}
+		return false;
+	};
+
+	//ÿһֻ̮ڵıߣ̮·ࡢֱۣﵽĿû̮ı
+	while (result.size() > targetIndexCount) {
+
+		size_t triangleNum = result.size() / 3;
+
+		vertexEdges.clear();
+		positionEdges.clear();
+		for (size_t i = 0; i < result.size(); i += 3) {
+			for (uint32_t k = 0; k < 3; k++) {
+				uint32_t a = result[i + k];
+				uint32_t b = result[i + (k + 1) % 3];
+				vertexEdges.insert(edgeKey(a, b));
+				positionEdges.insert(edgeKey(groups[a], groups[b]));
+			}
+		}
+
+		//߽綥ֻһһ߽ߣӷ춥ͬǽǵ߷Σס
+		std::fill(openOut.begin(), openOut.end(), 0);
+		std::fill(openIn.begin(), openIn.end(), 0);
+		std::fill(borderOut.begin(), borderOut.end(), 0);
+		std::fill(borderIn.begin(), borderIn.end(), 0);
+		for (uint64_t key : vertexEdges) {
+			uint32_t a = static_cast<uint32_t>(key >> 32);
+			uint32_t b = static_cast<uint32_t>(key & 0xFFFFFFFF);
+			if (vertexEdges.count(edgeKey(b, a))) {
+				continue;
+			}
+			openOut[a]++;
+			openIn[b]++;
+			if (!positionEdges.count(edgeKey(groups[b], groups[a]))) {
+				borderOut[a]++;
+				borderIn[b]++;
+			}
+		}
+		for (uint32_t v = 0; v < vertexNum; v++) {
+			uint32_t groupSize = groupSizes[groups[v]];
+			if (groupSize == 1) {
+				if (openOut[v] == 0 && openIn[v] == 0) {
+					kinds[v] = KIND_MANIFOLD;
+				}
+				else {
+					kinds[v] = borderOut[v] == 1 && borderIn[v] == 1 ? KIND_BORDER : KIND_LOCKED;
+				}
+			}
+			else if (groupSize == 2) {
+				kinds[v] = borderOut[v] == 0 && borderIn[v] == 0 && openOut[v] == 1 && openIn[v] == 1 ? KIND_SEAM : KIND_LOCKED;
+			}
+			else {
+				kinds[v] = KIND_LOCKED;
+			}
+		}
+		for (uint32_t v = 0; v < vertexNum; v++) {
+			if (kinds[v] == KIND_SEAM && kinds[siblings[v]] != KIND_SEAM) {
+				kinds[v] = KIND_LOCKED;
+			}
+		}
+
+		//λ鵽εڽӱ鷭
+		std::fill(adjacencyOffsets.begin(), adjacencyOffsets.end(), 0);
+		for (uint32_t index : result) {
+			adjacencyOffsets[groups[index] + 1]++;
+		}
+		for (uint32_t v = 0; v < vertexNum; v++) {
+			adjacencyOffsets[v + 1] += adjacencyOffsets[v];
+		}
+		adjacency.resize(result.size());
+		std::vector<uint32_t> adjacencyCursor(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+		for (size_t i = 0; i < result.size(); i++) {
+			adjacency[adjacencyCursor[groups[result[i]]]++] = static_cast<uint32_t>(i / 3);
+		}
+
+		collapses.clear();
+		for (size_t i = 0; i < result.size(); i += 3) {
+			for (uint32_t k = 0; k < 3; k++) {
+				uint32_t a = result[i + k];
+				uint32_t b = result[i + (k + 1) % 3];
+				if (canCollapse(a, b)) {
+					collapses.push_back({ a, b, collapseCost(a, b) });
+				}
+				if (canCollapse(b, a)) {
+					collapses.push_back({ b, a, collapseCost(b, a) });
+				}
+			}
+		}
+		std::sort(collapses.begin(), collapses.end(), [](const Collapse& a, const Collapse& b) { return a.cost < b.cost; });
+
+		std::iota(remap.begin(), remap.end(), 0);
+		std::fill(touched.begin(), touched.end(), 0);
+		uint32_t collapsedNum = 0;
+		for (const Collapse& collapse : collapses) {
+
+			if (collapse.cost > maxError || triangleNum <= targetTriangleNum) {
+				break;
+			}
+			uint32_t fromGroup = groups[collapse.from];
+			uint32_t toGroup = groups[collapse.to];
+			if (touched[fromGroup] || touched[toGroup] || flips(fromGroup, toGroup, vertices[collapse.to].pos)) {
+				continue;
+			}
+
+			remap[collapse.from] = collapse.to;
+			if (kinds[collapse.from] == KIND_SEAM) {
+				remap[siblings[collapse.from]] = siblings[collapse.to];
+			}
+			quadrics[toGroup].add(quadrics[fromGroup]);
+
+			//һڵĶһ鶼ٶõβ׼
+			for (uint32_t a = adjacencyOffsets[fromGroup]; a < adjacencyOffsets[fromGroup + 1]; a++) {
+				size_t i = adjacency[a] * 3;
+				bool removed = false;
+				for (uint32_t k = 0; k < 3; k++) {
+					touched[groups[result[i + k]]] = 1;
+					removed |= groups[result[i + k]] == toGroup;
+				}
+				triangleNum -= removed ? 1 : 0;
+			}
+			appliedError = std::max(appliedError, collapse.cost);
+			collapsedNum++;
+
+		}
+		if (collapsedNum == 0) {
+			break;
+		}
+
+		//ͬһλϵѾ˻ֱȥ
+		size_t writeIndex = 0;
+		for (size_t i = 0; i < result.size(); i += 3) {
+			uint32_t a = remap[result[i]];
+			uint32_t b = remap[result[i + 1]];
+			uint32_t c = remap[result[i + 2]];
+			if (groups[a] == groups[b] || groups[b] == groups[c] || groups[c] == groups[a]) {
+				continue;
+			}
+			result[writeIndex++] = a;
+			result[writeIndex++] = b;
+			result[writeIndex++] = c;
+		}
+		result.resize(writeIndex);
+
+	}
+
+	resultError = std::sqrt(appliedError);
+	return result;
+
+}
@@ -0,0 +1,26 @@
+#pragma once
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include <iostream>
+#include <vector>
+
+#include "structSet.h"
+
+#ifndef MY_SIMPLIFIER
+#define MY_SIMPLIFIER
+
+//ڶQEM򻯣̮еĶϣ¶㣬ԸLODһ㻺壬ֻͬ
+//UVӷλͬԲֻͬŽӷһ̮ŵıֻ߽ű߽̮ӷᱻ˺
+//̮Ĵ۳λõĶϷߺUVı仯Ա߳ƽԱ仯ҵĵطټ
+class mySimplifier {
+
+public:
+
+	//򻯵targetIndexCountһ̮targetErrorΪֹ
+	//ΪģͿռеľ룬resultErrorʵõ
+	static std::vector<uint32_t> simplify(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices, size_t targetIndexCount, float targetError, float& resultError);
+
+};
+
+#endif
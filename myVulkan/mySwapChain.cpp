@@ -1,21 +1,23 @@
 #include "mySwapChain.h"
 
-mySwapChain::mySwapChain(GLFWwindow* window, VkSurfaceKHR surface, VkDevice logicalDevice, SwapChainSupportDetails swapChainSupport, QueueFamilyIndices indices) {
+mySwapChain::mySwapChain(GLFWwindow* window, VkSurfaceKHR surface, VkDevice logicalDevice, SwapChainSupportDetails swapChainSupport, QueueFamilyIndices indices, VkPresentModeKHR requestedPresentMode, uint32_t requestedImageCount, VkSwapchainKHR oldSwapChain) {
 	this->window = window;
 	this->surface = surface;
 	this->logicalDevice = logicalDevice;
-	createSwapChain(swapChainSupport, indices);
+	createSwapChain(swapChainSupport, indices, requestedPresentMode, requestedImageCount, oldSwapChain);
 }
 
-void mySwapChain::createSwapChain(SwapChainSupportDetails swapChainSupport, QueueFamilyIndices indices) {
+void mySwapChain::createSwapChain(SwapChainSupportDetails swapChainSupport, QueueFamilyIndices indices, VkPresentModeKHR requestedPresentMode, uint32_t requestedImageCount, VkSwapchainKHR oldSwapChain) {
 
 	this->surfaceFormat = chooseSwapSurfaceFormat(swapChainSupport.formats);	//ҪsurfaceչʾͨԼɫʿռ
-	VkPresentModeKHR presentMode = chooseSwapPresentMode(swapChainSupport.presentModes);
+	this->presentMode = chooseSwapPresentMode(swapChainSupport.presentModes, requestedPresentMode);
 	this->extent = chooseSwapExtent(swapChainSupport.capabilities);
 
 	//Сͼȣȷֵ֧ͼֵ֧ͼСͼ+1
 	//maxImageCount=0ʾûƣطƣ޷
-	uint32_t imageCount = swapChainSupport.capabilities.minImageCount + 1;
+	//ͼԽ٣ʾǰ֡Խ٣ӳԽ̫ͣٵĻCPU/GPUᾭȴõͼ
+	uint32_t imageCount = requestedImageCount > 0 ? requestedImageCount : swapChainSupport.capabilities.minImageCount + 1;
+	imageCount = std::max(imageCount, swapChainSupport.capabilities.minImageCount);
 	if (swapChainSupport.capabilities.maxImageCount > 0 && imageCount > swapChainSupport.capabilities.maxImageCount) {
 		imageCount = swapChainSupport.capabilities.maxImageCount;
 	}
@@ -48,7 +50,7 @@ void mySwapChain::createSwapChain(SwapChainSupportDetails swapChainSupport, Queu
 	createInfo.compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
 	createInfo.presentMode = presentMode;
 	createInfo.clipped = VK_TRUE;
-	createInfo.oldSwapchain = VK_NULL_HANDLE;
+	createInfo.oldSwapchain = oldSwapChain;
 
 	if (vkCreateSwapchainKHR(logicalDevice, &createInfo, nullptr, &swapChain) != VK_SUCCESS) {
 		throw std::runtime_error("failed to create swap chain!");
@@ -108,20 +110,45 @@ VkSurfaceFormatKHR mySwapChain::chooseSwapSurfaceFormat(const std::vector<VkSurf
 
 }
 
-VkPresentModeKHR mySwapChain::chooseSwapPresentMode(const std::vector<VkPresentModeKHR>& availablePresentModes) {
+VkPresentModeKHR mySwapChain::chooseSwapPresentMode(const std::vector<VkPresentModeKHR>& availablePresentModes, VkPresentModeKHR requestedPresentMode) {
 	for (const auto& availablePresentMode : availablePresentModes) {
 		//γֻ棬ֱչʾ˫壬ȵ
 		//VK_PRESENT_MODE_IMMEDIATE_KHR Ⱦɺչʾÿֺ֡Ҫȴһ֡Ⱦɲ滻һ֡Ⱦʱʱͻֿ
 		//VK_PRESENT_MODE_FIFO_KHR ໺壬Ⱦɺύ浽Ļ壬̶ʱ䣨ʾˢʱ䣩ֵʾϡˣȾͻֹͣ
 		//VK_PRESENT_MODE_FIFO_RELAXED_KHR Ⱦɺύ浽Ļ壬һ֡ȾĽһ֡ˢºԴڣǰ֡ύ̳֣ôͿܵ¸
 		//VK_PRESENT_MODE_MAILBOX_KHR Ⱦɺύ浽Ļ壬̶ʱ䣨ʾˢʱ䣩ֵʾϡˣ滻Ļ
-		if (availablePresentMode == VK_PRESENT_MODE_MAILBOX_KHR) {
+		if (availablePresentMode == requestedPresentMode) {
 			return availablePresentMode;
 		}
 	}
+	std::cout << "requested present mode is not supported, falling back to FIFO" << std::endl;
 	return VK_PRESENT_MODE_FIFO_KHR;
 }
 
+void mySwapChain::retire(myDeletionQueue& deletionQueue, std::function<void(VkSwapchainKHR)> beforeDestroy) {
+	VkDevice logicalDevice = this->logicalDevice;
+	VkSwapchainKHR oldSwapChain = swapChain;
+	std::vector<VkImageView> imageViews;
+	imageViews.swap(swapChainImageViews);
+	deletionQueue.push([logicalDevice, oldSwapChain, imageViews, beforeDestroy]() {
+		for (VkImageView imageView : imageViews) {
+			vkDestroyImageView(logicalDevice, imageView, nullptr);
+		}
+		if (beforeDestroy) {
+			beforeDestroy(oldSwapChain);
+		}
+		vkDestroySwapchainKHR(logicalDevice, oldSwapChain, nullptr);
+	});
+	swapChain = VK_NULL_HANDLE;
+}
+
+void mySwapChain::clean() {
+	for (size_t i = 0; i < swapChainImageViews.size(); i++) {
+		vkDestroyImageView(logicalDevice, swapChainImageViews[i], nullptr);
+	}
+	vkDestroySwapchainKHR(logicalDevice, swapChain, nullptr);
+}
+
 //һ˵VulkanýͼֱʸڷֱȡǣЩڹ辶ѳͿķֱʾΪuint32_tֵֵ֧
 	//ĿģϣǿԼһЩķֱʣڷֱ˵ǲûʹڵȴ󣬱ԽȾŵһ
 	//Ҫֶһ½ͼֱʡ
@@ -7,6 +7,7 @@
 #include<iostream>
 
 #include "structSet.h"
+#include "myDeletionQueue.h"
 
 #ifndef MY_SWAPCHAIN
 #define MY_SWAPCHAIN
@@ -25,14 +26,22 @@ public:
 	VkExtent2D swapChainExtent;
 	VkSurfaceFormatKHR surfaceFormat;
 	VkExtent2D extent;
+	VkPresentModeKHR presentMode;
 
-	mySwapChain(GLFWwindow* window, VkSurfaceKHR surface, VkDevice logicalDevice, SwapChainSupportDetails swapChainSupport, QueueFamilyIndices indices);
-	void createSwapChain(SwapChainSupportDetails swapChainSupport, QueueFamilyIndices indices);
+	//requestedPresentMode֧ʱ˻FIFOrequestedImageCountΪ0ʱminImageCount + 1
+	//ؽʱɵĽԸԴɽѾύĳҲ
+	mySwapChain(GLFWwindow* window, VkSurfaceKHR surface, VkDevice logicalDevice, SwapChainSupportDetails swapChainSupport, QueueFamilyIndices indices, VkPresentModeKHR requestedPresentMode = VK_PRESENT_MODE_MAILBOX_KHR, uint32_t requestedImageCount = 0, VkSwapchainKHR oldSwapChain = VK_NULL_HANDLE);
+	void createSwapChain(SwapChainSupportDetails swapChainSupport, QueueFamilyIndices indices, VkPresentModeKHR requestedPresentMode, uint32_t requestedImageCount, VkSwapchainKHR oldSwapChain);
 	void createSwapChainImageViews();
 
 	VkSurfaceFormatKHR chooseSwapSurfaceFormat(const std::vector<VkSurfaceFormatKHR>& availableFormats);
-	VkPresentModeKHR chooseSwapPresentMode(const std::vector<VkPresentModeKHR>& availablePresentModes);
+	VkPresentModeKHR chooseSwapPresentMode(const std::vector<VkPresentModeKHR>& availablePresentModes, VkPresentModeKHR requestedPresentMode);
 	VkExtent2D chooseSwapExtent(const VkSurfaceCapabilitiesKHR& capabilities);
 
+	void clean();
+	//ؽ󣬾ɵĽͼͼdeletionQueueӳ
+	//beforeDestroyΪʱvkDestroySwapchainKHR֮ǰãȱ̲߳
+	void retire(myDeletionQueue& deletionQueue, std::function<void(VkSwapchainKHR)> beforeDestroy = nullptr);
+
 };
 #endif
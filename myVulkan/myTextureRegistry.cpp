@@ -0,0 +1,203 @@
+#include "myTextureRegistry.h"
+#include "myProfiler.h"
+
+#include <fstream>
+
+std::mutex myTextureRegistry::registryMutex;
+std::vector<RegisteredTexture> myTextureRegistry::textures;
+std::vector<uint32_t> myTextureRegistry::freeTextures;
+std::unordered_map<std::string, uint32_t> myTextureRegistry::pathIDs;
+std::vector<std::array<uint32_t, 2>> myTextureRegistry::pathTextures;
+std::unordered_map<uint64_t, uint32_t> myTextureRegistry::contentTextures[2];
+uint64_t myTextureRegistry::requestCount = 0;
+uint64_t myTextureRegistry::contentHitCount = 0;
+uint64_t myTextureRegistry::hashCollisionCount = 0;
+uint64_t myTextureRegistry::decodeCount = 0;
+
+uint32_t myTextureRegistry::acquire(const std::string& path, bool mipmapEnable) {
+
+	MY_PROFILE_FUNCTION();
+
+	std::lock_guard<std::mutex> lock(registryMutex);
+	requestCount++;
+
+	auto pathIt = pathIDs.find(path);
+	if (pathIt == pathIDs.end()) {
+		pathIt = pathIDs.emplace(path, static_cast<uint32_t>(pathTextures.size())).first;
+		pathTextures.push_back({ INVALID_TEXTURE, INVALID_TEXTURE });
+	}
+	uint32_t& pathTexture = pathTextures[pathIt->second][mipmapEnable];
+	if (pathTexture != INVALID_TEXTURE) {
+		textures[pathTexture].refCount++;
+		return pathTexture;
+	}
+
+	//·һγ֣ļݹϣļţϴʱٶһ
+	std::vector<unsigned char> fileData = readFile(path);
+	uint64_t contentHash = hashData(fileData.data(), fileData.size());
+
+	//ϣֻҺѡȷͬŹãȻײʱ
+	auto contentIt = contentTextures[mipmapEnable].find(contentHash);
+	if (contentIt != contentTextures[mipmapEnable].end()) {
+		if (sameContent(textures[contentIt->second], fileData)) {
+			contentHitCount++;
+			pathTexture = contentIt->second;
+			textures[pathTexture].refCount++;
+			return pathTexture;
+		}
+		hashCollisionCount++;
+	}
+
+	uint32_t texture;
+	if (!freeTextures.empty()) {
+		texture = freeTextures.back();
+		freeTextures.pop_back();
+	}
+	else {
+		texture = static_cast<uint32_t>(textures.size());
+		textures.emplace_back();
+	}
+	RegisteredTexture& registered = textures[texture];
+	registered.contentHash = contentHash;
+	registered.contentSize = fileData.size();
+	registered.mipmapEnable = mipmapEnable;
+	registered.refCount = 1;
+	registered.path = path;
+	registered.fileData = std::move(fileData);
+	registered.image.reset();
+	//ײʱעǸֻͨ·ҵ
+	contentTextures[mipmapEnable].emplace(contentHash, texture);
+	pathTexture = texture;
+	return texture;
+
+}
+
+void myTextureRegistry::addRef(uint32_t texture) {
+	std::lock_guard<std::mutex> lock(registryMutex);
+	textures[texture].refCount++;
+}
+
+void myTextureRegistry::release(uint32_t texture, myDeletionQueue* deletionQueue) {
+
+	std::lock_guard<std::mutex> lock(registryMutex);
+	RegisteredTexture& registered = textures[texture];
+	if (registered.refCount == 0) {
+		throw std::runtime_error("failed to release texture: texture is not acquired!");
+	}
+	if (--registered.refCount > 0) {
+		return;
+	}
+
+	//·ָҪ´ʱ¶ļ
+	for (std::array<uint32_t, 2>& pathTexture : pathTextures) {
+		if (pathTexture[registered.mipmapEnable] == texture) {
+			pathTexture[registered.mipmapEnable] = INVALID_TEXTURE;
+		}
+	}
+	auto contentIt = contentTextures[registered.mipmapEnable].find(registered.contentHash);
+	if (contentIt != contentTextures[registered.mipmapEnable].end() && contentIt->second == texture) {
+		contentTextures[registered.mipmapEnable].erase(contentIt);
+	}
+	destroyTexture(texture, deletionQueue);
+	freeTextures.push_back(texture);
+
+}
+
+uint32_t myTextureRegistry::upload(VkPhysicalDevice physicalDevice, VkDevice logicalDevice, VkQueue queue, VkCommandPool commandPool) {
+
+	MY_PROFILE_FUNCTION();
+
+	std::lock_guard<std::mutex> lock(registryMutex);
+	uint32_t uploadNum = 0;
+	for (RegisteredTexture& registered : textures) {
+		if (registered.refCount == 0 || registered.image) {
+			continue;
+		}
+		registered.image = std::make_unique<myImage>(registered.fileData, physicalDevice, logicalDevice, queue, commandPool, registered.mipmapEnable);
+		std::vector<unsigned char>().swap(registered.fileData);
+		decodeCount++;
+		uploadNum++;
+	}
+	return uploadNum;
+
+}
+
+myImage* myTextureRegistry::image(uint32_t texture) {
+	std::lock_guard<std::mutex> lock(registryMutex);
+	return textures[texture].image.get();
+}
+
+uint32_t myTextureRegistry::liveCount() {
+	std::lock_guard<std::mutex> lock(registryMutex);
+	return static_cast<uint32_t>(textures.size() - freeTextures.size());
+}
+
+void myTextureRegistry::printStats() {
+	std::lock_guard<std::mutex> lock(registryMutex);
+	std::cout << "textures: " << requestCount << " requests, " << pathIDs.size() << " unique paths, "
+		<< contentHitCount << " deduplicated by content, " << hashCollisionCount << " hash collisions, " << decodeCount << " decoded and uploaded" << std::endl;
+}
+
+void myTextureRegistry::clean() {
+	std::lock_guard<std::mutex> lock(registryMutex);
+	for (uint32_t i = 0; i < textures.size(); i++) {
+		destroyTexture(i, nullptr);
+	}
+	textures.clear();
+	freeTextures.clear();
+	pathIDs.clear();
+	pathTextures.clear();
+	contentTextures[0].clear();
+	contentTextures[1].clear();
+}
+
+//FNV-1amyPipelineCacheһ
+uint64_t myTextureRegistry::hashData(const unsigned char* data, size_t size) {
+	uint64_t hash = 14695981039346656037ull;
+	for (size_t i = 0; i < size; i++) {
+		hash ^= data[i];
+		hash *= 1099511628211ull;
+	}
+	return hash;
+}
+
+std::vector<unsigned char> myTextureRegistry::readFile(const std::string& path) {
+	std::ifstream file(path, std::ios::binary | std::ios::ate);
+	if (!file.is_open()) {
+		throw std::runtime_error("failed to open texture " + path + "!");
+	}
+	std::vector<unsigned char> fileData(static_cast<size_t>(file.tellg()));
+	file.seekg(0);
+	file.read(reinterpret_cast<char*>(fileData.data()), fileData.size());
+	return fileData;
+}
+
+bool myTextureRegistry::sameContent(const RegisteredTexture& registered, const std::vector<unsigned char>& fileData) {
+	if (registered.contentSize != fileData.size()) {
+		return false;
+	}
+	if (!registered.fileData.empty() || fileData.empty()) {
+		return registered.fileData == fileData;
+	}
+	//ԭļѾˣͲãɶϴһ
+	try {
+		return readFile(registered.path) == fileData;
+	}
+	catch (const std::exception&) {
+		return false;
+	}
+}
+
+void myTextureRegistry::destroyTexture(uint32_t texture, myDeletionQueue* deletionQueue) {
+	RegisteredTexture& registered = textures[texture];
+	if (registered.image) {
+		if (deletionQueue) {
+			registered.image->retire(*deletionQueue);
+		}
+		else {
+			registered.image->clean();
+		}
+		registered.image.reset();
+	}
+	std::vector<unsigned char>().swap(registered.fileData);
+}
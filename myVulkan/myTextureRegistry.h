@@ -0,0 +1,79 @@
+#pragma once
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <array>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+#include "myImage.h"
+#include "myDeletionQueue.h"
+
+#ifndef MY_TEXTURE_REGISTRY
+#define MY_TEXTURE_REGISTRY
+
+//һȥغͬļֻ롢ϴһ
+struct RegisteredTexture {
+	uint64_t contentHash;
+	size_t contentSize;	//ϣͬʱȱȴСֽڱȽ
+	bool mipmapEnable;
+	uint32_t refCount = 0;	//Ϊ0ʾIDţԱ·
+	std::string path;	//һעʱ·ֻڽͱ
+	std::vector<unsigned char> fileData;	//עʱΪϣѾˣϴʱֱӽ룬ϴͷ
+	std::unique_ptr<myImage> image;	//upload֮ǰΪ
+};
+
+//ȫֵģ͹
+//·פIDͬһ·ֻһļٰļݵĹϣȥأͬ·ͬģ͵ͬһͼһID
+//acquirereleaseɶԵãüʱͼ񽻸deletionQueue
+class myTextureRegistry {
+
+public:
+
+	static const uint32_t INVALID_TEXTURE = UINT32_MAX;
+
+	//mipmapEnableͬͬһͼļʱ׳쳣
+	static uint32_t acquire(const std::string& path, bool mipmapEnable);
+	static void addRef(uint32_t texture);
+	//deletionQueueΪʱֱ٣ֻ豸ʱ
+	static void release(uint32_t texture, myDeletionQueue* deletionQueue);
+
+	//лûϴͼ񣬷ϴ
+	static uint32_t upload(VkPhysicalDevice physicalDevice, VkDevice logicalDevice, VkQueue queue, VkCommandPool commandPool);
+	static myImage* image(uint32_t texture);
+	static uint32_t liveCount();
+
+	static void printStats();
+	//豸кʣµ
+	static void clean();
+
+private:
+
+	static std::mutex registryMutex;
+	static std::vector<RegisteredTexture> textures;
+	static std::vector<uint32_t> freeTextures;
+
+	//פ·pathTextures[pathID][mipmapEnable]ΪӦID
+	static std::unordered_map<std::string, uint32_t> pathIDs;
+	static std::vector<std::array<uint32_t, 2>> pathTextures;
+	static std::unordered_map<uint64_t, uint32_t> contentTextures[2];
+
+	static uint64_t requestCount;
+	static uint64_t contentHitCount;	//·ͬͬ
+	static uint64_t hashCollisionCount;	//ϣͬݲͬͬ
+	static uint64_t decodeCount;
+
+	static uint64_t hashData(const unsigned char* data, size_t size);
+	//ļʱ׳쳣
+	static std::vector<unsigned char> readFile(const std::string& path);
+	//ϴfileDataѾͷţʱ¶һעļȽ
+	static bool sameContent(const RegisteredTexture& registered, const std::vector<unsigned char>& fileData);
+	static void destroyTexture(uint32_t texture, myDeletionQueue* deletionQueue);
+
+};
+
+#endif
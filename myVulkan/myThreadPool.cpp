@@ -0,0 +1,83 @@
+#include "myThreadPool.h"
+#include "myProfiler.h"
+
+#include <iostream>
+
+myThreadPool::myThreadPool(uint32_t threadNum) {
+
+	if (threadNum == 0) {
+		uint32_t coreNum = std::thread::hardware_concurrency();
+		threadNum = coreNum > 1 ? coreNum - 1 : 1;
+	}
+
+	for (uint32_t i = 0; i < threadNum; i++) {
+		workers.emplace_back(&myThreadPool::workerLoop, this);
+	}
+
+}
+
+myThreadPool::~myThreadPool() {
+
+	{
+		std::unique_lock<std::mutex> lock(queueMutex);
+		stop = true;
+	}
+	taskCondition.notify_all();
+	for (std::thread& worker : workers) {
+		worker.join();
+	}
+
+}
+
+void myThreadPool::submit(std::function<void()> task) {
+
+	{
+		std::unique_lock<std::mutex> lock(queueMutex);
+		tasks.push(std::move(task));
+	}
+	taskCondition.notify_one();
+
+}
+
+void myThreadPool::waitIdle() {
+	std::unique_lock<std::mutex> lock(queueMutex);
+	idleCondition.wait(lock, [this] { return tasks.empty() && runningTaskNum == 0; });
+}
+
+void myThreadPool::workerLoop() {
+
+	MY_PROFILE_THREAD("worker");
+
+	while (true) {
+
+		std::function<void()> task;
+		{
+			std::unique_lock<std::mutex> lock(queueMutex);
+			taskCondition.wait(lock, [this] { return stop || !tasks.empty(); });
+			if (stop && tasks.empty()) {
+				return;
+			}
+			task = std::move(tasks.front());
+			tasks.pop();
+			runningTaskNum++;
+		}
+
+		//Լ쳣ֻ֤̲߳˳
+		try {
+			task();
+		}
+		catch (const std::exception& e) {
+			std::cerr << e.what() << std::endl;
+		}
+
+		{
+			std::unique_lock<std::mutex> lock(queueMutex);
+			runningTaskNum--;
+			if (tasks.empty() && runningTaskNum == 0) {
+				idleCondition.notify_all();
+			}
+		}
+
+	}
+
+}
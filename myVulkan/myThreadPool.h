@@ -0,0 +1,40 @@
+#pragma once
+
+#include <vector>
+#include <queue>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+#ifndef MY_THREAD_POOL
+#define MY_THREAD_POOL
+
+class myThreadPool {
+
+public:
+
+	//threadNumΪ0ʱCPUһ˸߳
+	myThreadPool(uint32_t threadNum = 0);
+	~myThreadPool();
+
+	void submit(std::function<void()> task);
+	void waitIdle();	//ȴִ
+
+	uint32_t threadCount() { return static_cast<uint32_t>(workers.size()); }
+
+private:
+
+	std::vector<std::thread> workers;
+	std::queue<std::function<void()>> tasks;
+	std::mutex queueMutex;
+	std::condition_variable taskCondition;
+	std::condition_variable idleCondition;
+	uint32_t runningTaskNum = 0;
+	bool stop = false;
+
+	void workerLoop();
+
+};
+
+#endif
@@ -0,0 +1,90 @@
+#include "myTimeline.h"
+
+myTimeline::myTimeline(VkDevice logicalDevice, uint64_t initialValue) {
+
+	this->logicalDevice = logicalDevice;
+	this->submittedValue = initialValue;
+
+	VkSemaphoreTypeCreateInfo timelineInfo{};
+	timelineInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+	timelineInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+	timelineInfo.initialValue = initialValue;
+
+	VkSemaphoreCreateInfo semaphoreInfo{};
+	semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+	semaphoreInfo.pNext = &timelineInfo;
+	if (vkCreateSemaphore(logicalDevice, &semaphoreInfo, nullptr, &semaphore) != VK_SUCCESS) {
+		throw std::runtime_error("failed to create timeline semaphore!");
+	}
+
+}
+
+uint64_t myTimeline::completedValue() {
+	uint64_t value = 0;
+	if (vkGetSemaphoreCounterValue(logicalDevice, semaphore, &value) != VK_SUCCESS) {
+		throw std::runtime_error("failed to get timeline semaphore value!");
+	}
+	return value;
+}
+
+bool myTimeline::isComplete(uint64_t value) {
+	return completedValue() >= value;
+}
+
+bool myTimeline::wait(uint64_t value, uint64_t timeout) {
+
+	VkSemaphoreWaitInfo waitInfo{};
+	waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+	waitInfo.semaphoreCount = 1;
+	waitInfo.pSemaphores = &semaphore;
+	waitInfo.pValues = &value;
+
+	VkResult result = vkWaitSemaphores(logicalDevice, &waitInfo, timeout);
+	if (result == VK_TIMEOUT) {
+		return false;
+	}
+	if (result != VK_SUCCESS) {
+		throw std::runtime_error("failed to wait for timeline semaphore!");
+	}
+	return true;
+
+}
+
+void myTimeline::markSubmitted(uint64_t value) {
+	uint64_t previous = submittedValue.load(std::memory_order_relaxed);
+	while (previous < value && !submittedValue.compare_exchange_weak(previous, value, std::memory_order_release, std::memory_order_relaxed)) {
+	}
+}
+
+void myTimeline::clean() {
+	vkDestroySemaphore(logicalDevice, semaphore, nullptr);
+}
+
+void SubmitSemaphores::addWait(VkSemaphore semaphore, VkPipelineStageFlags stage, uint64_t value) {
+	waitSemaphores.push_back(semaphore);
+	waitStages.push_back(stage);
+	waitValues.push_back(value);
+}
+
+void SubmitSemaphores::addSignal(VkSemaphore semaphore, uint64_t value) {
+	signalSemaphores.push_back(semaphore);
+	signalValues.push_back(value);
+}
+
+void SubmitSemaphores::fill(VkSubmitInfo& submitInfo) {
+
+	submitInfo.waitSemaphoreCount = static_cast<uint32_t>(waitSemaphores.size());
+	submitInfo.pWaitSemaphores = waitSemaphores.data();
+	submitInfo.pWaitDstStageMask = waitStages.data();
+	submitInfo.signalSemaphoreCount = static_cast<uint32_t>(signalSemaphores.size());
+	submitInfo.pSignalSemaphores = signalSemaphores.data();
+
+	timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+	timelineInfo.pNext = submitInfo.pNext;
+	timelineInfo.waitSemaphoreValueCount = static_cast<uint32_t>(waitValues.size());
+	timelineInfo.pWaitSemaphoreValues = waitValues.data();
+	timelineInfo.signalSemaphoreValueCount = static_cast<uint32_t>(signalValues.size());
+	timelineInfo.pSignalSemaphoreValues = signalValues.data();
+	submitInfo.pNext = &timelineInfo;
+
+}
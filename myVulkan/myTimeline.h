@@ -0,0 +1,54 @@
+#pragma once
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include <iostream>
+#include <vector>
+#include <atomic>
+#include <cstdint>
+
+#ifndef MY_TIMELINE
+#define MY_TIMELINE
+
+//timeline semaphoreķװֵֻGPUһͰֵƵύʱԼ
+//κϵͳϴʽءӳ١أ԰ֵȴ߲ѯȣҪÿ֡ÿ;һդ
+class myTimeline {
+
+public:
+
+	VkDevice logicalDevice;
+	VkSemaphore semaphore;
+	std::atomic<uint64_t> submittedValue{ 0 };	//ѾύСһﵽֵ
+
+	myTimeline(VkDevice logicalDevice, uint64_t initialValue = 0);
+
+	//GPUѾﵽֵ
+	uint64_t completedValue();
+	bool isComplete(uint64_t value);
+	//CPUϵȵvalueʱfalsetimeoutλΪns
+	bool wait(uint64_t value, uint64_t timeout = UINT64_MAX);
+	//¼һύʱƵvalue֮ǰύֵ
+	void markSubmitted(uint64_t value);
+
+	void clean();
+
+};
+
+//VkSubmitInfoϹҵĵȴźţֵźtimeline semaphoreԻãֵźֵᱻ
+struct SubmitSemaphores {
+
+	std::vector<VkSemaphore> waitSemaphores;
+	std::vector<VkPipelineStageFlags> waitStages;
+	std::vector<uint64_t> waitValues;
+	std::vector<VkSemaphore> signalSemaphores;
+	std::vector<uint64_t> signalValues;
+	VkTimelineSemaphoreSubmitInfo timelineInfo{};
+
+	void addWait(VkSemaphore semaphore, VkPipelineStageFlags stage, uint64_t value = 0);
+	void addSignal(VkSemaphore semaphore, uint64_t value = 0);
+	//submitInfoź֣SubmitSemaphoresҪvkQueueSubmit֮
+	void fill(VkSubmitInfo& submitInfo);
+
+};
+
+#endif
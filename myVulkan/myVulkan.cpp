@@ -15,15 +15,28 @@
 #include "myImage.h"
 #include "mySwapChain.h"
 #include "myModel.h"
+#include "myTextureRegistry.h"
 #include "myCamera.h"
 #include "myDescriptor.h"
+#include "myPipelineCache.h"
+#include "myShaderCache.h"
+#include "myPipelineManager.h"
+#include "myGpuProfiler.h"
+#include "myProfiler.h"
+#include "mySettings.h"
+#include "myFramePacer.h"
+#include "myPresentMonitor.h"
+#include "myDeletionQueue.h"
+#include "myTimeline.h"
+#include "myComputeScheduler.h"
+#include "myGpuCulling.h"
+#include "myBvh.h"
+#include "myRadixSort.h"
 
 
 const uint32_t WIDTH = 800;
 const uint32_t HEIGHT = 600;
 
-const int MAX_FRAMES_IN_FLIGHT = 2;
-
 //层主要是对vulkan函数的重载，比如vulkan有一个函数A，那么层1可以对这个函数进行重载，层2也可以，基本是上层对下层的重载，如层1可以对层2的进行重载
 //我们不关心层如何重载，我们只关心最后可以得到哪些功能
 //我们使用的下面的这个层的功能是debug的，是层可以有debug的功能而不是只能debug，虽然其他功能现在我还不知道
@@ -101,7 +114,11 @@ void scroll_callback(GLFWwindow* window, double xoffset, double yoffset)
 class HelloTriangleApplication {
 
 public:
+
+	HelloTriangleApplication(mySettings settings) : settings(settings), framePacer(settings.targetFrameTime) {}
+
 	void run() {
+		MY_PROFILE_THREAD("main");
 		initWindow();
 		initVulkan();
 		mainLoop();
@@ -110,6 +127,9 @@ public:
 
 private:
 
+	mySettings settings;
+	myFramePacer framePacer;
+
 	GLFWwindow* window;		//窗口
 
 	VkInstance instance;	//vulkan实例
@@ -121,40 +141,85 @@ private:
 
 	//SwapChain
 	std::unique_ptr<mySwapChain> my_swapChain;
+	std::unique_ptr<myPresentMonitor> my_presentMonitor;	//设备不支持present wait时为空
 
 	std::unique_ptr<myDescriptor> my_descriptor;
-	std::unordered_map<std::string, uint32_t> uniqueDescriptorSets;
+	//键为反射率和法线纹理的ID，纹理组合相同的mesh是同一个材质
+	std::unordered_map<uint64_t, uint32_t> uniqueMaterials;
+	std::vector<uint32_t> meshMaterials;	//每个mesh的材质序号，绘制时通过push constant传给着色器
+	//gBufferFrag里材质纹理数组的长度，作为特化常量传给管线；正常是所有材质的纹理数，退回每个材质一个集合时为2
+	uint32_t materialTextureNum = 0;
+	bool perMaterialDescriptorSets = false;
+	VkDescriptorSet frameUniformDescriptorSet = VK_NULL_HANDLE;	//这一帧的uniform集合，从帧槽位的临时池里分配
+	//从着色器反射出的布局，描述符集布局和管线布局都由它们生成；热重载只换模块，接口变了需要重启
+	ReflectedPipelineLayout gBufferReflection;
+	ReflectedPipelineLayout lightReflection;
 
 	VkRenderPass renderPass;
 	VkPipelineLayout gBufferPipelineLayout;
-	VkPipeline gBufferGraphicsPipeline;
 	VkPipelineLayout lightPipelineLayout;
-	VkPipeline lightGraphicsPipeline;
+	std::unique_ptr<myPipelineCache> my_pipelineCache;
+	std::unique_ptr<myShaderCache> my_shaderCache;
+	std::unique_ptr<myPipelineManager> my_pipelineManager;
+	uint32_t gBufferPipelineIndex;
+	uint32_t lightPipelineIndex;
+	//开启深度预通道时先只画深度，gBuffer再用EQUAL测试，每个像素只着色一次
+	uint32_t depthPrepassPipelineIndex;
+	//支持VK_EXT_mesh_shader时gBuffer用mesh shader画，task shader里剔除meshlet
+	VkPipelineLayout meshShaderPipelineLayout = VK_NULL_HANDLE;
+	uint32_t meshShaderPipelineIndex;
+	bool meshShaderFailureReported = false;
 
 	//Buffer
 	std::unique_ptr<myBuffer> my_buffer;
 
+	std::unique_ptr<myGpuProfiler> my_gpuProfiler;
+
+	std::unique_ptr<myComputeScheduler> my_computeScheduler;
+	std::unique_ptr<myGpuCulling> my_gpuCulling;
+	uint32_t cullPassIndex;
+
 	std::unique_ptr<myModel> my_model;
-	int verticesSize = 0;	//妈的，必须显示传size才行，封装后vertices,size()返回的大小是错误的
-	std::vector<Vertex> vertices;
-	std::vector<uint32_t> indices;
+	std::unique_ptr<myBvh> my_bvh;	//每个mesh一个图元，包围盒在世界空间里，用于CPU上的剔除和拾取
+	std::vector<uint8_t> cpuVisibleMeshes;	//GPU剔除没有执行的帧用BVH剔除的结果
+	std::vector<uint32_t> meshLods;	//每帧按投影到屏幕上的误差选的LOD
+	//不透明mesh每帧按视图空间深度从近到远排序，先画近处的，后面被挡住的片元早期深度测试就能丢掉
+	std::vector<uint32_t> drawOrder;
+	std::vector<uint64_t> drawSortKeys;
+	std::vector<uint64_t> drawSortScratch;
+	//CPU剔除后可见的mesh按选中LOD和按LOD0的三角形数，用于统计LOD省了多少
+	uint64_t frameLodTriangles = 0;
+	uint64_t frameFullTriangles = 0;
+	uint64_t totalLodTriangles = 0;
+	uint64_t totalFullTriangles = 0;
+	uint64_t lodFrameCount = 0;
+	std::vector<uint64_t> lodUsage;	//每一级LOD被选中的mesh次数
+	//gBuffer通道录制绘制命令的CPU时间，每次绘制只更新push constant，不再重新绑定描述符集
+	VkShaderStageFlags drawPushConstantStages = 0;
+	uint64_t gBufferDrawCount = 0;
+	double gBufferDrawRecordTime = 0.0;	//us
+	bool pickButtonDown = false;
 
 	//Image
-	std::unordered_map<std::string, uint32_t> uniqueMeshToAlbedoTextures;
-	std::vector<std::unique_ptr<myImage>> albedoTextureImages;
-	std::unordered_map<std::string, uint32_t> uniqueMeshToNormalTextures;
-	std::vector<std::unique_ptr<myImage>> normalTextureImages;
+	//模型纹理在myTextureRegistry里，按内容去重
 	std::unique_ptr<myImage> gBufferAlbedoImage;
 	std::unique_ptr<myImage> gBufferNormalImage;
 	std::unique_ptr<myImage> testImage;
 	std::unique_ptr<myImage> depthImage;
+	//G-buffer按这个大小分配，窗口缩小或者放大后还能装下时直接复用，只画renderArea那一块
+	VkExtent2D gBufferExtent = { 0, 0 };
+	std::vector<bool> gBufferDescriptorDirty;	//G-buffer重新分配后，每个飞行中的帧等到自己上一次的提交做完后再更新描述符
 
 	std::vector<VkSemaphore> imageAvailableSemaphores;
 	std::vector<VkSemaphore> renderFinishedSemaphores;
-	std::vector<VkFence> inFlightFences;
+	std::unique_ptr<myTimeline> frameTimeline;	//第frameNumber帧的图形命令做完后推到frameNumber + 1，替代每帧的栏栅
+	std::unique_ptr<myTimeline> uploadTimeline;	//单次提交的上传用，和帧号无关
 	uint32_t currentFrame = 0;
+	uint64_t frameNumber = 0;	//一直递增的帧号，用来判断延迟销毁的资源是否已经不再被使用
+	myDeletionQueue deletionQueue;
 
 	bool framebufferResized = false;
+	bool swapChainOutOfDate = false;	//下一帧开始时重建交换链
 
 	void initWindow() {
 
@@ -185,20 +250,28 @@ private:
 
 	void initVulkan() {
 
+		MY_PROFILE_FUNCTION();
+
 		createInstance();
 		setupDebugMessenger();
 		createSurface();
 		createMyDevice();
+		createMyPresentMonitor();
 		createMySwapChain();
 		createMyBuffer();
+		createMyGpuProfiler();
 		createTargetTextureResources();
 		loadModel();
 		createTextureImage();
 		createBuffers();
 		createRenderPass();
 		createFramebuffers();
+		createMyShaderCache();
 		createMyDescriptor();
+		createMyPipelineCache();
 		createGraphicsPipeline();
+		createMyComputeScheduler();
+		createMeshShaderPipeline();
 		createSyncObjects();
 
 	}
@@ -221,7 +294,7 @@ private:
 		appInfo.applicationVersion = VK_MAKE_VERSION(1, 0, 0);
 		appInfo.pEngineName = "No Engine";
 		appInfo.engineVersion = VK_MAKE_VERSION(1, 0, 0);
-		appInfo.apiVersion = VK_API_VERSION_1_0;
+		appInfo.apiVersion = VK_API_VERSION_1_2;	//timeline semaphore是1.2的核心功能
 
 		VkInstanceCreateInfo createInfo{};
 		createInfo.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
@@ -350,58 +423,52 @@ private:
 		my_device = std::make_unique<myDevice>(instance, surface);
 		my_device->pickPhysicalDevice();
 		my_device->createLogicalDevice(enableValidationLayers, validationLayers);
+		//findDepthFormat优先选浮点格式，选出来的不是浮点说明设备不支持；定点深度反向后远处的精度并不会变好
+		if (settings.reverseZ && !myImage::isFloatDepthFormat(myImage::findDepthFormat(my_device->physicalDevice))) {
+			std::cout << "no float depth format, reverse-Z disabled" << std::endl;
+			settings.reverseZ = false;
+		}
 	}
 
 	//交换链应该就是多缓冲交替呈现渲染结果的句柄吧
-	void createMySwapChain() {
-		my_swapChain = std::make_unique<mySwapChain>(window, surface, my_device->logicalDevice, my_device->swapChainSupportDetails, my_device->queueFamilyIndices);
+	void createMySwapChain(VkSwapchainKHR oldSwapChain = VK_NULL_HANDLE) {
+		my_swapChain = std::make_unique<mySwapChain>(window, surface, my_device->logicalDevice, my_device->swapChainSupportDetails, my_device->queueFamilyIndices, settings.presentMode, settings.swapChainImageCount, oldSwapChain);
+		std::cout << "present mode " << mySettings::presentModeName(my_swapChain->presentMode) << ", " << my_swapChain->swapChainImages.size() << " swapchain images" << std::endl;
+		if (my_presentMonitor) {
+			my_presentMonitor->setSwapChain(my_swapChain->swapChain);
+		}
+	}
+
+	void createMyPresentMonitor() {
+		if (my_device->presentWaitSupported) {
+			my_presentMonitor = std::make_unique<myPresentMonitor>(my_device->logicalDevice);
+		}
+		else {
+			std::cout << "VK_KHR_present_wait is not supported, present latency will not be measured" << std::endl;
+		}
 	}
 
 	void createMyBuffer() {
 		my_buffer = std::make_unique<myBuffer>();
 		my_buffer->createCommandPool(my_device->logicalDevice, my_device->queueFamilyIndices);
-		my_buffer->createCommandBuffers(my_device->logicalDevice, MAX_FRAMES_IN_FLIGHT);
-	}
-
-	static std::vector<char> readFile(const std::string& filename) {
-
-		std::ifstream file(filename, std::ios::ate | std::ios::binary);
-		if (!file.is_open()) {
-			throw std::runtime_error("failed to open file!");
-		}
-
-		size_t fileSize = (size_t)file.tellg();
-		std::vector<char> buffer(fileSize);
-
-		file.seekg(0);
-		file.read(buffer.data(), fileSize);
-
-		file.close();
-		return buffer;
-
+		my_buffer->createCommandBuffers(my_device->logicalDevice, settings.framesInFlight);
+		//纹理和模型的上传在createSyncObjects之前，所以这里先建好
+		uploadTimeline = std::make_unique<myTimeline>(my_device->logicalDevice);
+		myBuffer::uploadTimeline = uploadTimeline.get();
 	}
 
-	VkShaderModule createShaderModule(const std::vector<char>& code) {
-
-		VkShaderModuleCreateInfo createInfo{};
-		createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-		createInfo.codeSize = code.size();
-		createInfo.pCode = reinterpret_cast<const uint32_t*>(code.data());
-
-		VkShaderModule shaderModule;
-		if (vkCreateShaderModule(my_device->logicalDevice, &createInfo, nullptr, &shaderModule) != VK_SUCCESS) {
-			throw std::runtime_error("failed to create shader module!");
-		}
-
-		return shaderModule;
-
+	void createMyGpuProfiler() {
+		my_gpuProfiler = std::make_unique<myGpuProfiler>(my_device->physicalDevice, my_device->logicalDevice, my_device->queueFamilyIndices.graphicsFamily.value(), settings.framesInFlight);
+		myBuffer::uploadProfiler = my_gpuProfiler.get();
 	}
 
 	void createTargetTextureResources() {
-		gBufferAlbedoImage = std::make_unique<myImage>(my_device->physicalDevice, my_device->logicalDevice, my_swapChain->swapChainExtent.width, my_swapChain->swapChainExtent.height, 1, VK_SAMPLE_COUNT_1_BIT, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT | VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, VK_IMAGE_ASPECT_COLOR_BIT);
-		gBufferNormalImage = std::make_unique<myImage>(my_device->physicalDevice, my_device->logicalDevice, my_swapChain->swapChainExtent.width, my_swapChain->swapChainExtent.height, 1, VK_SAMPLE_COUNT_1_BIT, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT | VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, VK_IMAGE_ASPECT_COLOR_BIT);
-		testImage = std::make_unique<myImage>(my_device->physicalDevice, my_device->logicalDevice, my_swapChain->swapChainExtent.width, my_swapChain->swapChainExtent.height, 1, VK_SAMPLE_COUNT_1_BIT, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT | VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, VK_IMAGE_ASPECT_COLOR_BIT);
-		depthImage = std::make_unique<myImage>(my_device->physicalDevice, my_device->logicalDevice, my_swapChain->swapChainExtent.width, my_swapChain->swapChainExtent.height, 1, VK_SAMPLE_COUNT_1_BIT, myImage::findDepthFormat(my_device->physicalDevice), VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, VK_IMAGE_ASPECT_DEPTH_BIT);
+		gBufferExtent.width = std::max(gBufferExtent.width, my_swapChain->swapChainExtent.width);
+		gBufferExtent.height = std::max(gBufferExtent.height, my_swapChain->swapChainExtent.height);
+		gBufferAlbedoImage = std::make_unique<myImage>(my_device->physicalDevice, my_device->logicalDevice, gBufferExtent.width, gBufferExtent.height, 1, VK_SAMPLE_COUNT_1_BIT, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT | VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, VK_IMAGE_ASPECT_COLOR_BIT);
+		gBufferNormalImage = std::make_unique<myImage>(my_device->physicalDevice, my_device->logicalDevice, gBufferExtent.width, gBufferExtent.height, 1, VK_SAMPLE_COUNT_1_BIT, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT | VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, VK_IMAGE_ASPECT_COLOR_BIT);
+		testImage = std::make_unique<myImage>(my_device->physicalDevice, my_device->logicalDevice, gBufferExtent.width, gBufferExtent.height, 1, VK_SAMPLE_COUNT_1_BIT, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT | VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, VK_IMAGE_ASPECT_COLOR_BIT);
+		depthImage = std::make_unique<myImage>(my_device->physicalDevice, my_device->logicalDevice, gBufferExtent.width, gBufferExtent.height, 1, VK_SAMPLE_COUNT_1_BIT, myImage::findDepthFormat(my_device->physicalDevice), VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, VK_IMAGE_ASPECT_DEPTH_BIT);
 	}
 
 	void loadModel() {
@@ -472,55 +539,51 @@ private:
 		*/
 
 		//使用assimp
-		//verticesSize = 0;
-		uint32_t index = 0;
 		my_model = std::make_unique<myModel>("models/nanosuit/nanosuit.obj");	//给绝对路径读不到，给相对路径能读到
 		if (my_model->meshs.size() == 0) {
 			throw std::runtime_error("failed to create model!");
 		}
-		//将所有mesh的顶点合并
-		for (uint32_t i = 0; i < my_model->meshs.size(); i++) {
-
-			this->vertices.insert(this->vertices.end(), my_model->meshs[i].vertices.begin(), my_model->meshs[i].vertices.end());
-
-			//因为assimp是按一个mesh一个mesh的存，所以每个indices都是相对一个mesh的，当我们将每个mesh的顶点存到一起时，indices就会出错，我们需要增加索引
-			for (uint32_t j = 0; j < my_model->meshs[i].indices.size(); j++) {
-				my_model->meshs[i].indices[j] += index;
-			}
-			index += my_model->meshs[i].vertices.size();
-			//verticesSize += my_model->meshs[i].vertices.size();
-			this->indices.insert(this->indices.end(), my_model->meshs[i].indices.begin(), my_model->meshs[i].indices.end());
+		//mesh的顶点不在CPU上合并，createBuffers时直接写进暂存缓冲
+		myProfiler::printMemory("after import");
+
+		my_bvh = std::make_unique<myBvh>();
+		my_bvh->build(computeMeshWorldBounds());
+		cpuVisibleMeshes.assign(my_model->meshs.size(), 1);
+		meshLods.assign(my_model->meshs.size(), 0);
+		drawOrder.resize(my_model->meshs.size());
+		for (uint32_t i = 0; i < drawOrder.size(); i++) {
+			drawOrder[i] = i;
 		}
+		lodUsage.assign(myModel::MAX_LOD_NUM, 0);
 
 	}
 
-	void createTextureImage() {
+	//着色器目前只有一个模型矩阵，所以先只用根节点的世界矩阵
+	glm::mat4 modelMatrix() {
+		return glm::scale(glm::mat4(1.0f), glm::vec3(0.4f, 0.4f, 0.4f)) * my_model->scene.worldMatrices[0];
+	}
 
-		for (uint32_t i = 0; i < my_model->meshs.size(); i++) {
-			for (uint32_t j = 0; j < my_model->meshs[i].textures.size(); j++) {
-				if (my_model->meshs[i].textures[j].type == "texture_albedo") {
-					if (uniqueMeshToAlbedoTextures.count(my_model->meshs[i].textures[j].path) == 0) {
-						uniqueMeshToAlbedoTextures[my_model->meshs[i].textures[j].path] = albedoTextureImages.size();
-						albedoTextureImages.push_back(std::make_unique<myImage>(my_model->meshs[i].textures[j].path.c_str(), my_device->physicalDevice, my_device->logicalDevice, my_device->graphicsQueue, my_buffer->commandPool, true));
-					}
-				}
-				else if (my_model->meshs[i].textures[j].type == "texture_normal") {
-					if (uniqueMeshToNormalTextures.count(my_model->meshs[i].textures[j].path) == 0) {
-						uniqueMeshToNormalTextures[my_model->meshs[i].textures[j].path] = normalTextureImages.size();
-						normalTextureImages.push_back(std::make_unique<myImage>(my_model->meshs[i].textures[j].path.c_str(), my_device->physicalDevice, my_device->logicalDevice, my_device->graphicsQueue, my_buffer->commandPool, false));
-					}
-					
-				}
-			}
+	std::vector<AABB> computeMeshWorldBounds() {
+		glm::mat4 model = modelMatrix();
+		std::vector<AABB> bounds(my_model->meshBounds.size());
+		for (size_t i = 0; i < bounds.size(); i++) {
+			bounds[i] = my_model->meshBounds[i].transformed(model);
 		}
+		return bounds;
+	}
+
+	//导入模型时纹理已经在myTextureRegistry里去重了，这里只上传还没上传过的
+	void createTextureImage() {
+		myTextureRegistry::upload(my_device->physicalDevice, my_device->logicalDevice, my_device->graphicsQueue, my_buffer->commandPool);
 	}
 
 	void createBuffers() {
 		//之后我们可能有很多的顶点数据，我们应该直接去拿一个大的缓冲区，然后将之分配成小的，而不是小的一个一个申请
 		//vulkan规定设备的最大可申请缓冲区数>4096
-		my_buffer->createVertexBuffer(my_device->physicalDevice, my_device->logicalDevice, my_device->graphicsQueue, sizeof(vertices[0]) * vertices.size(), &vertices);
-		my_buffer->createIndexBuffer(my_device->physicalDevice, my_device->logicalDevice, my_device->graphicsQueue, sizeof(indices[0]), &indices);
-		my_buffer->createUniformBuffers(my_device->physicalDevice, my_device->logicalDevice, MAX_FRAMES_IN_FLIGHT);
+		//因为assimp是按一个mesh一个mesh的存，所以每个indices都是相对一个mesh的，合并时要加上顶点偏移，这一步也在写暂存缓冲时做
+		my_buffer->createMeshBuffers(my_device->physicalDevice, my_device->logicalDevice, my_device->graphicsQueue, my_model->meshs);
+		myProfiler::printMemory("after upload");
+		my_buffer->createUniformBuffers(my_device->physicalDevice, my_device->logicalDevice, settings.framesInFlight);
 	}
 
 	//renderPass描述了整个渲染的流程，他包括附件attachment、子渲染subpass以及子渲染之间的依赖（串并行）subpassdependency
@@ -665,343 +728,364 @@ private:
 		my_buffer->createFramebuffers(my_swapChain->swapChainImageViews.size(), my_swapChain->swapChainImageViews, my_swapChain->extent, imageViews, depthImage->imageView, renderPass, my_device->logicalDevice);
 	}
 
+	//着色器相对于可执行文件查找，不再写死绝对路径；描述符集布局要从着色器反射，所以在描述符之前创建
+	void createMyShaderCache() {
+		my_shaderCache = std::make_unique<myShaderCache>(my_device->logicalDevice, "shaders/deferredShading");
+	}
+
+	//把一条管线各阶段的反射结果合并，着色器用到的set超过setNum时抛出异常
+	ReflectedPipelineLayout reflectPipelineLayout(const std::vector<std::string>& shaderNames, uint32_t setNum) {
+		std::vector<std::shared_ptr<ShaderModule>> modules;
+		std::vector<const ShaderReflection*> stages;
+		for (const std::string& shaderName : shaderNames) {
+			modules.push_back(my_shaderCache->getShaderModule(shaderName));
+			stages.push_back(&modules.back()->reflection);
+		}
+		ReflectedPipelineLayout layout = myShaderReflection::merge(stages);
+		if (layout.sets.size() > setNum) {
+			throw std::runtime_error("failed to reflect pipeline layout: shaders use more descriptor sets than the pipeline layout has!");
+		}
+		layout.sets.resize(setNum);
+		return layout;
+	}
+
+	//描述符集布局从gBuffer和light的着色器反射出来，池的大小按实际要分配的集合算
+	//set 0（uniform）被所有图形管线共用，绑定取并集；set 1为各自的纹理，gBuffer的是所有材质纹理组成的一个数组
 	void createMyDescriptor() {
 
-		my_descriptor = std::make_unique<myDescriptor>(my_device->logicalDevice, MAX_FRAMES_IN_FLIGHT);
-
-		uint32_t uniformBufferNumAllLayout = 1;
-		std::vector<uint32_t> textureNumAllLayout;
-		std::vector<VkDescriptorType> types = { VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT };
-		textureNumAllLayout.push_back(uniqueMeshToAlbedoTextures.size() + uniqueMeshToNormalTextures.size());
-		textureNumAllLayout.push_back(3);
-		my_descriptor->createDescriptorPool(uniformBufferNumAllLayout, types, textureNumAllLayout);	//这里是一共有几个，要算上所有的布局
-
-		//创造uniformDescriptorObject
-		std::vector<VkShaderStageFlagBits> usages;
-		usages.push_back(VK_SHADER_STAGE_ALL_GRAPHICS);
-		std::vector<std::vector<VkBuffer>> uniformBuffersAllSet = { my_buffer->uniformBuffers };
-		my_descriptor->descriptorObjects.push_back(my_descriptor->createDescriptorObject(1, 0, &usages, nullptr, 1, &uniformBuffersAllSet, nullptr, nullptr));
-
-		//创造模型textureDescriptorObject
-		std::vector<std::vector<VkImageView>> textureImageViewsAllSet;
-		std::vector<std::vector<VkSampler>> textureSamplersAllSet;
-		std::vector<VkDescriptorType> textureDescriptorType;
-		for (uint32_t j = 0; j < my_model->meshs.size(); j++) {
+		my_descriptor = std::make_unique<myDescriptor>(my_device->logicalDevice, settings.framesInFlight);
 
-			std::string twoPath = "";
-			for (int k = 0; k < 2; k++) {
-				twoPath += my_model->meshs[j].textures[k].path;
+		gBufferReflection = reflectPipelineLayout({ "gBufferVert.spv", "gBufferFrag.spv" }, 2);
+		lightReflection = reflectPipelineLayout({ "lightVert.spv", "lightFrag.spv" }, 2);
+		std::vector<VkDescriptorSetLayoutBinding> uniformBindings = gBufferReflection.sets[0];
+		myShaderReflection::mergeBindings(uniformBindings, lightReflection.sets[0]);
+		//mesh shader管线的模块在后台编译，这时可能还读不到；它的task和mesh shader也读uniform
+		if (my_device->meshShaderSupported) {
+			for (VkDescriptorSetLayoutBinding& binding : uniformBindings) {
+				binding.stageFlags |= VK_SHADER_STAGE_TASK_BIT_EXT | VK_SHADER_STAGE_MESH_BIT_EXT;
 			}
+		}
+
+		//模型的纹理，按纹理组合去重成材质
+		std::vector<VkImageView> materialImageViews;
+		std::vector<VkSampler> materialSamplers;
+		meshMaterials.resize(my_model->meshs.size());
+		for (uint32_t j = 0; j < my_model->meshs.size(); j++) {
 
-			std::vector<VkImageView> textureImageViews;
-			std::vector<VkSampler> textureSamplers;
-			if (uniqueDescriptorSets.count(twoPath) == 0) {
+			//textures[0]为反射率，textures[1]为法线，和gBufferFrag里的绑定顺序一致
+			uint32_t albedoTexture = my_model->meshs[j].textures[0].id;
+			uint32_t normalTexture = my_model->meshs[j].textures[1].id;
+			uint64_t textureKey = (static_cast<uint64_t>(albedoTexture) << 32) | normalTexture;
 
-				uniqueDescriptorSets[twoPath] = uniqueDescriptorSets.size();
+			auto it = uniqueMaterials.find(textureKey);
+			if (it != uniqueMaterials.end()) {
+				meshMaterials[j] = it->second;
+			}
+			else {
 
-				int albedoTextureIndex = uniqueMeshToAlbedoTextures[my_model->meshs[j].textures[0].path];
-				textureImageViews.push_back(albedoTextureImages[albedoTextureIndex]->imageView);
-				textureSamplers.push_back(albedoTextureImages[albedoTextureIndex]->textureSampler);
+				meshMaterials[j] = static_cast<uint32_t>(uniqueMaterials.size());
+				uniqueMaterials[textureKey] = meshMaterials[j];
 
-				int normalTextureIndex = uniqueMeshToNormalTextures[my_model->meshs[j].textures[1].path];
-				textureImageViews.push_back(normalTextureImages[normalTextureIndex]->imageView);
-				textureSamplers.push_back(normalTextureImages[normalTextureIndex]->textureSampler);
+				myImage* albedoImage = myTextureRegistry::image(albedoTexture);
+				myImage* normalImage = myTextureRegistry::image(normalTexture);
+				materialImageViews.insert(materialImageViews.end(), { albedoImage->imageView, normalImage->imageView });
+				materialSamplers.insert(materialSamplers.end(), { albedoImage->textureSampler, normalImage->textureSampler });
 
-				textureImageViewsAllSet.push_back(textureImageViews);
-				textureSamplersAllSet.push_back(textureSamplers);
-				textureDescriptorType.push_back(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER);
 			}
 
 		}
-		my_descriptor->descriptorObjects.push_back(my_descriptor->createDescriptorObject(0, 2, nullptr, &textureDescriptorType, uniqueDescriptorSets.size(), nullptr, &textureImageViewsAllSet, &textureSamplersAllSet));
+
+		//gBufferFrag里数组的长度是特化常量，反射出的只是默认值，这里按实际的材质数改掉
+		std::vector<VkDescriptorSetLayoutBinding> materialBindings = gBufferReflection.sets[1];
+		if (materialBindings.size() != 1 || materialBindings[0].descriptorType != VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER) {
+			throw std::runtime_error("failed to create material descriptor: gBufferFrag.spv must use a single sampler array in set 1, rebuild the shaders!");
+		}
+		if (materialImageViews.empty()) {
+			throw std::runtime_error("failed to create material descriptor: model has no materials!");
+		}
+		//设备只保证每个阶段16个采样器，放不下所有材质时退回每个材质一个集合，数组里只有自己的两张纹理，materialIndex总是0
+		uint32_t allTextureNum = static_cast<uint32_t>(materialImageViews.size());
+		VkPhysicalDeviceProperties deviceProperties;
+		vkGetPhysicalDeviceProperties(my_device->physicalDevice, &deviceProperties);
+		const VkPhysicalDeviceLimits& limits = deviceProperties.limits;
+		perMaterialDescriptorSets = limits.maxPerStageDescriptorSamplers < allTextureNum || limits.maxPerStageDescriptorSampledImages < allTextureNum
+									|| limits.maxDescriptorSetSamplers < allTextureNum || limits.maxDescriptorSetSampledImages < allTextureNum;
+		if (perMaterialDescriptorSets) {
+			std::cout << "material textures (" << allTextureNum << ") exceed the device sampler limit (" << limits.maxPerStageDescriptorSamplers << "), binding one descriptor set per material" << std::endl;
+		}
+		materialTextureNum = perMaterialDescriptorSets ? 2 : allTextureNum;
+		materialBindings[0].descriptorCount = materialTextureNum;
+		uint32_t materialSetNum = allTextureNum / materialTextureNum;
+		std::vector<std::vector<VkImageView>> textureImageViewsAllSet(materialSetNum);
+		std::vector<std::vector<VkSampler>> textureSamplersAllSet(materialSetNum);
+		for (uint32_t m = 0; m < materialSetNum; m++) {
+			textureImageViewsAllSet[m].assign(materialImageViews.begin() + m * materialTextureNum, materialImageViews.begin() + (m + 1) * materialTextureNum);
+			textureSamplersAllSet[m].assign(materialSamplers.begin() + m * materialTextureNum, materialSamplers.begin() + (m + 1) * materialTextureNum);
+		}
+
+		std::vector<VkDescriptorPoolSize> poolSizes;
+		myDescriptor::addPoolSizes(poolSizes, materialBindings, materialSetNum);
+		myDescriptor::addPoolSizes(poolSizes, lightReflection.sets[1], settings.framesInFlight);
+		//uniform集合每帧从临时池里重新分配，见allocateFrameUniformDescriptorSet
+		std::vector<VkDescriptorPoolSize> framePoolSizes;
+		myDescriptor::addPoolSizes(framePoolSizes, uniformBindings, 1);
+		my_descriptor->createDescriptorPool(poolSizes, materialSetNum + settings.framesInFlight, framePoolSizes, 1);
+
+		//创造uniformDescriptorObject，这里只要布局，集合每帧分配
+		my_descriptor->descriptorObjects.push_back(my_descriptor->createDescriptorObject(uniformBindings, 0, nullptr, nullptr, nullptr));
+
+		//创造模型textureDescriptorObject，所有材质共用一个集合（或每个材质一个），模型纹理不会变，所有帧共用
+		my_descriptor->descriptorObjects.push_back(my_descriptor->createDescriptorObject(materialBindings, materialSetNum, nullptr, &textureImageViewsAllSet, &textureSamplersAllSet));
 
 		//创建gBufferTextureDescriptorObject
-		textureImageViewsAllSet.resize(1);
-		textureImageViewsAllSet[0] = {gBufferAlbedoImage->imageView, gBufferNormalImage->imageView, depthImage->imageView};
-		//textureSamplersAllSet.resize(1);
-		//textureSamplersAllSet[0] = { gBufferAlbedoImage->textureSampler, gBufferNormalPositionImage->textureSampler };
-		textureDescriptorType = { VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT, VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT, VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT };
-		my_descriptor->descriptorObjects.push_back(my_descriptor->createDescriptorObject(0, 3, nullptr, &textureDescriptorType, 1, nullptr, &textureImageViewsAllSet, nullptr));
+		//每个飞行中的帧一个集合，G-buffer重新分配后可以等各自的帧结束再更新，不用等整个设备空闲
+		textureImageViewsAllSet.assign(settings.framesInFlight, { gBufferAlbedoImage->imageView, gBufferNormalImage->imageView, depthImage->imageView });
+		my_descriptor->descriptorObjects.push_back(my_descriptor->createDescriptorObject(lightReflection.sets[1], settings.framesInFlight, nullptr, &textureImageViewsAllSet, nullptr));
+		gBufferDescriptorDirty.assign(settings.framesInFlight, false);
+
+	}
+
+	VkPipelineLayout createPipelineLayout(const std::vector<VkDescriptorSetLayout>& setLayouts, const std::vector<VkPushConstantRange>& pushConstantRanges) {
+		VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+		pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+		pipelineLayoutInfo.setLayoutCount = static_cast<uint32_t>(setLayouts.size());
+		pipelineLayoutInfo.pSetLayouts = setLayouts.data();
+		pipelineLayoutInfo.pushConstantRangeCount = static_cast<uint32_t>(pushConstantRanges.size());
+		pipelineLayoutInfo.pPushConstantRanges = pushConstantRanges.data();
+		VkPipelineLayout pipelineLayout;
+		if (vkCreatePipelineLayout(my_device->logicalDevice, &pipelineLayoutInfo, nullptr, &pipelineLayout) != VK_SUCCESS) {
+			throw std::runtime_error("failed to create pipeline layout!");
+		}
+		return pipelineLayout;
+	}
 
+	void createMyPipelineCache() {
+		my_pipelineCache = std::make_unique<myPipelineCache>(my_device->physicalDevice, my_device->logicalDevice, "pipeline_cache.bin");
 	}
 
 	//相当于是shader，与renderPass中的一个subPass对应
+	//管线的编译交给myPipelineManager在后台线程中做，这里只准备布局和管线描述
 	void createGraphicsPipeline() {
 
-		//gBuffer图形管线
-		auto gBufferVertShaderCode = readFile("C:/Users/fangzanbo/Desktop/渲染/Vulkan/myVulkan/myVulkan/shaders/deferredShading/gBufferVert.spv");
-		auto gBufferFragShaderCode = readFile("C:/Users/fangzanbo/Desktop/渲染/Vulkan/myVulkan/myVulkan/shaders/deferredShading/gBufferFrag.spv");
-
-		VkShaderModule gBufferVertShaderModule = createShaderModule(gBufferVertShaderCode);
-		VkShaderModule gBufferFragShaderModule = createShaderModule(gBufferFragShaderCode);
-
-		VkPipelineShaderStageCreateInfo vertShaderStageInfo{};
-		vertShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-		vertShaderStageInfo.stage = VK_SHADER_STAGE_VERTEX_BIT;
-		vertShaderStageInfo.module = gBufferVertShaderModule;
-		vertShaderStageInfo.pName = "main";
-		//允许指定着色器常量的值，比起在渲染时指定变量配置更加有效，因为可以通过编译器优化（没搞懂）
-		vertShaderStageInfo.pSpecializationInfo = nullptr;
-
-		VkPipelineShaderStageCreateInfo fragShaderStageInfo{};
-		fragShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-		fragShaderStageInfo.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
-		fragShaderStageInfo.module = gBufferFragShaderModule;
-		fragShaderStageInfo.pName = "main";
-		fragShaderStageInfo.pSpecializationInfo = nullptr;
-
-		VkPipelineShaderStageCreateInfo shaderStages[] = { vertShaderStageInfo, fragShaderStageInfo };
-
-		//VAO
-		VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
-		vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-		auto bindingDescription = Vertex::getBindingDescription();
-		auto attributeDescriptions = Vertex::getAttributeDescriptions();
-		vertexInputInfo.vertexBindingDescriptionCount = 1;
-		vertexInputInfo.pVertexBindingDescriptions = &bindingDescription;
-		vertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(attributeDescriptions.size());
-		vertexInputInfo.pVertexAttributeDescriptions = attributeDescriptions.data();
-
-		//设置渲染图元方式
-		VkPipelineInputAssemblyStateCreateInfo inputAssembly{};
-		inputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
-		//VK_PRIMITIVE_TOPOLOGY_POINT_LIST：来自顶点的点
-		//VK_PRIMITIVE_TOPOLOGY_LINE_LIST：每 2 个顶点绘制一条线，不重复使用
-		//VK_PRIMITIVE_TOPOLOGY_LINE_STRIP：每条线的结束顶点用作下一条线的起始顶点
-		//VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST：每 3 个顶点生成一个三角形，无需重复使用
-		//VK_PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP：每个三角形的第二和第三个顶点用作下一个三角形的前两个顶点
-		inputAssembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
-		inputAssembly.primitiveRestartEnable = VK_FALSE;
-
-		//设置视口
-		VkPipelineViewportStateCreateInfo viewportState{};
-		viewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
-		viewportState.viewportCount = 1;
-		//viewportState.pViewports = &viewport;	//可以设置固定值，修改新值需要创建新的pipeline
-		viewportState.scissorCount = 1;	//好像和坐标相关，之后测试一下
-		//viewportState.pScissors = &scissor;
-
-		//设置光栅化器，主要是深度测试等的开关、面剔除等
-		VkPipelineRasterizationStateCreateInfo rasterizer{};
-		rasterizer.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
-		rasterizer.depthClampEnable = VK_FALSE;	//超出近远平面的都会被剔除
-		rasterizer.rasterizerDiscardEnable = VK_FALSE; //设置为VK_TRUE，则几何图形永远不会经过光栅化阶段。这基本上会禁用对帧缓冲区的任何输出。
-		//确定polygonMode如何为几何体生成片段。有以下模式可用：
-		//VK_POLYGON_MODE_FILL：用碎片填充多边形的区域
-		//VK_POLYGON_MODE_LINE：多边形边缘绘制为线
-		//VK_POLYGON_MODE_POINT：多边形顶点绘制为点
-		rasterizer.polygonMode = VK_POLYGON_MODE_FILL;
-		rasterizer.lineWidth = 1.0f;
-		rasterizer.cullMode = VK_CULL_MODE_BACK_BIT;
-		rasterizer.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;	//顶点序列是逆时针的是正面
-		rasterizer.depthBiasEnable = VK_FALSE;
-		rasterizer.depthBiasConstantFactor = 0.0f;
-		rasterizer.depthBiasClamp = 0.0f;
-		rasterizer.depthBiasSlopeFactor = 0.0f;
-
-		//多采样
-		VkPipelineMultisampleStateCreateInfo multisampling{};
-		multisampling.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
-		multisampling.sampleShadingEnable = VK_FALSE;
-		//multisampling.rasterizationSamples = msaaSamples;
-		multisampling.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
-		multisampling.minSampleShading = 1.0f;// .2f;
-		multisampling.pSampleMask = nullptr;
-		multisampling.alphaToCoverageEnable = VK_FALSE;
-		multisampling.alphaToOneEnable = VK_FALSE;
-
-		//颜色混合
-		//妈的，必须为每一个输出结果写一个颜色混合状态，因为要在这里规定是否可以写入
-		std::array<VkPipelineColorBlendAttachmentState, 2> blendAttachmentStates;
-		for (int i = 0; i < 2; i++) {
-			VkPipelineColorBlendAttachmentState colorBlendAttachment{};
-			colorBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
-			colorBlendAttachment.blendEnable = VK_FALSE;
-			colorBlendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_ONE;
-			colorBlendAttachment.colorBlendOp = VK_BLEND_OP_ADD; // Optional
-			colorBlendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE; // Optional
-			colorBlendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO; // Optional
-			colorBlendAttachment.alphaBlendOp = VK_BLEND_OP_ADD; // Optiona
-			blendAttachmentStates[i] = colorBlendAttachment;
-		}
-		VkPipelineColorBlendStateCreateInfo colorBlending{};
-		colorBlending.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
-		colorBlending.logicOpEnable = VK_FALSE;
-		colorBlending.logicOp = VK_LOGIC_OP_COPY; // Optional
-		colorBlending.attachmentCount = 2;
-		colorBlending.pAttachments = blendAttachmentStates.data();
-		colorBlending.blendConstants[0] = 0.0f; // Optional
-		colorBlending.blendConstants[1] = 0.0f; // Optional
-		colorBlending.blendConstants[2] = 0.0f; // Optional
-		colorBlending.blendConstants[3] = 0.0f; // Optional
-
-		VkPipelineDepthStencilStateCreateInfo depthStencil{};
-		depthStencil.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
-		depthStencil.depthTestEnable = VK_TRUE;
-		depthStencil.depthWriteEnable = VK_TRUE;
-		depthStencil.depthCompareOp = VK_COMPARE_OP_LESS;
-		depthStencil.depthBoundsTestEnable = VK_FALSE;
-		depthStencil.minDepthBounds = 0.0f; // Optional
-		depthStencil.maxDepthBounds = 1.0f; // Optional
-		depthStencil.stencilTestEnable = VK_FALSE;
-		depthStencil.front = {}; // Optional
-		depthStencil.back = {}; // Optional
-
-		//一般渲染管道状态都是固定的，不能渲染循环中修改，但是某些状态可以，如视口，长宽和混合常数
-		//同样通过宏来确定可动态修改的状态
-		std::vector<VkDynamicState> dynamicStates = {
-			VK_DYNAMIC_STATE_VIEWPORT,
-			VK_DYNAMIC_STATE_SCISSOR
-		};
-		VkPipelineDynamicStateCreateInfo dynamicState{};
-		dynamicState.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
-		dynamicState.dynamicStateCount = static_cast<uint32_t>(dynamicStates.size());
-		dynamicState.pDynamicStates = dynamicStates.data();
-
-		//pipeline布局
-		VkPipelineLayoutCreateInfo uniformPipelineLayoutInfo{};
-		uniformPipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-		std::array<VkDescriptorSetLayout, 2> discriptorSetLayouts = { my_descriptor->descriptorObjects[0].discriptorLayout, my_descriptor->descriptorObjects[1].discriptorLayout };
-		uniformPipelineLayoutInfo.setLayoutCount = discriptorSetLayouts.size();
-		uniformPipelineLayoutInfo.pSetLayouts = discriptorSetLayouts.data();
-		uniformPipelineLayoutInfo.pushConstantRangeCount = 0;
-		uniformPipelineLayoutInfo.pPushConstantRanges = nullptr;
-
-		if (vkCreatePipelineLayout(my_device->logicalDevice, &uniformPipelineLayoutInfo, nullptr, &gBufferPipelineLayout) != VK_SUCCESS) {
-			throw std::runtime_error("failed to create pipeline layout!");
+		my_pipelineManager = std::make_unique<myPipelineManager>(my_device->logicalDevice, my_pipelineCache->pipelineCache, my_shaderCache.get(), &deletionQueue);
+		std::cout << "compiling pipelines in background (" << (my_pipelineCache->loadedFromDisk ? "warm" : "cold") << " cache)" << std::endl;
+
+		//pipeline布局，push constant从反射结果来；描述符集布局在createMyDescriptor里已经从同一份反射生成
+		//每次绘制的数据从offset 0开始，大小要和DrawPushConstants一样，旧的.spv没有push constant
+		const std::vector<VkPushConstantRange>& drawPushConstantRanges = gBufferReflection.pushConstantRanges;
+		if (drawPushConstantRanges.size() != 1 || drawPushConstantRanges[0].offset != 0 || drawPushConstantRanges[0].size != sizeof(DrawPushConstants)) {
+			throw std::runtime_error("failed to create pipeline layout: gBuffer push constants do not match DrawPushConstants, rebuild the shaders!");
+		}
+		drawPushConstantStages = drawPushConstantRanges[0].stageFlags;
+		gBufferPipelineLayout = createPipelineLayout({ my_descriptor->descriptorObjects[0].discriptorLayout, my_descriptor->descriptorObjects[1].discriptorLayout }, drawPushConstantRanges);
+
+		//预通道的着色器缺了只关掉预通道，不然gBuffer用EQUAL比较会什么都画不出来
+		ReflectedPipelineLayout depthPrepassReflection;
+		if (settings.depthPrepass) {
+			try {
+				depthPrepassReflection = reflectPipelineLayout({ "depthPrepassVert.spv" }, 2);
+			}
+			catch (const std::exception& e) {
+				std::cout << "depth prepass disabled: " << e.what() << std::endl;
+				settings.depthPrepass = false;
+			}
 		}
 
-		VkGraphicsPipelineCreateInfo pipelineInfo{};
-		pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
-		pipelineInfo.stageCount = 2;	//顶点和片元两个着色器
-		pipelineInfo.pStages = shaderStages;
-		pipelineInfo.pVertexInputState = &vertexInputInfo;
-		pipelineInfo.pInputAssemblyState = &inputAssembly;
-		pipelineInfo.pViewportState = &viewportState;
-		pipelineInfo.pRasterizationState = &rasterizer;
-		pipelineInfo.pMultisampleState = &multisampling;
-		pipelineInfo.pDepthStencilState = &depthStencil;
-		pipelineInfo.pColorBlendState = &colorBlending;
-		pipelineInfo.pDynamicState = &dynamicState;
-		pipelineInfo.layout = gBufferPipelineLayout;
-		pipelineInfo.renderPass = renderPass;	//先建立连接，获得索引
-		pipelineInfo.subpass = 0;	//对应renderpass的哪个子部分
-		pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;	//可以直接使用现有pipeline
-		pipelineInfo.basePipelineIndex = -1;
-
-		//可以同时创造多个pipeline
-		//VkPipelineCache可以将管道缓存存储在文件中，则可以使用管道缓存来存储和重用与管道创建相关的数据
-		//这些数据可在多次调用 vkCreateGraphicsPipelines甚至跨程序执行中使用，这样可以显著加快以后的管道创建速度
-		if (vkCreateGraphicsPipelines(my_device->logicalDevice, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &gBufferGraphicsPipeline) != VK_SUCCESS) {
-			throw std::runtime_error("failed to create graphics pipeline!");
-		}
-
-		vkDestroyShaderModule(my_device->logicalDevice, gBufferVertShaderModule, nullptr);
-		vkDestroyShaderModule(my_device->logicalDevice, gBufferFragShaderModule, nullptr);
-
-		//light图形管线
-		auto lightVertShaderCode = readFile("C:/Users/fangzanbo/Desktop/渲染/Vulkan/myVulkan/myVulkan/shaders/deferredShading/lightVert.spv");
-		auto lightFragShaderCode = readFile("C:/Users/fangzanbo/Desktop/渲染/Vulkan/myVulkan/myVulkan/shaders/deferredShading/lightFrag.spv");
-		
-		VkShaderModule lightVertShaderModule = createShaderModule(lightVertShaderCode);
-		VkShaderModule lightFragShaderModule = createShaderModule(lightFragShaderCode);
-		
-		vertShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-		vertShaderStageInfo.stage = VK_SHADER_STAGE_VERTEX_BIT;
-		vertShaderStageInfo.module = lightVertShaderModule;
-		vertShaderStageInfo.pName = "main";
-		//允许指定着色器常量的值，比起在渲染时指定变量配置更加有效，因为可以通过编译器优化（没搞懂）
-		vertShaderStageInfo.pSpecializationInfo = nullptr;
-		
-		fragShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-		fragShaderStageInfo.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
-		fragShaderStageInfo.module = lightFragShaderModule;
-		fragShaderStageInfo.pName = "main";
-		fragShaderStageInfo.pSpecializationInfo = nullptr;
-		
-		shaderStages[0] = vertShaderStageInfo;
-		shaderStages[1] = fragShaderStageInfo;
-		
-		vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-		vertexInputInfo.vertexAttributeDescriptionCount = 0;
-		vertexInputInfo.pVertexAttributeDescriptions = nullptr;
-		vertexInputInfo.vertexBindingDescriptionCount = 0;
-		vertexInputInfo.pVertexBindingDescriptions = nullptr;
-		
-		inputAssembly = VkPipelineInputAssemblyStateCreateInfo();
-		inputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
-		inputAssembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
-		inputAssembly.primitiveRestartEnable = VK_FALSE;
-		
-		VkPipelineColorBlendAttachmentState colorBlendAttachment{};
-		colorBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
-		colorBlendAttachment.blendEnable = VK_FALSE;
-		colorBlendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_ONE;
-		colorBlendAttachment.colorBlendOp = VK_BLEND_OP_ADD; // Optional
-		colorBlendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE; // Optional
-		colorBlendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO; // Optional
-		colorBlendAttachment.alphaBlendOp = VK_BLEND_OP_ADD; // Optiona
-		colorBlending.attachmentCount = 1;
-		colorBlending.pAttachments = &colorBlendAttachment;
-
-		rasterizer.cullMode = VK_CULL_MODE_FRONT_BIT;
-		rasterizer.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;	//顶点序列是逆时针的是正面
-		
-		VkPipelineLayoutCreateInfo lightPipelineLayoutInfo{};
-		lightPipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-		discriptorSetLayouts = { my_descriptor->descriptorObjects[0].discriptorLayout, my_descriptor->descriptorObjects[2].discriptorLayout };
-		lightPipelineLayoutInfo.setLayoutCount = discriptorSetLayouts.size();
-		lightPipelineLayoutInfo.pSetLayouts = discriptorSetLayouts.data();
-		lightPipelineLayoutInfo.pushConstantRangeCount = 0;
-		lightPipelineLayoutInfo.pPushConstantRanges = nullptr;
-		if (vkCreatePipelineLayout(my_device->logicalDevice, &lightPipelineLayoutInfo, nullptr, &lightPipelineLayout) != VK_SUCCESS) {
+		gBufferPipelineIndex = my_pipelineManager->addGraphicsPipeline("gBuffer", createGBufferPipelineDesc());
+
+		//深度预通道和gBuffer在同一个subpass里，同一subpass内深度的读写按提交顺序进行，不需要额外的依赖
+		//只用位置流，没有片元着色器；布局和gBuffer相同，描述符集不用重新绑定
+		if (settings.depthPrepass) {
+			GraphicsPipelineDesc depthPrepassPipelineDesc;
+			depthPrepassPipelineDesc.vertShader = "depthPrepassVert.spv";
+			depthPrepassPipelineDesc.vertexBindings = Vertex::getBindingDescriptions(VERTEX_STREAM_POSITION);
+			depthPrepassPipelineDesc.vertexAttributes = myShaderReflection::filterVertexAttributes(depthPrepassReflection.vertexInputs, Vertex::getAttributeDescriptions(VERTEX_STREAM_POSITION));
+			depthPrepassPipelineDesc.cullMode = VK_CULL_MODE_BACK_BIT;
+			depthPrepassPipelineDesc.depthCompareOp = depthCompareOp();
+			//subpass 0有albedo和normal两个颜色附件，数量要对上，只是一个分量都不写
+			depthPrepassPipelineDesc.colorAttachmentCount = 2;
+			depthPrepassPipelineDesc.colorWriteMask = 0;
+			depthPrepassPipelineDesc.layout = gBufferPipelineLayout;
+			depthPrepassPipelineDesc.renderPass = renderPass;
+			depthPrepassPipelineDesc.subpass = 0;
+			depthPrepassPipelineIndex = my_pipelineManager->addGraphicsPipeline("depthPrepass", std::move(depthPrepassPipelineDesc));
+		}
+
+		lightPipelineLayout = createPipelineLayout({ my_descriptor->descriptorObjects[0].discriptorLayout, my_descriptor->descriptorObjects[2].discriptorLayout }, lightReflection.pushConstantRanges);
+
+		//light图形管线，全屏三角形不需要顶点输入
+		GraphicsPipelineDesc lightPipelineDesc;
+		lightPipelineDesc.vertShader = "lightVert.spv";
+		lightPipelineDesc.fragShader = "lightFrag.spv";
+		lightPipelineDesc.cullMode = VK_CULL_MODE_FRONT_BIT;
+		lightPipelineDesc.colorAttachmentCount = 1;
+		lightPipelineDesc.layout = lightPipelineLayout;
+		lightPipelineDesc.renderPass = renderPass;
+		lightPipelineDesc.subpass = 1;
+		lightPipelineIndex = my_pipelineManager->addGraphicsPipeline("light", std::move(lightPipelineDesc));
+
+		//.spv变化后只重新编译用到它的管线，不用重启程序
+		my_shaderCache->startWatching([this](const std::string& shaderName) {
+			my_pipelineManager->rebuildPipelinesUsing(shaderName);
+		});
+
+	}
+
+	//计算任务在createGraphicsPipeline之后添加，管线同样交给myPipelineManager在后台编译
+	void createMyComputeScheduler() {
+
+		my_computeScheduler = std::make_unique<myComputeScheduler>(my_device.get(), settings.framesInFlight, settings.asyncCompute, my_gpuProfiler.get());
+
+		std::vector<uint32_t> queueFamilies = { my_device->queueFamilyIndices.graphicsFamily.value(), my_device->queueFamilyIndices.computeFamily.value() };
+		my_gpuCulling = std::make_unique<myGpuCulling>(my_device.get(), my_device->graphicsQueue, my_buffer->commandPool, queueFamilies, my_model->meshs, my_buffer->positionBuffer, my_buffer->attributeBuffer, settings.framesInFlight, my_pipelineManager.get());
+		cullPassIndex = my_computeScheduler->addPass("cull", [this](VkCommandBuffer commandBuffer, uint32_t frameIndex) {
+			//mesh shader管线好了之后剔除在task shader里做，不需要间接绘制缓冲
+			if (meshShaderPipelineReady()) {
+				return false;
+			}
+			return my_gpuCulling->record(commandBuffer, frameIndex);
+		});
+
+	}
+
+	//和gBuffer管线画的是同一个subpass，set 0和set 1相同，set 2为meshlet和顶点数据
+	void createMeshShaderPipeline() {
+
+		if (!my_device->meshShaderSupported) {
+			return;
+		}
+
+		std::array<VkDescriptorSetLayout, 3> discriptorSetLayouts = { my_descriptor->descriptorObjects[0].discriptorLayout, my_descriptor->descriptorObjects[1].discriptorLayout, my_gpuCulling->meshShaderDescriptorSetLayout };
+		VkPushConstantRange pushConstantRange{};
+		//gBufferMesh里每次绘制的数据接在CullPushConstants后面，一共128字节，正好是设备保证支持的最小值
+		pushConstantRange.stageFlags = VK_SHADER_STAGE_TASK_BIT_EXT | VK_SHADER_STAGE_MESH_BIT_EXT;
+		pushConstantRange.offset = 0;
+		pushConstantRange.size = sizeof(CullPushConstants) + sizeof(DrawPushConstants);
+		VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+		pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+		pipelineLayoutInfo.setLayoutCount = discriptorSetLayouts.size();
+		pipelineLayoutInfo.pSetLayouts = discriptorSetLayouts.data();
+		pipelineLayoutInfo.pushConstantRangeCount = 1;
+		pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+		if (vkCreatePipelineLayout(my_device->logicalDevice, &pipelineLayoutInfo, nullptr, &meshShaderPipelineLayout) != VK_SUCCESS) {
 			throw std::runtime_error("failed to create pipeline layout!");
 		}
-		
-		pipelineInfo.pStages = shaderStages;
-		pipelineInfo.layout = lightPipelineLayout;
-		pipelineInfo.subpass = 1;
-		if (vkCreateGraphicsPipelines(my_device->logicalDevice, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &lightGraphicsPipeline) != VK_SUCCESS) {
-			throw std::runtime_error("failed to create graphics pipeline!");
+
+		GraphicsPipelineDesc meshShaderPipelineDesc;
+		meshShaderPipelineDesc.taskShader = "gBufferTask.spv";
+		meshShaderPipelineDesc.meshShader = "gBufferMesh.spv";
+		meshShaderPipelineDesc.fragShader = "gBufferFrag.spv";
+		meshShaderPipelineDesc.fragSpecConstants = { materialTextureNum };
+		meshShaderPipelineDesc.cullMode = VK_CULL_MODE_BACK_BIT;
+		meshShaderPipelineDesc.depthCompareOp = depthCompareOp();
+		meshShaderPipelineDesc.colorAttachmentCount = 2;
+		meshShaderPipelineDesc.layout = meshShaderPipelineLayout;
+		meshShaderPipelineDesc.renderPass = renderPass;
+		meshShaderPipelineDesc.subpass = 0;
+		meshShaderPipelineIndex = my_pipelineManager->addGraphicsPipeline("gBufferMesh", std::move(meshShaderPipelineDesc));
+
+	}
+
+	//gBuffer图形管线，顶点属性只留着色器真正读的；深度状态取决于当前是否开着预通道
+	GraphicsPipelineDesc createGBufferPipelineDesc() {
+		GraphicsPipelineDesc gBufferPipelineDesc;
+		gBufferPipelineDesc.vertShader = "gBufferVert.spv";
+		gBufferPipelineDesc.fragShader = "gBufferFrag.spv";
+		gBufferPipelineDesc.fragSpecConstants = { materialTextureNum };
+		gBufferPipelineDesc.vertexBindings = Vertex::getBindingDescriptions(VERTEX_STREAM_ALL);
+		gBufferPipelineDesc.vertexAttributes = myShaderReflection::filterVertexAttributes(gBufferReflection.vertexInputs, Vertex::getAttributeDescriptions(VERTEX_STREAM_ALL));
+		gBufferPipelineDesc.cullMode = VK_CULL_MODE_BACK_BIT;
+		gBufferPipelineDesc.colorAttachmentCount = 2;	//albedo和normal
+		gBufferPipelineDesc.layout = gBufferPipelineLayout;
+		gBufferPipelineDesc.renderPass = renderPass;
+		gBufferPipelineDesc.subpass = 0;
+		gBufferPipelineDesc.depthCompareOp = depthCompareOp();
+		if (settings.depthPrepass) {
+			//深度已经由预通道写好，只有最近的那个片元能通过
+			gBufferPipelineDesc.depthCompareOp = VK_COMPARE_OP_EQUAL;
+			gBufferPipelineDesc.depthWriteEnable = VK_FALSE;
 		}
-		
-		vkDestroyShaderModule(my_device->logicalDevice, lightVertShaderModule, nullptr);
-		vkDestroyShaderModule(my_device->logicalDevice, lightFragShaderModule, nullptr);
+		return gBufferPipelineDesc;
+	}
+
+	//预通道的管线编译失败时关掉预通道，gBuffer换成自己做深度测试的版本，旧的那条留到clean时销毁
+	void disableFailedDepthPrepass() {
+		if (!settings.depthPrepass || !my_pipelineManager->isFailed(depthPrepassPipelineIndex)) {
+			return;
+		}
+		std::cerr << "depth prepass disabled: depth prepass pipeline failed to compile" << std::endl;
+		settings.depthPrepass = false;
+		gBufferPipelineIndex = my_pipelineManager->addGraphicsPipeline("gBuffer", createGBufferPipelineDesc());
+	}
+
+	//反向Z时近处深度大，深度测试和清除值都要反过来
+	VkCompareOp depthCompareOp() {
+		return settings.reverseZ ? VK_COMPARE_OP_GREATER : VK_COMPARE_OP_LESS;
+	}
 
+	//mesh shader管线是可选的，还没编译好或者编译失败（比如.spv不存在）时返回VK_NULL_HANDLE，走间接多重绘制
+	//getPipeline对失败的管线会抛异常，所以先查isFailed，和myGpuCulling::record一样
+	VkPipeline readyMeshShaderPipeline() {
+		if (meshShaderPipelineLayout == VK_NULL_HANDLE) {
+			return VK_NULL_HANDLE;
+		}
+		if (my_pipelineManager->isFailed(meshShaderPipelineIndex)) {
+			if (!meshShaderFailureReported) {
+				std::cerr << "mesh shader path disabled: mesh shader pipeline failed to compile, using indirect draws" << std::endl;
+				meshShaderFailureReported = true;
+			}
+			return VK_NULL_HANDLE;
+		}
+		return my_pipelineManager->getPipeline(meshShaderPipelineIndex);
+	}
+
+	bool meshShaderPipelineReady() {
+		return readyMeshShaderPipeline() != VK_NULL_HANDLE;
 	}
 
 	void createSyncObjects() {
 
 		//信号量主要用于Queue之间的同步
-		imageAvailableSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
-		renderFinishedSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
-		//用于CPU和GPU之间的同步
-		inFlightFences.resize(MAX_FRAMES_IN_FLIGHT);
+		imageAvailableSemaphores.resize(settings.framesInFlight);
+		renderFinishedSemaphores.resize(settings.framesInFlight);
 
 		VkSemaphoreCreateInfo semaphoreInfo{};
 		semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
 
-		VkFenceCreateInfo fenceInfo{};
-		fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
-		//第一帧可以直接获得信号，而不会阻塞
-		fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
-
-		//每一帧都需要一定的信号量和栏栅
-		for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+		//获取图像和呈现只接受二值信号量，每一帧还是需要一对
+		for (size_t i = 0; i < settings.framesInFlight; i++) {
 			if (vkCreateSemaphore(my_device->logicalDevice, &semaphoreInfo, nullptr, &imageAvailableSemaphores[i]) != VK_SUCCESS ||
-				vkCreateSemaphore(my_device->logicalDevice, &semaphoreInfo, nullptr, &renderFinishedSemaphores[i]) != VK_SUCCESS ||
-				vkCreateFence(my_device->logicalDevice, &fenceInfo, nullptr, &inFlightFences[i]) != VK_SUCCESS) {
+				vkCreateSemaphore(my_device->logicalDevice, &semaphoreInfo, nullptr, &renderFinishedSemaphores[i]) != VK_SUCCESS) {
 				throw std::runtime_error("failed to create semaphores!");
 			}
 		}
 
+		//CPU和GPU之间的同步只用一个timeline，初始值0，前framesInFlight帧不用等
+		frameTimeline = std::make_unique<myTimeline>(my_device->logicalDevice);
+
 
 	}
 
 	void mainLoop() {
 		while (!glfwWindowShouldClose(window)) {
+			//最小化时没有可以画的地方，等窗口恢复，不去动交换链
+			int width = 0, height = 0;
+			glfwGetFramebufferSize(window, &width, &height);
+			if (width == 0 || height == 0) {
+				glfwWaitEventsTimeout(0.1);
+				continue;
+			}
+			{
+				MY_PROFILE_SCOPE("waitForNextFrame");
+				framePacer.waitForNextFrame();
+			}
+			MY_PROFILE_SCOPE("frame");
 			processInput(window);
-			glfwPollEvents();
+			{
+				MY_PROFILE_SCOPE("glfwPollEvents");
+				glfwPollEvents();
+			}
+			framePacer.markInput();
 			drawFrame();
 		}
 
@@ -1011,6 +1095,7 @@ private:
 
 	void processInput(GLFWwindow* window)
 	{
+		MY_PROFILE_FUNCTION();
 		if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
 			glfwSetWindowShouldClose(window, true);
 
@@ -1022,82 +1107,149 @@ private:
 			camera.ProcessKeyboard(LEFT, deltaTime);
 		if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
 			camera.ProcessKeyboard(RIGHT, deltaTime);
+
+		//光标被锁在窗口中心，按下左键时拾取屏幕中心的mesh
+		bool pickButton = glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_LEFT) == GLFW_PRESS;
+		if (pickButton && !pickButtonDown) {
+			glm::vec3 origin, direction;
+			camera.GetRay(0.0f, 0.0f, glm::radians(45.0f), my_swapChain->swapChainExtent.width / (float)my_swapChain->swapChainExtent.height, origin, direction);
+			uint32_t mesh;
+			float distance;
+			if (my_bvh->raycast(origin, direction, mesh, distance)) {
+				std::cout << "picked mesh " << mesh << " (node " << my_model->scene.names[my_model->meshNodes[mesh]] << ") at distance " << distance << std::endl;
+			}
+		}
+		pickButtonDown = pickButton;
 	}
 
 	void drawFrame() {
 
-		//第2个参数为是否等待栏栅的数量，第四个参数为是否等待所有栏栅信号化
-		vkWaitForFences(my_device->logicalDevice, 1, &inFlightFences[currentFrame], VK_TRUE, UINT64_MAX);
+		MY_PROFILE_FUNCTION();
+
+		if (swapChainOutOfDate && !recreateSwapChain()) {
+			return;
+		}
+
+		{
+			MY_PROFILE_SCOPE("vkWaitSemaphores");
+			auto fenceWaitStart = std::chrono::steady_clock::now();
+			//这个槽位上一次是第frameNumber - framesInFlight帧在用，等它做完，即timeline到达frameNumber - framesInFlight + 1
+			if (frameNumber >= settings.framesInFlight) {
+				frameTimeline->wait(frameNumber - settings.framesInFlight + 1);
+			}
+			framePacer.addFenceWait(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - fenceWaitStart).count());
+		}
+		deletionQueue.beginFrame(frameNumber, frameTimeline->completedValue());
+		//这个槽位上一帧的临时描述符集合已经用完了
+		my_descriptor->beginFrame(currentFrame);
+		allocateFrameUniformDescriptorSet();
+		if (gBufferDescriptorDirty[currentFrame]) {
+			updateGBufferDescriptorSet(currentFrame);
+		}
 
 		uint32_t imageIndex;
-		VkResult result = vkAcquireNextImageKHR(my_device->logicalDevice, my_swapChain->swapChain, UINT64_MAX, imageAvailableSemaphores[currentFrame], VK_NULL_HANDLE, &imageIndex);
+		VkResult result;
+		{
+			MY_PROFILE_SCOPE("vkAcquireNextImageKHR");
+			result = vkAcquireNextImageKHR(my_device->logicalDevice, my_swapChain->swapChain, UINT64_MAX, imageAvailableSemaphores[currentFrame], VK_NULL_HANDLE, &imageIndex);
+		}
 		//VK_ERROR_OUT_OF_DATE_KHR：交换链与表面不兼容，无法再用于渲染。通常在调整窗口大小后发生。
 		//VK_SUBOPTIMAL_KHR：交换链仍可用于成功呈现到表面，但表面属性不再完全匹配。
-		if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR || framebufferResized) {
-			framebufferResized = false;
-			recreateSwapChain();
+		//SUBOPTIMAL时图像已经拿到了，信号量也会被信号化，所以这一帧照常画完，呈现之后再重建
+		if (result == VK_ERROR_OUT_OF_DATE_KHR) {
+			swapChainOutOfDate = true;
 			return;
 		}
-		else if (result != VK_SUCCESS) {
+		else if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR) {
 			throw std::runtime_error("failed to acquire swap chain image!");
 		}
 
 		updateUniformBuffer(currentFrame);
-
-		//调用vkResetFences后栏栅不会信号化，反而会变成未信号化
-		//所以这里放在调整交换链大小之后，使得只要交换链没有调到最终状态就可以一直调
-		//我们运行后拉动window边框时可以发现vulkan卡住了没有渲染，就是这里的原因
-		vkResetFences(my_device->logicalDevice, 1, &inFlightFences[currentFrame]);
+		//计算队列先开始这一帧的剔除，和图形队列上还没做完的上一帧重叠
+		uint64_t computeWaitValue = my_computeScheduler->submit(currentFrame, frameNumber);
 
 		vkResetCommandBuffer(my_buffer->commandBuffers[currentFrame], 0);
 		recordCommandBuffer(my_buffer->commandBuffers[currentFrame], imageIndex);
 
 		VkSubmitInfo submitInfo{};
 		submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-		VkSemaphore waitSemaphores[] = { imageAvailableSemaphores[currentFrame] };	//需要等待的信号量
+		SubmitSemaphores semaphores;
 		//我们希望等待将颜色写入图像，直到图像可用，因此我们指定写入颜色附件的图形管道阶段。这意味着理论上实现可以在图像尚未可用时开始执行我们的顶点着色器等。
-		VkPipelineStageFlags waitStages[] = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
-		submitInfo.waitSemaphoreCount = 1;
-		submitInfo.pWaitSemaphores = waitSemaphores;
-		submitInfo.pWaitDstStageMask = waitStages;
+		semaphores.addWait(imageAvailableSemaphores[currentFrame], VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT);
+		//计算队列的结果在间接绘制时才需要，所以图形队列可以先开始，到那个阶段再等
+		if (computeWaitValue > 0) {
+			semaphores.addWait(my_computeScheduler->timeline->semaphore, my_computeScheduler->graphicsWaitStage, computeWaitValue);
+		}
+		semaphores.addSignal(renderFinishedSemaphores[currentFrame]);
+		//上传、读回、延迟销毁等都可以按帧号查询或等待这个值
+		semaphores.addSignal(frameTimeline->semaphore, frameNumber + 1);
+		semaphores.fill(submitInfo);
 
 		submitInfo.commandBufferCount = 1;
 		submitInfo.pCommandBuffers = &my_buffer->commandBuffers[currentFrame];
 
-		VkSemaphore signalSemaphores[] = { renderFinishedSemaphores[currentFrame] };
-		submitInfo.signalSemaphoreCount = 1;
-		submitInfo.pSignalSemaphores = signalSemaphores;
-
-		//只有当所有命令执行完成后才释放fence，也就是说提交的过程是临界区，需要互斥
-		// 这可以保证CPU和GPU的同步
 		//recordCommandBuffer函数记录渲染指令，通过vkQueueSubmit交给graphicsQueue执行
-		if (vkQueueSubmit(my_device->graphicsQueue, 1, &submitInfo, inFlightFences[currentFrame]) != VK_SUCCESS) {
-			throw std::runtime_error("failed to submit draw command buffer!");
+		{
+			MY_PROFILE_SCOPE("vkQueueSubmit");
+			if (vkQueueSubmit(my_device->graphicsQueue, 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS) {
+				throw std::runtime_error("failed to submit draw command buffer!");
+			}
 		}
+		frameTimeline->markSubmitted(frameNumber + 1);
 
 		VkPresentInfoKHR presentInfo{};
 		presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
 		presentInfo.waitSemaphoreCount = 1;
-		presentInfo.pWaitSemaphores = signalSemaphores;
+		presentInfo.pWaitSemaphores = &renderFinishedSemaphores[currentFrame];
 
 		VkSwapchainKHR swapChains[] = { my_swapChain->swapChain };
 		presentInfo.swapchainCount = 1;
 		presentInfo.pSwapchains = swapChains;
 		presentInfo.pImageIndices = &imageIndex;
-		result = vkQueuePresentKHR(my_device->presentQueue, &presentInfo);	//将渲染完成后的交换链纹理呈现到显示器上
-		if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR) {
-			recreateSwapChain();
+
+		//给每次呈现一个递增的id，后台线程用vkWaitForPresentKHR等它真正显示出来
+		uint64_t presentID = frameNumber + 1;
+		VkPresentIdKHR presentIdInfo{};
+		presentIdInfo.sType = VK_STRUCTURE_TYPE_PRESENT_ID_KHR;
+		presentIdInfo.swapchainCount = 1;
+		presentIdInfo.pPresentIds = &presentID;
+		if (my_presentMonitor) {
+			presentInfo.pNext = &presentIdInfo;
+		}
+
+		{
+			MY_PROFILE_SCOPE("vkQueuePresentKHR");
+			result = vkQueuePresentKHR(my_device->presentQueue, &presentInfo);	//将渲染完成后的交换链纹理呈现到显示器上
+		}
+		if (my_presentMonitor) {
+			if (result == VK_SUCCESS || result == VK_SUBOPTIMAL_KHR) {
+				my_presentMonitor->addPresent(presentID, framePacer.lastInputTime());
+			}
+			for (double latency : my_presentMonitor->collectLatencies()) {
+				framePacer.addPresentLatency(latency);
+			}
+		}
+		if (framePacer.markPresent()) {
+			std::string title = "Vulkan - " + framePacer.statsString() + " | tris " + std::to_string(frameLodTriangles) + "/" + std::to_string(frameFullTriangles);
+			glfwSetWindowTitle(window, title.c_str());
+		}
+		if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR || framebufferResized) {
+			framebufferResized = false;
+			swapChainOutOfDate = true;
 		}
 		else if (result != VK_SUCCESS) {
 			throw std::runtime_error("failed to present swap chain image!");
 		}
 
-		currentFrame = (currentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
+		currentFrame = (currentFrame + 1) % settings.framesInFlight;
+		frameNumber++;
 
 	}
 
 	void updateUniformBuffer(uint32_t currentImage) {
 
+		MY_PROFILE_FUNCTION();
+
 		//static auto startTime = std::chrono::high_resolution_clock::now();
 		float currentTime = static_cast<float>(glfwGetTime());;
 		deltaTime = std::chrono::duration<float, std::chrono::seconds::period>(currentTime - lastTime).count();
@@ -1105,9 +1257,14 @@ private:
 
 		UniformBufferObject ubo{};
 		//ubo.model = glm::rotate(glm::mat4(1.0f), time * glm::radians(90.0f), glm::vec3(0.0f, 0.0f, 1.0f));
-		ubo.model = glm::scale(glm::mat4(1.0f), glm::vec3(0.4f, 0.4f, 0.4f));// glm::mat4(1.0f); //glm::rotate(glm::mat4(1.0f), glm::radians(90.0f), glm::vec3(0.0f, 0.0f, 1.0f));
+		//只重新计算这一帧改过的节点，节点动了BVH只需要refit
+		if (my_model->scene.update() > 0) {
+			my_bvh->refit(computeMeshWorldBounds());
+		}
+		ubo.model = modelMatrix();// glm::mat4(1.0f); //glm::rotate(glm::mat4(1.0f), glm::radians(90.0f), glm::vec3(0.0f, 0.0f, 1.0f));
 		ubo.view = camera.GetViewMatrix();//glm::lookAt(glm::vec3(0.0f, 15.0f, 3.0f), glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f));
-		ubo.proj = glm::perspective(glm::radians(45.0f), my_swapChain->swapChainExtent.width / (float)my_swapChain->swapChainExtent.height, 0.1f, 100.0f);
+		float aspect = my_swapChain->swapChainExtent.width / (float)my_swapChain->swapChainExtent.height;
+		ubo.proj = settings.reverseZ ? reverseZInfinitePerspective(glm::radians(45.0f), aspect, 0.1f) : glm::perspective(glm::radians(45.0f), aspect, 0.1f, 100.0f);
 		ubo.proj[1][1] *= -1;	//vulkan的ndc空间y轴向下，所以需要将y分量乘以-1，同时这会导致顶点顺逆时针的改变，导致面的正反发生改变
 
 		ubo.lightPos = glm::vec4(0.0f, 130.0f, 0.0f, 0.0f); //glm::vec3(0.0f, 10.0f, 0.0f);
@@ -1115,6 +1272,19 @@ private:
 		//std::cout << ubo.cameraPos.y << std::endl;
 
 		memcpy(my_buffer->uniformBuffersMapped[currentImage], &ubo, sizeof(ubo));
+		//剔除在模型空间里做，相机位置也要变换过去
+		glm::vec3 modelCameraPosition = glm::vec3(glm::inverse(ubo.model) * glm::vec4(camera.Position, 1.0f));
+		my_gpuCulling->setFrustum(currentImage, ubo.proj * ubo.view * ubo.model, modelCameraPosition);
+
+		//BVH里的包围盒已经在世界空间，视锥只需要proj * view
+		std::vector<uint32_t> visibleMeshes;
+		my_bvh->cullFrustum(myGpuCulling::extractFrustumPlanes(ubo.proj * ubo.view), visibleMeshes);
+		std::fill(cpuVisibleMeshes.begin(), cpuVisibleMeshes.end(), 0);
+		for (uint32_t mesh : visibleMeshes) {
+			cpuVisibleMeshes[mesh] = 1;
+		}
+		selectMeshLods(ubo.model);
+		sortDrawOrder(ubo.view);
 
 		//标量必须按 N 对齐（= 32 位浮点数为 4 个字节）。
 		//Avec2必须按 2N（ = 8 个字节）对齐
@@ -1124,26 +1294,196 @@ private:
 
 	}
 
-	void recreateSwapChain() {
+	//右手视图空间看向-z，裁剪空间z = near，w = -z，所以近平面上深度为1，无穷远处趋近0
+	static glm::mat4 reverseZInfinitePerspective(float fovY, float aspect, float zNear) {
+		float f = 1.0f / std::tan(fovY * 0.5f);
+		glm::mat4 proj(0.0f);
+		proj[0][0] = f / aspect;
+		proj[1][1] = f;
+		proj[2][3] = -1.0f;
+		proj[3][2] = zNear;
+		return proj;
+	}
+
+	//LOD的误差在模型空间，按包围球离相机最近的距离换算成像素；模型矩阵只有均匀缩放，取第一列的长度
+	void selectMeshLods(const glm::mat4& model) {
+
+		float modelScale = glm::length(glm::vec3(model[0]));
+		float pixelsPerRadian = my_swapChain->swapChainExtent.height / (2.0f * std::tan(glm::radians(45.0f) * 0.5f));
+		frameLodTriangles = 0;
+		frameFullTriangles = 0;
+		for (uint32_t i = 0; i < my_model->meshs.size(); i++) {
+
+			const AABB& bounds = my_bvh->primBounds[i];
+			float radius = glm::length(bounds.max - bounds.min) * 0.5f;
+			float distance = std::max(glm::length(bounds.center() - camera.Position) - radius, 0.1f);
+			float pixelsPerUnit = pixelsPerRadian / distance * modelScale;
+			meshLods[i] = settings.lodPixelError > 0.0f ? my_model->selectLod(i, pixelsPerUnit, settings.lodPixelError) : 0;
+
+			if (cpuVisibleMeshes[i]) {
+				const std::vector<MeshLod>& lods = my_model->meshs[i].lods;
+				frameLodTriangles += lods[meshLods[i]].indexCount / 3;
+				frameFullTriangles += lods[0].indexCount / 3;
+				lodUsage[meshLods[i]]++;
+			}
+
+		}
+		totalLodTriangles += frameLodTriangles;
+		totalFullTriangles += frameFullTriangles;
+		lodFrameCount++;
+
+	}
+
+	//按包围盒中心在视图空间的深度排序，相机看向-z，所以深度取-z
+	void sortDrawOrder(const glm::mat4& view) {
+
+		MY_PROFILE_FUNCTION();
+
+		drawSortKeys.resize(drawOrder.size());
+		for (uint32_t i = 0; i < drawOrder.size(); i++) {
+			float viewDepth = -(view * glm::vec4(my_bvh->primBounds[i].center(), 1.0f)).z;
+			drawSortKeys[i] = myRadixSort::makeKey(myRadixSort::floatToKey(viewDepth), i);
+		}
+		myRadixSort::sortHigh32(drawSortKeys, drawSortScratch);
+		for (uint32_t i = 0; i < drawOrder.size(); i++) {
+			drawOrder[i] = myRadixSort::keyIndex(drawSortKeys[i]);
+		}
+
+	}
+
+	//每千次绘制的CPU录制时间，包括push constant、索引缓冲切换和绘制命令本身
+	void printDrawStats() {
+		if (gBufferDrawCount == 0) {
+			return;
+		}
+		std::cout << "gBuffer draws: " << gBufferDrawCount << " recorded, " << gBufferDrawRecordTime / gBufferDrawCount * 1000.0 << " us CPU per 1000 draws" << std::endl;
+	}
+
+	void printLodStats() {
+		if (lodFrameCount == 0) {
+			return;
+		}
+		std::cout << "lod: avg " << totalLodTriangles / lodFrameCount << " triangles per frame, full detail " << totalFullTriangles / lodFrameCount;
+		if (framePacer.totalStats.frameCount > 0) {
+			std::cout << ", avg frame time " << framePacer.totalStats.frameTime / framePacer.totalStats.frameCount << " ms";
+		}
+		uint64_t usageSum = 0;
+		for (uint64_t usage : lodUsage) {
+			usageSum += usage;
+		}
+		if (usageSum > 0) {
+			std::cout << ", usage";
+			for (uint32_t i = 0; i < lodUsage.size(); i++) {
+				std::cout << " lod" << i << " " << 100.0 * lodUsage[i] / usageSum << "%";
+			}
+		}
+		std::cout << std::endl;
+	}
+
+	//不再等设备空闲：旧的交换链、帧缓冲和放不下的G-buffer都放进deletionQueue，等用到它们的帧结束再销毁
+	//窗口最小化时返回false，这一帧跳过
+	bool recreateSwapChain() {
+
+		MY_PROFILE_FUNCTION();
 
 		int width = 0, height = 0;
 		//获得当前window的大小
 		glfwGetFramebufferSize(window, &width, &height);
-		while (width == 0 || height == 0) {
-			glfwGetFramebufferSize(window, &width, &height);
-			glfwWaitEvents();
+		if (width == 0 || height == 0) {
+			return false;
 		}
 
-		vkDeviceWaitIdle(my_device->logicalDevice);
-		cleanupSwapChain();
-		createMySwapChain();
-		createTargetTextureResources();
+		//表面的大小变了，能力要重新查询，不然用的还是创建设备时的currentExtent
+		my_device->swapChainSupportDetails = my_device->querySwapChainSupport(surface, my_device->physicalDevice);
+
+		//这一帧还没有提交，之前的帧都可能还在用旧的资源
+		std::shared_ptr<mySwapChain> oldSwapChain = std::move(my_swapChain);
+		createMySwapChain(oldSwapChain->swapChain);
+		//present monitor的后台线程可能还在旧交换链上等，销毁前等它放手
+		if (my_presentMonitor) {
+			myPresentMonitor* presentMonitor = my_presentMonitor.get();
+			oldSwapChain->retire(deletionQueue, [presentMonitor](VkSwapchainKHR swapChain) { presentMonitor->releaseSwapChain(swapChain); });
+		}
+		else {
+			oldSwapChain->retire(deletionQueue);
+		}
+
+		VkExtent2D extent = my_swapChain->swapChainExtent;
+		if (extent.width > gBufferExtent.width || extent.height > gBufferExtent.height) {
+			retireTargetTextureResources();
+			createTargetTextureResources();
+			std::fill(gBufferDescriptorDirty.begin(), gBufferDescriptorDirty.end(), true);
+		}
+
+		my_buffer->retireFramebuffers(deletionQueue, my_device->logicalDevice);
 		createFramebuffers();
+
+		swapChainOutOfDate = false;
+		return true;
+
+	}
+
+	void retireTargetTextureResources() {
+		for (std::unique_ptr<myImage>* image : { &gBufferAlbedoImage, &gBufferNormalImage, &testImage, &depthImage }) {
+			(*image)->retire(deletionQueue);
+			image->reset();
+		}
+	}
+
+	//每个飞行中的帧绑定各自的uniform缓冲，updateUniformBuffer只写currentFrame的那个，GPU还在读的缓冲不会被改
+	void allocateFrameUniformDescriptorSet() {
+		DescriptorObject& uniformDescriptorObject = my_descriptor->descriptorObjects[0];
+		frameUniformDescriptorSet = my_descriptor->allocateTransient(currentFrame, uniformDescriptorObject.discriptorLayout);
+		std::vector<VkBuffer> frameUniformBuffers = { my_buffer->uniformBuffers[currentFrame] };
+		my_descriptor->writeDescriptorSet(uniformDescriptorObject, frameUniformDescriptorSet, &frameUniformBuffers, &uniformDescriptorObject.textureDescriptorTypes, nullptr, nullptr);
+	}
+
+	void updateGBufferDescriptorSet(uint32_t frameIndex) {
+		std::vector<VkImageView> textureViews = { gBufferAlbedoImage->imageView, gBufferNormalImage->imageView, depthImage->imageView };
+		DescriptorObject& gBufferDescriptorObject = my_descriptor->descriptorObjects[2];
+		my_descriptor->writeDescriptorSet(gBufferDescriptorObject, gBufferDescriptorObject.descriptorSets[frameIndex], nullptr, &gBufferDescriptorObject.textureDescriptorTypes, &textureViews, nullptr);
+		gBufferDescriptorDirty[frameIndex] = false;
+	}
+
+	//材质序号和mesh序号，gBuffer和mesh shader两条路径都用；每个材质一个集合时数组里只有这个材质，序号为0
+	DrawPushConstants meshDrawPushConstants(uint32_t meshIndex) {
+		DrawPushConstants constants;
+		constants.materialIndex = perMaterialDescriptorSets ? 0 : meshMaterials[meshIndex];
+		constants.objectID = meshIndex;
+		return constants;
+	}
+
+	//材质集合所有帧共用，取第一份就行
+	VkDescriptorSet meshMaterialDescriptorSet(uint32_t meshIndex) {
+		return my_descriptor->descriptorObjects[1].descriptorSets[perMaterialDescriptorSets ? meshMaterials[meshIndex] : 0];
 	}
 
 	//这个函数记录渲染的命令，并指定渲染结果所在的纹理索引
+	//预通道和gBuffer画的几何必须完全一样，两边都走这里
+	void recordMeshDraw(VkCommandBuffer commandBuffer, uint32_t mesh, bool gpuCulled, VkIndexType& boundIndexType) {
+
+		//16位和32位索引在同一个缓冲的两段里，宽度变了才重新绑定
+		if (my_model->meshs[mesh].indexType != boundIndexType) {
+			boundIndexType = my_model->meshs[mesh].indexType;
+			my_buffer->bindIndexBuffer(commandBuffer, boundIndexType);
+		}
+
+		//剔除的结果在间接绘制缓冲里，每个meshlet一条命令，被剔除的instanceCount为0；剔除管线还没好时用CPU上BVH剔除的结果
+		if (gpuCulled) {
+			my_gpuCulling->drawIndirect(commandBuffer, currentFrame, mesh, meshLods[mesh]);
+		}
+		else if (cpuVisibleMeshes[mesh]) {
+			//所有LOD共用顶点，只是索引缓冲里不同的一段
+			const MeshLod& lod = my_model->meshs[mesh].lods[meshLods[mesh]];
+			vkCmdDrawIndexed(commandBuffer, lod.indexCount, 1, my_model->meshs[mesh].firstIndex + lod.firstIndex, my_model->meshs[mesh].firstVertex, 0);	//并不是立刻执行，就像Unity SRP里一样最后提交才执行
+		}
+
+	}
+
 	void recordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t imageIndex) {
 
+		MY_PROFILE_FUNCTION();
+
 		VkCommandBufferBeginInfo beginInfo{};
 		beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
 		//VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT：命令缓冲区执行一次后将立即重新记录。
@@ -1158,6 +1498,11 @@ private:
 			throw std::runtime_error("failed to begin recording command buffer!");
 		}
 
+		//这个槽位上一次的帧已经在timeline上等过了，上次的时间戳一定写完了
+		my_gpuProfiler->beginFrame(commandBuffer, currentFrame);
+		my_computeScheduler->recordInline(commandBuffer, currentFrame, my_gpuProfiler.get());
+		bool gpuCulled = my_computeScheduler->passRecorded(cullPassIndex, currentFrame);
+
 		VkViewport viewport{};
 		viewport.x = 0.0f;
 		viewport.y = 0.0f;
@@ -1184,7 +1529,7 @@ private:
 		clearValues[1].color = { {0.0f, 0.0f, 0.0f, 1.0f} };
 		clearValues[2].color = { {0.0f, 0.0f, 0.0f, 1.0f} };
 		//clearValues[3].color = { {0.0f, 0.0f, 0.0f, 1.0f} };
-		clearValues[3].depthStencil = { 1.0f, 0 };
+		clearValues[3].depthStencil = { settings.reverseZ ? 0.0f : 1.0f, 0 };
 		renderPassInfo.clearValueCount = static_cast<uint32_t>(clearValues.size());
 		renderPassInfo.pClearValues = clearValues.data();
 
@@ -1194,38 +1539,81 @@ private:
 
 		//注意，若使用vkCmdDraw，则需要对vertexBuffer设置偏移量
 		//若使用vkCmdDrawIndexed，则vertexBuffer不需要偏移，只需要偏移indexBuffer，否则，会导致indices连线出错
-		VkBuffer vertexBuffers[] = { my_buffer->vertexBuffer };
-		VkDeviceSize offsets[] = { 0 };
-		vkCmdBindVertexBuffers(commandBuffer, 0, 1, vertexBuffers, offsets);
-		vkCmdBindIndexBuffer(commandBuffer, my_buffer->indexBuffer, 0, VK_INDEX_TYPE_UINT32);
-
-		vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, gBufferGraphicsPipeline);
-		VkDescriptorSet uniformDescriptorSet = my_descriptor->descriptorObjects[0].descriptorSets[currentFrame];
-		vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, gBufferPipelineLayout, 0, 1, &uniformDescriptorSet, 0, nullptr);
-		uint32_t index = 0;
-		for (uint32_t i = 0; i < my_model->meshs.size(); i++) {
-
-			std::string twoPath = "";
-			for (int k = 0; k < 2; k++) {
-				twoPath += my_model->meshs[i].textures[k].path;
+		my_buffer->bindVertexBuffers(commandBuffer, VERTEX_STREAM_ALL);
+		//索引缓冲按mesh的索引宽度在下面绑定
+
+		//管线还在后台编译的话就先跳过，render pass照常走完，只是这一帧什么都没画
+		disableFailedDepthPrepass();
+		VkPipeline gBufferGraphicsPipeline = my_pipelineManager->getPipeline(gBufferPipelineIndex);
+		VkPipeline depthPrepassPipeline = settings.depthPrepass ? my_pipelineManager->getPipeline(depthPrepassPipelineIndex) : VK_NULL_HANDLE;
+		VkPipeline lightGraphicsPipeline = my_pipelineManager->getPipeline(lightPipelineIndex);
+
+		VkDescriptorSet uniformDescriptorSet = frameUniformDescriptorSet;
+		VkDescriptorSet boundMaterialDescriptorSet = VK_NULL_HANDLE;	//只在材质集合变了时重新绑定，共用一个集合时只绑一次
+		VkPipeline meshShaderPipeline = readyMeshShaderPipeline();
+		//gBuffer管线用EQUAL测试，预通道的管线没好之前深度缓冲里什么都没有，这一帧不画
+		bool depthPrepassReady = !settings.depthPrepass || depthPrepassPipeline != VK_NULL_HANDLE;
+
+		//mesh shader路径不做预通道，mesh shader和顶点着色器算出的深度不保证逐位相同
+		if (meshShaderPipeline == VK_NULL_HANDLE && gBufferGraphicsPipeline != VK_NULL_HANDLE && depthPrepassPipeline != VK_NULL_HANDLE) {
+			uint32_t depthPrepassScope = my_gpuProfiler->beginScope(commandBuffer, "depthPrepass");
+			vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, depthPrepassPipeline);
+			vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, gBufferPipelineLayout, 0, 1, &uniformDescriptorSet, 0, nullptr);
+			VkIndexType boundIndexType = VK_INDEX_TYPE_MAX_ENUM;
+			for (uint32_t i : drawOrder) {
+				recordMeshDraw(commandBuffer, i, gpuCulled, boundIndexType);
 			}
-			int descriptorOffset = currentFrame * uniqueDescriptorSets.size() + uniqueDescriptorSets[twoPath];
-			//int descriptorOffset = uniqueDescriptorSets[twoPath];
-			VkDescriptorSet textureDescriptorSet = my_descriptor->descriptorObjects[1].descriptorSets[descriptorOffset];
-
-			vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, gBufferPipelineLayout, 1, 1, &textureDescriptorSet, 0, nullptr);
-
-			//vkCmdDraw(commandBuffer, static_cast<uint32_t>(my_model->meshs[i].vertices.size()), 1, 0, 0);
-			vkCmdDrawIndexed(commandBuffer, static_cast<uint32_t>(my_model->meshs[i].indices.size()), 1, index, 0, 0);	//并不是立刻执行，就像Unity SRP里一样最后提交才执行
-			index += my_model->meshs[i].indices.size();
+			my_gpuProfiler->endScope(commandBuffer, depthPrepassScope);
+		}
 
+		uint32_t gBufferScope = my_gpuProfiler->beginScope(commandBuffer, "gBuffer");
+		if (meshShaderPipeline != VK_NULL_HANDLE) {
+			vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, meshShaderPipeline);
+			vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, meshShaderPipelineLayout, 0, 1, &uniformDescriptorSet, 0, nullptr);
+			vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, meshShaderPipelineLayout, 2, 1, &my_gpuCulling->meshShaderDescriptorSet, 0, nullptr);
+			double drawRecordStart = myProfiler::nowTime();
+			for (uint32_t i = 0; i < my_model->meshs.size(); i++) {
+				VkDescriptorSet materialDescriptorSet = meshMaterialDescriptorSet(i);
+				if (materialDescriptorSet != boundMaterialDescriptorSet) {
+					vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, meshShaderPipelineLayout, 1, 1, &materialDescriptorSet, 0, nullptr);
+					boundMaterialDescriptorSet = materialDescriptorSet;
+				}
+				DrawPushConstants drawConstants = meshDrawPushConstants(i);
+				vkCmdPushConstants(commandBuffer, meshShaderPipelineLayout, VK_SHADER_STAGE_TASK_BIT_EXT | VK_SHADER_STAGE_MESH_BIT_EXT, sizeof(CullPushConstants), sizeof(DrawPushConstants), &drawConstants);
+				my_gpuCulling->drawMeshTasks(commandBuffer, meshShaderPipelineLayout, currentFrame, i, meshLods[i]);
+			}
+			gBufferDrawRecordTime += myProfiler::nowTime() - drawRecordStart;
+			gBufferDrawCount += my_model->meshs.size();
 		}
+		else if (gBufferGraphicsPipeline != VK_NULL_HANDLE && depthPrepassReady) {
+			vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, gBufferGraphicsPipeline);
+			vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, gBufferPipelineLayout, 0, 1, &uniformDescriptorSet, 0, nullptr);
+			VkIndexType boundIndexType = VK_INDEX_TYPE_MAX_ENUM;
+			double drawRecordStart = myProfiler::nowTime();
+			for (uint32_t i : drawOrder) {
+				VkDescriptorSet materialDescriptorSet = meshMaterialDescriptorSet(i);
+				if (materialDescriptorSet != boundMaterialDescriptorSet) {
+					vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, gBufferPipelineLayout, 1, 1, &materialDescriptorSet, 0, nullptr);
+					boundMaterialDescriptorSet = materialDescriptorSet;
+				}
+				DrawPushConstants drawConstants = meshDrawPushConstants(i);
+				vkCmdPushConstants(commandBuffer, gBufferPipelineLayout, drawPushConstantStages, 0, sizeof(DrawPushConstants), &drawConstants);
+				recordMeshDraw(commandBuffer, i, gpuCulled, boundIndexType);
+			}
+			gBufferDrawRecordTime += myProfiler::nowTime() - drawRecordStart;
+			gBufferDrawCount += drawOrder.size();
+		}
+		my_gpuProfiler->endScope(commandBuffer, gBufferScope);
 
 		vkCmdNextSubpass(commandBuffer, VK_SUBPASS_CONTENTS_INLINE);
-		vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, lightGraphicsPipeline);
-		vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, lightPipelineLayout, 0, 1, &uniformDescriptorSet, 0, nullptr);
-		vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, lightPipelineLayout, 1, 1, &(my_descriptor->descriptorObjects[2].descriptorSets[currentFrame]), 0, nullptr);
-		vkCmdDraw(commandBuffer, 3, 1, 0, 0);
+		uint32_t lightScope = my_gpuProfiler->beginScope(commandBuffer, "light");
+		if (lightGraphicsPipeline != VK_NULL_HANDLE) {
+			vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, lightGraphicsPipeline);
+			vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, lightPipelineLayout, 0, 1, &uniformDescriptorSet, 0, nullptr);
+			vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, lightPipelineLayout, 1, 1, &(my_descriptor->descriptorObjects[2].descriptorSets[currentFrame]), 0, nullptr);
+			vkCmdDraw(commandBuffer, 3, 1, 0, 0);
+		}
+		my_gpuProfiler->endScope(commandBuffer, lightScope);
 		
 		vkCmdEndRenderPass(commandBuffer);
 
@@ -1237,29 +1625,60 @@ private:
 
 	void cleanup() {
 
+		if (my_presentMonitor) {
+			my_presentMonitor->stop();
+		}
 		cleanupSwapChain();
 
-		vkDestroyPipeline(my_device->logicalDevice, gBufferGraphicsPipeline, nullptr);
+		my_shaderCache->stopWatching();
+		my_pipelineManager->clean();
+		//后台线程都停了，不会再有新的资源放进来
+		deletionQueue.flushAll();
+		my_shaderCache->clean();
 		vkDestroyPipelineLayout(my_device->logicalDevice, gBufferPipelineLayout, nullptr);
-		vkDestroyRenderPass(my_device->logicalDevice, renderPass, nullptr);
-
-		vkDestroyDescriptorPool(my_device->logicalDevice, my_descriptor->discriptorPool, nullptr);
-
-		for (int i = 0; i < albedoTextureImages.size(); i++) {
-			albedoTextureImages[i]->clean();
+		vkDestroyPipelineLayout(my_device->logicalDevice, lightPipelineLayout, nullptr);
+		if (meshShaderPipelineLayout != VK_NULL_HANDLE) {
+			vkDestroyPipelineLayout(my_device->logicalDevice, meshShaderPipelineLayout, nullptr);
 		}
-		for (int i = 0; i < normalTextureImages.size(); i++) {
-			normalTextureImages[i]->clean();
+
+		my_pipelineCache->saveToDisk(my_device->logicalDevice);
+		my_pipelineCache->clean(my_device->logicalDevice);
+
+		framePacer.printStats();
+		printLodStats();
+		printDrawStats();
+		my_buffer->printStats();
+		myTextureRegistry::printStats();
+		mySamplerCache::printStats();
+		my_descriptor->printStats();
+		myProfiler::printStats();
+		my_gpuProfiler->printStats();
+		my_computeScheduler->printStats();
+		std::vector<myGpuProfiler*> otherGpuProfilers;
+		if (my_computeScheduler->gpuProfiler) {
+			otherGpuProfilers.push_back(my_computeScheduler->gpuProfiler.get());
 		}
+		my_gpuProfiler->exportChromeTrace("profile_trace.json", otherGpuProfilers);
+		myBuffer::uploadProfiler = nullptr;
+		myBuffer::uploadTimeline = nullptr;
+		my_gpuProfiler->clean();
+		my_gpuCulling->clean();
+		my_computeScheduler->clean();
+		vkDestroyRenderPass(my_device->logicalDevice, renderPass, nullptr);
+
+		my_model->releaseTextures(nullptr);
+		myTextureRegistry::clean();
+		mySamplerCache::clean();
 
 		my_descriptor->clean();
 
-		for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+		for (size_t i = 0; i < settings.framesInFlight; i++) {
 			vkDestroySemaphore(my_device->logicalDevice, renderFinishedSemaphores[i], nullptr);
 			vkDestroySemaphore(my_device->logicalDevice, imageAvailableSemaphores[i], nullptr);
-			vkDestroyFence(my_device->logicalDevice, inFlightFences[i], nullptr);
 		}
-		my_buffer->clean(my_device->logicalDevice, MAX_FRAMES_IN_FLIGHT);
+		frameTimeline->clean();
+		uploadTimeline->clean();
+		my_buffer->clean(my_device->logicalDevice, settings.framesInFlight);
 
 		my_device->clean();
 
@@ -1291,19 +1710,20 @@ private:
 		for (size_t i = 0; i < my_buffer->swapChainFramebuffers.size(); i++) {
 			vkDestroyFramebuffer(my_device->logicalDevice, my_buffer->swapChainFramebuffers[i], nullptr);
 		}
-		for (size_t i = 0; i < my_swapChain->swapChainImageViews.size(); i++) {
-			vkDestroyImageView(my_device->logicalDevice, my_swapChain->swapChainImageViews[i], nullptr);
-		}
-		vkDestroySwapchainKHR(my_device->logicalDevice, my_swapChain->swapChain, nullptr);
+		my_swapChain->clean();
 	}
 
 };
 
-int main() {
-
-	HelloTriangleApplication app;
+int main(int argc, char** argv) {
 
 	try {
+		mySettings settings(argc, argv);
+		if (settings.bvhBenchmarkPrimitives > 0) {
+			myBvh::benchmark(settings.bvhBenchmarkPrimitives);
+			return EXIT_SUCCESS;
+		}
+		HelloTriangleApplication app(settings);
 		app.run();
 	}
 	catch (const std::exception& e) {
@@ -2,4 +2,8 @@ C:/D/Vulkan/Bin/glslc.exe gBufferVert.vert -o gBufferVert.spv
 C:/D/Vulkan/Bin/glslc.exe gBufferFrag.frag -o gBufferFrag.spv
 C:/D/Vulkan/Bin/glslc.exe lightVert.vert -o lightVert.spv
 C:/D/Vulkan/Bin/glslc.exe lightFrag.frag -o lightFrag.spv
+C:/D/Vulkan/Bin/glslc.exe cullComp.comp -o cullComp.spv
+C:/D/Vulkan/Bin/glslc.exe --target-spv=spv1.4 gBufferTask.task -o gBufferTask.spv
+C:/D/Vulkan/Bin/glslc.exe --target-spv=spv1.4 gBufferMesh.mesh -o gBufferMesh.spv
+C:/D/Vulkan/Bin/glslc.exe depthPrepassVert.vert -o depthPrepassVert.spv
 pause
\ No newline at end of file
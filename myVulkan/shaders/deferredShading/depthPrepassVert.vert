@@ -0,0 +1,19 @@
+#version 450
+
+//ԤֻͨҪλ
+layout(location = 0) in vec3 inPosition;
+
+layout(binding = 0) uniform UniformBufferObject{
+    mat4 model;
+    mat4 view;
+    mat4 proj;
+    vec3 lightPos;
+    vec3 cameraPos;
+} ubo;
+
+//ʽҪgBufferVertȫһ
+invariant gl_Position;
+
+void main() {
+    gl_Position = ubo.proj * ubo.view * ubo.model * vec4(inPosition, 1.0);
+}
\ No newline at end of file
@@ -4,17 +4,20 @@ layout(location = 0) in vec3 worldPos;
 layout(location = 1) in vec2 texCoord;
 //layout(location = 2) in mat3 tbn;
 layout(location = 2) in vec3 normal;
+layout(location = 3) flat in uint materialIndex;   //һλڶͬ
 
-layout(set = 1, binding = 0) uniform sampler2D colorSampler;
-layout(set = 1, binding = 1) uniform sampler2D normalSampler;
+//вʵmʵķ2m2m + 1ɳʵʵĲػ
+//豸Ĳ޷ŲʱÿһϣΪ2materialIndex0
+layout(constant_id = 0) const uint MATERIAL_TEXTURE_NUM = 2;
+layout(set = 1, binding = 0) uniform sampler2D materialTextures[MATERIAL_TEXTURE_NUM];
 
 layout(location = 0) out vec4 outAlbedo;    //һͨԺð
 layout(location = 1) out vec4 outNormal;
 
 
 void main(){
-    outAlbedo = vec4(texture(colorSampler, texCoord).rgb, 1.0);
-    vec3 textureNormal = normalize(texture(normalSampler, texCoord)).xyz;
+    outAlbedo = vec4(texture(materialTextures[2 * materialIndex], texCoord).rgb, 1.0);
+    vec3 textureNormal = normalize(texture(materialTextures[2 * materialIndex + 1], texCoord)).xyz;
 
     vec3 tangent = normalize(dFdx(worldPos));
     //vec3 bitangent = normalize(dFdy(worldPos));
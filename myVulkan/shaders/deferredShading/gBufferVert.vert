@@ -13,15 +13,25 @@ layout(binding = 0) uniform UniformBufferObject{
     vec3 cameraPos;
 } ubo;
 
+//ÿλƵݣstructSet.hDrawPushConstantsһ
+layout(push_constant) uniform DrawConstants {
+    uint materialIndex;
+    uint objectID;
+} draw;
+
 layout(location = 0) out vec3 worldPos;
 layout(location = 1) out vec2 texCoord;
 //layout(location = 2) out mat3 tbn;
 layout(location = 2) out vec3 normal;
+layout(location = 3) flat out uint materialIndex;
+//depthPrepassVertȱλͬG-bufferEQUALȲ
+invariant gl_Position;
 
 void main() {
     gl_Position = ubo.proj * ubo.view * ubo.model * vec4(inPosition, 1.0);
     worldPos = (ubo.model * vec4(inPosition, 1.0)).xyz;
     texCoord = inTexCoord;
+    materialIndex = draw.materialIndex;
 
     //ģ͵uvǾģtangentǴģǲ淨
    mat3 normalMatrix = transpose(inverse(mat3(ubo.model)));
@@ -17,14 +17,17 @@ layout(binding = 0) uniform UniformBufferObject{
 layout(location = 0) out vec4 finalColor;
 
 //vulkanndcռopenGLͬvulkanndcyΪ죩
-vec3 getPosFromDepth(float depth, vec2 uv, mat4 transferMat){
+//ֻͶӰصͼռ͸ӳview˽ȥZʱԶȺСһ澫Ȳ
+//صwΪ0ʾԶZԶͶӰȻֵ0Զûл
+vec4 getViewPosFromDepth(float depth, vec2 uv, mat4 invProj){
 
     uv = uv * 2.0f - 1.0f;
     vec4 ndc = vec4(uv, depth, 1.0f);
-    vec4 pos = transferMat * ndc;
-    pos.xyz /= pos.w;
-
-    return pos.xyz;
+    vec4 pos = invProj * ndc;
+    if (pos.w <= 0.0f) {
+        return vec4(0.0f);
+    }
+    return vec4(pos.xyz / pos.w, 1.0f);
 
 }
 
@@ -35,9 +38,14 @@ void main() {
     //subPassLoadֻܷ뵱ǰ϶ӦأôһЩblurʲôĴͲУǵò
     vec4 normal_tangent = subpassLoad(inputNormal);
 
-    float depth = subpassLoad(inputDepth).x;  //0 - 1openGLΪ-1 - 1
+    float depth = subpassLoad(inputDepth).x;  //0 - 1openGLΪ-1 - 1ZʱΪ1
     vec2 uv = texCoord;//vec2(texCoord.x, -texCoord.y);
-    vec3 worldPos = getPosFromDepth(depth, uv, inverse(ubo.proj * ubo.view));
+    vec4 viewPos = getViewPosFromDepth(depth, uv, inverse(ubo.proj));
+    if (viewPos.w == 0.0f) {
+        finalColor = 0.1f * albedo;
+        return;
+    }
+    vec3 worldPos = (inverse(ubo.view) * viewPos).xyz;
 
     //vec4 clip = ubo.proj * ubo.view * ubo.model * vec4(worldPos, 1.0f);
     //vec4 ndc = clip / clip.w;
@@ -8,6 +8,7 @@
 #include<glm/glm.hpp>
 
 #include <array>
+#include <vector>
 #include <optional>
 
 #ifndef STRUCT_SET
@@ -18,6 +19,8 @@ struct QueueFamilyIndices {
 
 	std::optional<uint32_t> graphicsFamily;
 	std::optional<uint32_t> presentFamily;
+	//ѡûͼιܵĶ壨첽㣩ûеĻͼζͬ
+	std::optional<uint32_t> computeFamily;
 
 	bool isComplete() {
 		return graphicsFamily.has_value() && presentFamily.has_value();
@@ -31,6 +34,24 @@ struct SwapChainSupportDetails {
 	std::vector<VkPresentModeKHR> presentModes;
 };
 
+//GPUϵλõһԤpassӰֻҪλõpassÿֻ12ֽڣһ
+enum VertexStream {
+	VERTEX_STREAM_POSITION = 1,
+	VERTEX_STREAM_ATTRIBUTE = 2,
+	VERTEX_STREAM_ALL = VERTEX_STREAM_POSITION | VERTEX_STREAM_ATTRIBUTE
+};
+
+//һ
+struct VertexAttribute {
+	glm::vec2 texCoord;
+	glm::vec3 normal;
+	glm::vec3 tangent;
+};
+//ĲcreateMeshBuffersдgBufferMeshﰴfloatٶ
+//ҪGLM_FORCE_DEFAULT_ALIGNED_GENTYPESvec316ֽڣҴС˳ڲͬcppﲻһ
+static_assert(sizeof(glm::vec3) == 12 && sizeof(VertexAttribute) == 32, "vertex streams must be tightly packed");
+
+//ͼʱõĽ㣬ϴʱŲ
 struct Vertex {
 	glm::vec3 pos;
 	//glm::vec3 color;
@@ -39,42 +60,47 @@ struct Vertex {
 	glm::vec3 tangent;
 
 
-	static VkVertexInputBindingDescription getBindingDescription() {
-
-		VkVertexInputBindingDescription bindingDescription{};
-		bindingDescription.binding = 0;
-		bindingDescription.stride = sizeof(Vertex);
-		bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
-		return bindingDescription;
+	//GPU϶ÿһ̶bindingVertexStream
+	static const uint32_t POSITION_BINDING = 0;
+	static const uint32_t ATTRIBUTE_BINDING = 1;
+
+	//streamsΪVertexStreamϣֻɹõİ
+	static std::vector<VkVertexInputBindingDescription> getBindingDescriptions(uint32_t streams) {
+
+		std::vector<VkVertexInputBindingDescription> bindingDescriptions;
+		if (streams & VERTEX_STREAM_POSITION) {
+			VkVertexInputBindingDescription bindingDescription{};
+			bindingDescription.binding = POSITION_BINDING;
+			bindingDescription.stride = sizeof(glm::vec3);
+			bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+			bindingDescriptions.push_back(bindingDescription);
+		}
+		if (streams & VERTEX_STREAM_ATTRIBUTE) {
+			VkVertexInputBindingDescription bindingDescription{};
+			bindingDescription.binding = ATTRIBUTE_BINDING;
+			bindingDescription.stride = sizeof(VertexAttribute);
+			bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+			bindingDescriptions.push_back(bindingDescription);
+		}
+		return bindingDescriptions;
 
 	}
 
-	static std::array<VkVertexInputAttributeDescription, 4> getAttributeDescriptions() {
+	//locationɫһ£0Ϊpos1ΪtexCoord2Ϊnormal3Ϊtangent
+	static std::vector<VkVertexInputAttributeDescription> getAttributeDescriptions(uint32_t streams) {
 
 		//VAO
-		std::array<VkVertexInputAttributeDescription, 4> attributeDescriptions{};
-
-		attributeDescriptions[0].binding = 0;
-		attributeDescriptions[0].location = 0;
-		attributeDescriptions[0].format = VK_FORMAT_R32G32B32_SFLOAT;
-		attributeDescriptions[0].offset = offsetof(Vertex, pos);	//posVertexеƫ
-
-		attributeDescriptions[1].binding = 0;
-		attributeDescriptions[1].location = 1;
-		attributeDescriptions[1].format = VK_FORMAT_R32G32_SFLOAT;
-		attributeDescriptions[1].offset = offsetof(Vertex, texCoord);
-
-		attributeDescriptions[2].binding = 0;
-		attributeDescriptions[2].location = 2;
-		attributeDescriptions[2].format = VK_FORMAT_R32G32B32_SFLOAT;
-		attributeDescriptions[2].offset = offsetof(Vertex, normal);
-
-		attributeDescriptions[3].binding = 0;
-		attributeDescriptions[3].location = 3;
-		attributeDescriptions[3].format = VK_FORMAT_R32G32B32_SFLOAT;
-		attributeDescriptions[3].offset = offsetof(Vertex, tangent);
-
+		std::vector<VkVertexInputAttributeDescription> attributeDescriptions;
+		if (streams & VERTEX_STREAM_POSITION) {
+			attributeDescriptions.push_back({ 0, POSITION_BINDING, VK_FORMAT_R32G32B32_SFLOAT, 0 });
+		}
+		if (streams & VERTEX_STREAM_ATTRIBUTE) {
+			attributeDescriptions.push_back({ 1, ATTRIBUTE_BINDING, VK_FORMAT_R32G32_SFLOAT, offsetof(VertexAttribute, texCoord) });	//texCoordVertexAttributeеƫ
+			attributeDescriptions.push_back({ 2, ATTRIBUTE_BINDING, VK_FORMAT_R32G32B32_SFLOAT, offsetof(VertexAttribute, normal) });
+			attributeDescriptions.push_back({ 3, ATTRIBUTE_BINDING, VK_FORMAT_R32G32B32_SFLOAT, offsetof(VertexAttribute, tangent) });
+		}
 		return attributeDescriptions;
+
 	}
 
 	bool operator==(const Vertex& other) const {
@@ -83,21 +109,61 @@ struct Vertex {
 
 };
 
+enum TextureType { TEXTURE_ALBEDO, TEXTURE_NORMAL };
+
 struct Texture {
-	//uint32_t id;
-	std::string type;
-	std::string path;
+	TextureType type;
+	uint32_t id;	//myTextureRegistryеIDļͬIDͬ
+};
+
+//һСڵΣ޳ͻƶΪλСmesh shaderõ64㡢124
+struct Meshlet {
+
+	static const uint32_t MAX_VERTICES = 64;
+	static const uint32_t MAX_TRIANGLES = 124;
+
+	glm::vec4 boundingSphere;	//xyzΪģwΪ뾶meshĿռ
+	glm::vec4 cone;	//xyzΪ׶ᣬwΪ׶ǵң߷ɢʱwΪ1Զᱻ޳
+	uint32_t firstIndex;	//meshindicesеλãmeshletindicesģԽLOD
+	uint32_t indexCount;
+	uint32_t vertexOffset;	//meshmeshletVerticesеλ
+	uint32_t vertexCount;
+
+};
+
+//һLODmeshindicesеķΧLODö
+struct MeshLod {
+	uint32_t firstIndex;
+	uint32_t indexCount;
+	uint32_t firstMeshlet;
+	uint32_t meshletCount;
+	float error;	//ԭʼȵģͿռеľ룬LOD 0Ϊ0
 };
 
 struct Mesh {
 	std::vector<Vertex> vertices;
-	std::vector<uint32_t> indices;
+	std::vector<uint32_t> indices;	//LODδţlods[0]Ϊԭʼ
 	std::vector<Texture> textures;
+	std::vector<MeshLod> lods;
+
+	//ʱɣmesh shaderãmeshletVerticesΪmeshletľֲ㵽meshӳ
+	//meshletTrianglesindicesеһһӦÿε3ֲռ8λ
+	std::vector<Meshlet> meshlets;
+	std::vector<uint32_t> meshletVertices;
+	std::vector<uint32_t> meshletTriangles;
+
+	//ںϲĶ㡢еλãϴverticesindicesᱻͷţֻ֮⼸
+	//meshԼĶģʱfirstVertexΪvertexOffsetfirstIndexindexTypeһλ
+	uint32_t firstVertex = 0;
+	uint32_t vertexCount = 0;
+	uint32_t firstIndex = 0;
+	uint32_t indexCount = 0;
+	VkIndexType indexType = VK_INDEX_TYPE_UINT32;
 
 	Mesh(std::vector<Vertex> vertices, std::vector<uint32_t> indices, std::vector<Texture> textures) {
-		this->vertices = vertices;
-		this->indices = indices;
-		this->textures = textures;
+		this->vertices = std::move(vertices);
+		this->indices = std::move(indices);
+		this->textures = std::move(textures);
 	}
 
 };
@@ -111,11 +177,20 @@ struct UniformBufferObject {
 	glm::vec4 cameraPos;
 };
 
+//ÿλpush constantµݣֺgBufferVert.vertgBufferMesh.meshDrawConstantsһ
+//вʵͬһmʵķ2m2m + 1ʲ°
+struct DrawPushConstants {
+	uint32_t materialIndex;
+	uint32_t objectID;	//meshţʰȡ͵
+};
+
 struct DescriptorObject {
 
 	VkDescriptorSetLayout discriptorLayout;
 	uint32_t uniformBufferNum;
 	uint32_t textureNum;
+	std::vector<VkDescriptorType> textureDescriptorTypes;	//Ӳֵİõдʱ
+	std::vector<uint32_t> textureDescriptorCounts;	//ÿͼ󶨵鳤ȣдʱ˳ͼͼȡô
 	std::vector<VkDescriptorSet> descriptorSets;
 };
 